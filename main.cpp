@@ -1,17 +1,43 @@
 #include <iostream>
 #include "src/interconnect/interconnect.hpp"
 #include "src/ram/ram.hpp"
+#include "test/ram/ram_test.hpp"
 
 // Forward declarations of test functions
 void test_round_robin();
+void test_many_pes();
+void test_concurrent_requests();
+void test_split_bus();
+void test_arbitration();
+void test_noc();
+void test_coalescing();
+void test_transaction_trace();
 void test_memory_operations();
+void test_cache_to_cache();
+void test_protocol_variants();
+void test_snoop_filter();
+void test_directory();
 
 int main() {
     std::cout << "Starting Interconnect Tests..." << std::endl;
     
     try {
         test_round_robin();
+        test_many_pes();
+        test_concurrent_requests();
+        test_split_bus();
+        test_arbitration();
+        test_noc();
+        test_coalescing();
+        test_transaction_trace();
         test_memory_operations();
+        test_cache_to_cache();
+        test_protocol_variants();
+        test_snoop_filter();
+        test_directory();
+        if (!RAMTest::runAllTests()) {
+            return 1;
+        }
         std::cout << "All tests passed successfully!" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Test failed with error: " << e.what() << std::endl;
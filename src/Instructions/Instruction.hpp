@@ -19,7 +19,8 @@ enum class OpCode {
     ADD,    // ADD Rd, Ra, Rb    (suma entera)
     CMP,    // CMP Ra, Rb        (compara Ra con Rb)
     JL,     // JL label          (salta si último CMP fue menor)
-    JLE     // JLE label         (salta si último CMP fue menor o igual)
+    JLE,    // JLE label         (salta si último CMP fue menor o igual)
+    FENCE   // FENCE             (espera a que el store buffer drene)
 };
 
 struct Instruction {
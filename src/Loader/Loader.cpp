@@ -288,6 +288,9 @@ std::vector<Instruction> Loader::secondPass(const std::vector<std::string>& line
             if (rd == -1) throw std::runtime_error("DEC espera registro como destino: " + tokens[1]);
             inst.rd = rd;
         } 
+        else if (opcode == "FENCE") {
+            inst.op = OpCode::FENCE;
+        }
         else if (opcode == "JNZ") {
             inst.op = OpCode::JNZ;
             std::string target = trim(tokens[1]);
@@ -390,6 +393,9 @@ std::string Loader::parseInstructionToString(const Instruction& inst) {
         case OpCode::JNZ:
             ss << "JNZ " << inst.imm;
             break;
+        case OpCode::FENCE:
+            ss << "FENCE";
+            break;
         default:
             ss << "INVALID";
             break;
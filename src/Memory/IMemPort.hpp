@@ -1,10 +1,21 @@
 // src/Memory/IMemPort.hpp
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 class IMemPort {
 public:
     virtual uint64_t load(uint64_t addr) = 0;
     virtual void store(uint64_t addr, uint64_t data) = 0;
+
+    // Escritura no bloqueante para el store buffer del PE. Devuelve false si
+    // el puerto no puede aceptarla ahora (reintentar tras tick()). Por defecto
+    // es síncrona.
+    virtual bool tryStore(uint64_t addr, uint64_t data) { store(addr, data); return true; }
+    // Avanza los accesos en vuelo (sin efecto en puertos síncronos)
+    virtual void tick() {}
+    // Escrituras aceptadas por tryStore que aún no se completaron
+    virtual size_t pendingStores() const { return 0; }
+
     virtual ~IMemPort() = default;
 };
@@ -2,18 +2,43 @@
 #include <iostream>
 #include "PE.hpp"
 #include "../Clock/Clock.hpp"
+#include "../Trace/Trace.hpp"
 #include <cstring>
 #include <stdexcept>
 
 PE::PE(int id)
 : id_(id), running_(false), mem_(nullptr),
-  instr_count_(0), load_count_(0), store_count_(0), cycle_count_(0), int_instr_count_(0) {
+  store_buffer_(std::make_unique<StoreBuffer>()),
+  instr_count_(0), load_count_(0), store_count_(0), cycle_count_(0), int_instr_count_(0),
+  store_forwards_(0), store_buffer_stalls_(0), fence_count_(0) {
     std::memset(regs_, 0, sizeof(regs_));
 }
 
 void PE::loadProgram(const std::vector<Instruction>& prog) { program_ = prog; }
 void PE::attachMemory(IMemPort* mem) { mem_ = mem; }
 
+void PE::setStoreBufferSize(size_t entries) {
+    if (store_buffer_ && !store_buffer_->empty()) {
+        throw std::logic_error("No se puede redimensionar un store buffer con stores pendientes");
+    }
+    store_buffer_ = entries ? std::make_unique<StoreBuffer>(entries) : nullptr;
+}
+
+// Drenaje en segundo plano: una entrada por instrucción retirada
+void PE::drainStoreBufferStep() {
+    if (!store_buffer_) return;
+    if (!store_buffer_->empty()) {
+        store_buffer_->drainOne(*mem_);
+    }
+    mem_->tick();
+}
+
+// Equivalente a un FENCE: todos los stores visibles en la caché
+void PE::drainStoreBuffer() {
+    if (!store_buffer_) return;
+    cycle_count_ += store_buffer_->drainAll(*mem_);
+}
+
 void PE::start() {
     if (running_) return;
     running_ = true;
@@ -37,10 +62,11 @@ void PE::runToCompletion() {
     uint64_t executed = 0;
     
     while (running_ && pc < program_.size() && executed < max_instructions) {
-        std::cout << "PE" << id_ << " ejecutando instrucción " << executed 
-                  << " en PC=" << pc << std::endl;
+        TRACE(PE, DETAIL, "PE" << id_ << " ejecutando instrucción " << executed 
+              << " en PC=" << pc);
         
         executeInstruction(program_[pc], pc);
+        drainStoreBufferStep();
         ++instr_count_;
         ++int_instr_count_;
         ++executed;
@@ -49,19 +75,22 @@ void PE::runToCompletion() {
             std::cerr << "¡Alerta! PE" << id_ << " alcanzó el límite de instrucciones." << std::endl;
         }
     }
+    drainStoreBuffer();
     running_ = false;
     
-    std::cout << "PE" << id_ << " terminó después de " << executed 
-              << " instrucciones." << std::endl;
+    TRACE(PE, BASIC, "PE" << id_ << " terminó después de " << executed 
+          << " instrucciones.");
 }
 
 void PE::threadMain() {
     size_t pc = 0;
     while (running_ && pc < program_.size()) {
         executeInstruction(program_[pc], pc);
+        drainStoreBufferStep();
         ++instr_count_;
         ++int_instr_count_;
     }
+    drainStoreBuffer();
     running_ = false;
 }
 
@@ -82,7 +111,14 @@ void PE::executeInstruction(const Instruction& inst, size_t &pc) {
     switch (inst.op) {
         case OpCode::LOAD: {
             uint64_t addr = (inst.ra >= 0) ? regs_[inst.ra] : inst.imm;
-            regs_[inst.rd] = mem_->load(addr);
+            uint64_t value = 0;
+            if (store_buffer_ && store_buffer_->forward(addr, value)) {
+                // Store-to-load forwarding desde el buffer propio
+                store_forwards_++;
+            } else {
+                value = mem_->load(addr);
+            }
+            regs_[inst.rd] = value;
             load_count_++;
             cycle_count_ += 1;
             clock.tick();
@@ -91,12 +127,33 @@ void PE::executeInstruction(const Instruction& inst, size_t &pc) {
         }
         case OpCode::STORE: {
             uint64_t addr = (inst.rb >= 0) ? regs_[inst.rb] : inst.imm;
-            mem_->store(addr, regs_[inst.ra]);
+            if (store_buffer_) {
+                // Se retira al entrar al buffer; si está lleno, esperar a que drene
+                while (store_buffer_->full()) {
+                    if (!store_buffer_->drainOne(*mem_)) {
+                        mem_->tick();
+                    }
+                    store_buffer_stalls_++;
+                    cycle_count_ += 1;
+                }
+                store_buffer_->push(addr, regs_[inst.ra]);
+            } else {
+                mem_->store(addr, regs_[inst.ra]);
+            }
             store_count_++;
             cycle_count_ += 1;
             ++pc;
             break;
         }
+        case OpCode::FENCE: {
+            size_t pending = store_buffer_ ? store_buffer_->size() : 0;
+            drainStoreBuffer();
+            fence_count_++;
+            TRACE(PE, BASIC, "PE" << id_ << " FENCE: " << pending << " stores drenados");
+            cycle_count_ += 1;
+            ++pc;
+            break;
+        }
         case OpCode::FMUL: {
             double a = uint64ToDouble(regs_[inst.ra]);
             double b = uint64ToDouble(regs_[inst.rb]);
@@ -121,7 +178,7 @@ void PE::executeInstruction(const Instruction& inst, size_t &pc) {
                 throw std::runtime_error("División por cero");
             }
             regs_[inst.rd] = static_cast<uint64_t>(a / b);
-            std::cout << "DIV: " << a << " / " << b << " = " << (a / b) << std::endl;
+            TRACE(PE, BASIC, "DIV: " << a << " / " << b << " = " << (a / b));
             cycle_count_ += 10;  // División es más costosa
             ++pc;
             break;
@@ -166,8 +223,8 @@ void PE::executeInstruction(const Instruction& inst, size_t &pc) {
             else regs_[0] = 2;             // Greater
             
             // Debug
-            std::cout << "CMP: " << signed_a << " vs " << signed_b 
-                      << " = " << regs_[0] << std::endl;
+            TRACE(PE, BASIC, "CMP: " << signed_a << " vs " << signed_b 
+                  << " = " << regs_[0]);
             
             cycle_count_ += 1;
             ++pc;
@@ -176,10 +233,10 @@ void PE::executeInstruction(const Instruction& inst, size_t &pc) {
         case OpCode::JL: {
             // Salta si la última comparación fue "menor que"
             if (regs_[0] == 1) {  // Si el último CMP resultó en "menor que"
-                std::cout << "JL: Saltando a " << inst.imm << std::endl;
+                TRACE(PE, BASIC, "JL: Saltando a " << inst.imm);
                 pc = inst.imm;
             } else {
-                std::cout << "JL: No salta, continúa" << std::endl;
+                TRACE(PE, BASIC, "JL: No salta, continúa");
                 ++pc;
             }
             cycle_count_ += 1;
@@ -2,17 +2,23 @@
 #pragma once
 #include "Instruction.hpp"
 #include "../Memory/IMemPort.hpp"
+#include "StoreBuffer.hpp"
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <cstdint>
+#include <memory>
 
 class PE {
 public:
+    static constexpr int NUM_REGS = 16;  // REG0 (banderas de CMP) .. REG15
+
     PE(int id);
 
     void loadProgram(const std::vector<Instruction>& prog);
     void attachMemory(IMemPort* mem);
+    // Entradas del store buffer; 0 lo desactiva (STORE bloqueante)
+    void setStoreBufferSize(size_t entries);
     void start();
     void join();
     void stop();
@@ -23,6 +29,10 @@ public:
     uint64_t getStoreCount() const;
     uint64_t getCycleCount() const;
     int getIntInstructionCount() const;
+    uint64_t getStoreForwardCount() const { return store_forwards_; }
+    uint64_t getStoreBufferStallCount() const { return store_buffer_stalls_; }
+    uint64_t getFenceCount() const { return fence_count_; }
+    size_t getStoreBufferSize() const { return store_buffer_ ? store_buffer_->capacity() : 0; }
 
     const uint64_t* regs() const;
     int getId() const { return id_; }
@@ -30,17 +40,23 @@ public:
 private:
     void threadMain();
     void executeInstruction(const Instruction& inst, size_t &pc);
+    void drainStoreBufferStep();
+    void drainStoreBuffer();
 
     int id_;
     std::thread thr_;
     std::atomic<bool> running_;
     std::vector<Instruction> program_;
     IMemPort* mem_;
-    uint64_t regs_[9];
+    uint64_t regs_[NUM_REGS];
+    std::unique_ptr<StoreBuffer> store_buffer_;
 
     uint64_t instr_count_;
     uint64_t load_count_;
     uint64_t store_count_;
     uint64_t cycle_count_;
     int int_instr_count_;
+    uint64_t store_forwards_;
+    uint64_t store_buffer_stalls_;
+    uint64_t fence_count_;
 };
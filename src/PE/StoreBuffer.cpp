@@ -0,0 +1,53 @@
+// src/PE/StoreBuffer.cpp
+#include "StoreBuffer.hpp"
+#include <stdexcept>
+
+StoreBuffer::StoreBuffer(size_t capacity)
+: entries_(capacity), head_(0), count_(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument("StoreBuffer: la capacidad debe ser > 0");
+    }
+}
+
+void StoreBuffer::push(uint64_t addr, uint64_t value) {
+    if (full()) {
+        throw std::logic_error("StoreBuffer lleno");
+    }
+    entries_[(head_ + count_) % entries_.size()] = {addr, value};
+    ++count_;
+}
+
+bool StoreBuffer::forward(uint64_t addr, uint64_t& value) const {
+    // Del más joven al más antiguo
+    for (size_t i = count_; i > 0; --i) {
+        const Entry& e = entries_[(head_ + i - 1) % entries_.size()];
+        if (e.addr == addr) {
+            value = e.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StoreBuffer::drainOne(IMemPort& mem) {
+    if (empty()) return false;
+    // TSO: si la entrada anterior sigue en un MSHR, un hit de la siguiente
+    // se haría visible antes; se espera a que el puerto la complete
+    if (mem.pendingStores() > 0) return false;
+    const Entry& e = entries_[head_];
+    if (!mem.tryStore(e.addr, e.value)) return false;
+    head_ = (head_ + 1) % entries_.size();
+    --count_;
+    return true;
+}
+
+uint64_t StoreBuffer::drainAll(IMemPort& mem) {
+    uint64_t cycles = 0;
+    while (!empty() || mem.pendingStores() > 0) {
+        if (!drainOne(mem)) {
+            mem.tick();
+        }
+        ++cycles;
+    }
+    return cycles;
+}
@@ -0,0 +1,43 @@
+// src/PE/StoreBuffer.hpp
+#pragma once
+#include "../Memory/IMemPort.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Store buffer FIFO por PE (estilo TSO): el STORE se retira al entrar al
+// buffer, las entradas bajan a memoria en orden y un LOAD posterior del
+// mismo PE lee el valor más joven pendiente para su dirección.
+class StoreBuffer {
+public:
+    explicit StoreBuffer(size_t capacity = 8);
+
+    size_t capacity() const { return entries_.size(); }
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == entries_.size(); }
+
+    // Requiere !full()
+    void push(uint64_t addr, uint64_t value);
+
+    // Forwarding: true si hay un store pendiente para addr (el más joven)
+    bool forward(uint64_t addr, uint64_t& value) const;
+
+    // Intenta bajar la entrada más antigua; true si el puerto la aceptó.
+    // No emite mientras el puerto tenga una escritura anterior en vuelo.
+    bool drainOne(IMemPort& mem);
+
+    // FENCE: vacía el buffer y espera a que el puerto complete las escrituras.
+    // Devuelve los ciclos empleados.
+    uint64_t drainAll(IMemPort& mem);
+
+private:
+    struct Entry {
+        uint64_t addr;
+        uint64_t value;
+    };
+
+    std::vector<Entry> entries_;  // Anillo de capacidad fija
+    size_t head_;                 // Entrada más antigua
+    size_t count_;
+};
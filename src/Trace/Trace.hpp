@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+// ============================================================
+// Trazas por categoría y nivel.
+//
+// - En compilación: TRACE_COMPILED_MASK (categorías) y TRACE_COMPILED_LEVEL
+//   deciden qué trazas existen. Las descartadas se eliminan con
+//   `if constexpr`, así que el camino caliente no evalúa ni formatea nada.
+//   Build silencioso: -DTRACE_COMPILED_MASK=0 (make QUIET=1 en src/).
+// - En ejecución: las categorías compiladas pueden activarse/desactivarse
+//   con Trace::setMask()/setLevel() (pe_tests --quiet / --trace).
+// ============================================================
+
+enum class TraceCategory : uint32_t {
+    CACHE        = 1u << 0,  // Hits/misses, fills y writebacks de Cache
+    MESI         = 1u << 1,  // Transiciones del protocolo de coherencia
+    PE           = 1u << 2,  // Ejecución de instrucciones
+    BUS          = 1u << 3,  // InterconnectBusInterface / BusController
+    INTERCONNECT = 1u << 4,  // Arbitraje y broadcast del Interconnect
+    RAM          = 1u << 5   // Lecturas/escrituras de RAM
+};
+
+enum class TraceLevel : uint32_t {
+    BASIC  = 1,  // Eventos principales (hit/miss, transiciones)
+    DETAIL = 2   // Mensajes secundarios (envío de mensajes, detalles de bus)
+};
+
+#ifndef TRACE_COMPILED_MASK
+#define TRACE_COMPILED_MASK 0xFFFFFFFFu
+#endif
+
+#ifndef TRACE_COMPILED_LEVEL
+#define TRACE_COMPILED_LEVEL 2
+#endif
+
+class Trace {
+public:
+    static constexpr uint32_t ALL = 0xFFFFFFFFu;
+
+    static constexpr bool compiled(TraceCategory category, TraceLevel level) {
+        return (static_cast<uint32_t>(TRACE_COMPILED_MASK) & static_cast<uint32_t>(category)) != 0 &&
+               static_cast<uint32_t>(level) <= static_cast<uint32_t>(TRACE_COMPILED_LEVEL);
+    }
+
+    static bool enabled(TraceCategory category, TraceLevel level) {
+        return (mask().load(std::memory_order_relaxed) & static_cast<uint32_t>(category)) != 0 &&
+               static_cast<uint32_t>(level) <= levelRef().load(std::memory_order_relaxed);
+    }
+
+    static void setMask(uint32_t categories) { mask().store(categories, std::memory_order_relaxed); }
+    static uint32_t getMask() { return mask().load(std::memory_order_relaxed); }
+    static void setLevel(TraceLevel level) {
+        levelRef().store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+    }
+
+    // Acepta una lista separada por comas: "cache,mesi,pe,bus,interconnect,ram,all".
+    // Devuelve false si algún nombre no es válido.
+    static bool parseMask(const std::string& text, uint32_t& categories) {
+        categories = 0;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) end = text.size();
+            std::string name = text.substr(start, end - start);
+            if (name == "cache")             categories |= static_cast<uint32_t>(TraceCategory::CACHE);
+            else if (name == "mesi")         categories |= static_cast<uint32_t>(TraceCategory::MESI);
+            else if (name == "pe")           categories |= static_cast<uint32_t>(TraceCategory::PE);
+            else if (name == "bus")          categories |= static_cast<uint32_t>(TraceCategory::BUS);
+            else if (name == "interconnect") categories |= static_cast<uint32_t>(TraceCategory::INTERCONNECT);
+            else if (name == "ram")          categories |= static_cast<uint32_t>(TraceCategory::RAM);
+            else if (name == "all")          categories |= ALL;
+            else return false;
+            start = end + 1;
+        }
+        return true;
+    }
+
+    // Serializa las líneas de distintos hilos para que no se entremezclen
+    static std::mutex& outputMutex() {
+        static std::mutex m;
+        return m;
+    }
+
+private:
+    static std::atomic<uint32_t>& mask() {
+        static std::atomic<uint32_t> m(ALL);
+        return m;
+    }
+    static std::atomic<uint32_t>& levelRef() {
+        static std::atomic<uint32_t> l(static_cast<uint32_t>(TraceLevel::DETAIL));
+        return l;
+    }
+};
+
+// TRACE(CACHE, BASIC, "[PE" << id << "] READ HIT ...");
+// La expresión sólo se evalúa si la categoría está compilada y activa.
+#define TRACE(category, level, expr)                                                   \
+    do {                                                                               \
+        if constexpr (Trace::compiled(TraceCategory::category, TraceLevel::level)) {   \
+            if (Trace::enabled(TraceCategory::category, TraceLevel::level)) {          \
+                std::lock_guard<std::mutex> trace_lock_(Trace::outputMutex());         \
+                std::cout << expr << std::endl;                                        \
+            }                                                                          \
+        }                                                                              \
+    } while (0)
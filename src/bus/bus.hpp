@@ -1,6 +1,7 @@
 #ifndef BUS_HPP
 #define BUS_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 
@@ -16,6 +17,10 @@ struct BusTransaction {
     uint32_t address;      // Block address
     uint32_t pe_id;        // Processing Element ID
     uint64_t data;         // ← CAMBIADO: uint32_t -> uint64_t
+    uint64_t arrival_cycle = 0;  // Ciclo del bus al entrar en la cola del PE
+    uint64_t id = 0;             // Lo asigna el árbitro al sacarla de la cola
+    bool posted = false;         // BusWB de una caché: el bloque ya está en memoria, sólo ocupa el bus
+    std::atomic<bool>* delivered = nullptr;  // Lo activa el interconnect al completar (el PE espera)
     
     std::string toString() const {
         std::string typeStr;
@@ -3,18 +3,19 @@
 
 #include <vector>
 #include <cstdint>
+#include "../Trace/Trace.hpp"
 
 // Forward declaration
-class Cache;
+class ICache;
 
 class BusController {
-    std::vector<Cache*> caches;
+    std::vector<ICache*> caches;
     bool verbose;
     
 public:
     BusController(bool verbose = false) : verbose(verbose) {}
     
-    void registerCache(Cache* cache) {
+    void registerCache(ICache* cache) {
         caches.push_back(cache);
     }
     
@@ -23,9 +24,9 @@ public:
         // Aquí puedes implementar la lógica de snooping
         // Por ahora es un placeholder para coherencia MESI
         if (verbose) {
-            std::cout << "[BusController] Broadcasting transaction for addr=0x" 
-                      << std::hex << address << std::dec 
-                      << " from PE" << originating_pe_id << std::endl;
+            TRACE(BUS, BASIC, "[BusController] Broadcasting transaction for addr=0x" 
+                  << std::hex << address << std::dec 
+                  << " from PE" << originating_pe_id);
         }
     }
     
@@ -8,13 +8,22 @@
 enum class BusEvent;
 struct BusMessage;
 
+// Respuesta agregada de los snoops a un mensaje del bus
+struct SnoopResponse {
+    bool shared = false;         // Otra caché conserva una copia válida
+    bool data_supplied = false;  // Una caché en M/E entregó el bloque (cache-to-cache)
+    bool present = false;        // La caché tenía la línea (respuesta de una sola caché)
+};
+
 // Interfaz abstracta para comunicación con el bus
 class IBusInterface {
 public:
     virtual ~IBusInterface() = default;
     
-    // Enviar mensaje al bus
-    virtual void sendMessage(const BusMessage& msg) = 0;
+    // Enviar mensaje al bus. En BUS_READ/BUS_READX, `block` (un bloque
+    // completo) recibe el dato si otra caché lo entrega; en ese caso el
+    // solicitante no debe leer memoria.
+    virtual SnoopResponse sendMessage(const BusMessage& msg, uint8_t* block = nullptr) = 0;
     
     // Leer desde memoria
     virtual void readFromMemory(uint64_t address, uint8_t* data, size_t size) = 0;
@@ -22,8 +31,21 @@ public:
     // Escribir a memoria
     virtual void writeToMemory(uint64_t address, const uint8_t* data, size_t size) = 0;
     
-    // Transferencia cache-to-cache (opcional)
-    virtual void supplyData(uint64_t address, const uint8_t* data) = 0;
+    // Aviso de desalojo de una línea válida (opcional). written_back indica
+    // si el bloque ya se escribió con writeToMemory.
+    virtual void notifyEviction(uint64_t /*address*/, const uint8_t* /*data*/,
+                                size_t /*size*/, bool /*written_back*/) {}
+    
+    // Respuesta del interconnect a un miss (opcional). awaitResponse() marca
+    // la solicitud que acaba de emitir sendMessage y devuelve un ticket (0 si
+    // no hay nada que esperar); responseArrived(ticket) es true una vez que
+    // el interconnect la entregó, y desde entonces el ticket no vale.
+    virtual uint64_t awaitResponse() { return 0; }
+    virtual bool responseArrived(uint64_t /*ticket*/) { return true; }
+    
+    // La L2 inclusiva invalidó la línea (opcional). A diferencia de
+    // notifyEviction no debe volver a la L2: se llama desde su desalojo.
+    virtual void notifyBackInvalidation(uint64_t /*address*/) {}
 };
 
 #endif // BUS_INTERFACE_H
\ No newline at end of file
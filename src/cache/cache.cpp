@@ -1,361 +1,850 @@
 #include "cache.hpp"
+#include "../Trace/Trace.hpp"
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <stdexcept>
+#include <string>
 
-Cache::Cache(int pe_id) : pe_id(pe_id), bus_interface(nullptr) {
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+Cache<Sets, Ways, BlockSize, Replacement>::Cache(int pe_id) 
+    : pe_id(pe_id), bus_interface(nullptr), access_count(0),
+      mshrs(std::make_unique<MSHRFile>()), staged_fill(nullptr), sharing_profiler(nullptr) {
+    for (BlockType& block : data_store) {
+        block.fill(0);
+    }
+    
     // Inicializar componentes modulares
-    mesi_controller = std::make_unique<MESIController>(pe_id);
+    coherence = createCoherenceController(CoherenceProtocol::MESI, pe_id);
     write_policy = std::make_unique<WritePolicy>(
         WriteHitPolicy::WRITE_BACK,
         WriteMissPolicy::WRITE_ALLOCATE
     );
 }
 
-int Cache::findWay(uint8_t index, uint64_t tag) {
-    for (size_t way = 0; way < CACHE_WAYS; way++) {
-        CacheLine& line = cache_sets[index].ways[way];
-        if (line.valid && line.tag == tag) {
-            return static_cast<int>(way);
-        }
-    }
-    return -1;
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+int Cache<Sets, Ways, BlockSize, Replacement>::findWay(uint32_t index, uint64_t tag) {
+    return cache_sets[index].findWay(tag);
 }
 
-int Cache::selectVictim(uint8_t index) {
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+int Cache<Sets, Ways, BlockSize, Replacement>::selectVictim(uint32_t index) {
     // Primero buscar líneas inválidas
-    for (size_t way = 0; way < CACHE_WAYS; way++) {
-        if (!cache_sets[index].ways[way].valid) {
-            return static_cast<int>(way);
-        }
+    int free_way = cache_sets[index].findInvalidWay();
+    if (free_way != -1) {
+        return free_way;
     }
     
-    // Si todas son válidas, usar LRU
-    return cache_sets[index].lru->findVictim();
+    // Si todas son válidas, consultar la política de reemplazo
+    return cache_sets[index].replacement.findVictim();
 }
 
-void Cache::writebackLine(uint8_t index, int way) {
-    CacheLine& line = cache_sets[index].ways[way];
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::writebackLine(uint32_t index, int way) {
+    SetType& set = cache_sets[index];
     
-    if (line.dirty && line.valid) {
+    if (set.isDirty(way) && set.isValid(way)) {
         // Reconstruir dirección base del bloque completo
-        uint64_t address = (line.tag << (OFFSET_BITS + INDEX_BITS)) | 
-                          (index << OFFSET_BITS);
+        uint64_t address = AddressType::blockAddress(set.tags[way], index);
         
         // Escribir a memoria a través del bus interface (si existe)
         if (bus_interface != nullptr) {
-            bus_interface->writeToMemory(address, line.data.data(), CACHE_BLOCK_SIZE);
+            bus_interface->writeToMemory(address, blockData(index, way), BlockSize);
         }
         
         stats.writebacks++;
-        line.dirty = false;
+        set.setDirty(way, false);
         
-        std::cout << "[PE" << pe_id << "] Writeback to MEMORY: addr=0x" 
-                  << std::hex << address << std::dec;
-        if (bus_interface == nullptr) {
-            std::cout << " (No bus connected - standalone mode)";
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] Writeback to MEMORY: addr=0x" 
+              << std::hex << address << std::dec
+              << (bus_interface == nullptr ? " (No bus connected - standalone mode)" : ""));
+    }
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::evictLine(uint32_t index, int way) {
+    SetType& set = cache_sets[index];
+    uint64_t block_address = AddressType::blockAddress(set.tags[way], index);
+    discardPrefetch(index, way, block_address);
+    
+    MESIResult evict_result = coherence->processEvent(
+        set.getMESI(way), BusEvent::EVICTION
+    );
+    
+    bool written_back = evict_result.needs_writeback && set.isDirty(way);
+    if (evict_result.needs_writeback) {
+        writebackLine(index, way);
+    }
+    
+    // Avisar al nivel inferior (p. ej. una L2 exclusiva instala la víctima)
+    if (bus_interface != nullptr) {
+        bus_interface->notifyEviction(block_address, blockData(index, way), BlockSize, written_back);
+    }
+}
+
+// ============================================================
+// PREFETCH
+// ============================================================
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::consumePrefetch(uint32_t index, int way, uint64_t block_address) {
+    cache_sets[index].setPrefetched(way, false);
+    stats.prefetch_useful++;
+    if (prefetcher) {
+        stats.prefetch_lead_accesses += prefetcher->noteUsed(block_address, access_count);
+    }
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::discardPrefetch(uint32_t index, int way, uint64_t block_address) {
+    SetType& set = cache_sets[index];
+    if (set.isPrefetched(way)) {
+        set.setPrefetched(way, false);
+        stats.prefetch_unused++;
+        if (prefetcher) {
+            prefetcher->noteDropped(block_address);
         }
-        std::cout << std::endl;
     }
 }
 
-bool Cache::fetchBlock(uint64_t address, uint8_t* data) {
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::runPrefetcher(uint64_t block_address, bool trigger) {
+    if (!prefetcher) {
+        return;
+    }
+    prefetch_candidates.clear();
+    prefetcher->observe(block_address, trigger, prefetch_candidates);
+    for (uint64_t candidate : prefetch_candidates) {
+        issuePrefetch(candidate);
+    }
+    stats.prefetch_unused += prefetcher->takeDropped();
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::issuePrefetch(uint64_t block_address) {
+    AddressType addr(block_address);
+    bool side_buffer = prefetcher->usesSideBuffer();
+    
+    // Ya presente o con su miss en vuelo: nada que traer (y el buffer
+    // lateral libera la reserva)
+    if (findWay(addr.index, addr.tag) != -1 || mshrs->find(block_address) != nullptr) {
+        if (side_buffer) {
+            prefetcher->invalidate(block_address);
+        }
+        return;
+    }
+    
+    // El prefetch es una lectura compartida normal: BusRd por el interconnect
+    if (side_buffer) {
+        BlockType staged;
+        requestBlock(BusEvent::BUS_READ, block_address, staged.data());
+        prefetcher->fillBuffer(block_address, staged.data());
+    } else {
+        int victim_way = selectVictim(addr.index);
+        SetType& set = cache_sets[addr.index];
+        if (set.isValid(victim_way)) {
+            evictLine(addr.index, victim_way);
+        }
+        
+        SnoopResponse snoop = requestBlock(BusEvent::BUS_READ, block_address,
+                                           blockData(addr.index, victim_way));
+        coherence->processEvent(MESIState::INVALID, BusEvent::LOCAL_READ);
+        
+        set.setValid(victim_way, true);
+        set.tags[victim_way] = addr.tag;
+        set.setDirty(victim_way, false);
+        set.setMESI(victim_way, coherence->resolveReadFill(snoop.shared));
+        set.setPrefetched(victim_way, true);
+        set.replacement.insert(victim_way);
+    }
+    
+    stats.prefetch_issued++;
+    prefetcher->noteIssued(block_address, access_count);
+    
+    TRACE(CACHE, DETAIL, "[PE" << pe_id << "] PREFETCH (" << prefetcherKindName(prefetcher->kind())
+          << "): addr=0x" << std::hex << block_address << std::dec
+          << (side_buffer ? " -> stream buffer" : " -> cache"));
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::fetchBlock(uint64_t address, uint8_t* data) {
     // IMPORTANTE: Alinear la dirección al inicio del bloque de cache
-    uint64_t block_address = (address / CACHE_BLOCK_SIZE) * CACHE_BLOCK_SIZE;
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
     
     // Fetch desde memoria a través del bus interface
     if (bus_interface != nullptr) {
-        bus_interface->readFromMemory(block_address, data, CACHE_BLOCK_SIZE);
+        bus_interface->readFromMemory(block_address, data, BlockSize);
     } else {
         // Modo standalone: simula lectura con datos dummy
-        std::memset(data, 0xAB, CACHE_BLOCK_SIZE);
-        std::cout << "[PE" << pe_id << "] Fetching block (standalone mode): addr=0x" 
-                  << std::hex << block_address << std::dec << std::endl;
+        std::memset(data, 0xAB, BlockSize);
+        TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Fetching block (standalone mode): addr=0x" 
+              << std::hex << block_address << std::dec);
     }
     
     return true;
 }
 
-bool Cache::read(uint64_t address, uint64_t& data) {
-    Address addr(address);
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+SnoopResponse Cache<Sets, Ways, BlockSize, Replacement>::requestBlock(BusEvent event, uint64_t address, uint8_t* data) {
+    SnoopResponse snoop;
+    if (bus_interface != nullptr) {
+        BusMessage msg{address, event, pe_id};
+        snoop = bus_interface->sendMessage(msg, data);
+        TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Sending " << CoherenceController::getEventName(event)
+              << " message for addr=0x" << std::hex << address << std::dec
+              << (snoop.shared ? " [shared]" : ""));
+    }
+    
+    // Otra caché en M/E ya entregó el bloque: no se lee memoria
+    if (snoop.data_supplied) {
+        stats.c2c_received++;
+        TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Block supplied cache-to-cache: addr=0x" 
+              << std::hex << address << std::dec);
+    } else {
+        fetchBlock(address, data);
+        stats.memory_fills++;
+    }
+    return snoop;
+}
+
+// Bloque para un miss: el que ya trajo su MSHR o, si no hay, uno pedido al bus
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+SnoopResponse Cache<Sets, Ways, BlockSize, Replacement>::fillBlock(BusEvent event, uint64_t address, uint8_t* data) {
+    if (staged_fill == nullptr) {
+        return requestBlock(event, address, data);
+    }
+    std::memcpy(data, staged_fill->fill.data(), BlockSize);
+    SnoopResponse snoop;
+    snoop.shared = staged_fill->shared;
+    staged_fill = nullptr;
+    return snoop;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::read(uint64_t address, uint64_t& data) {
+    AddressType addr(address);
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
     int way = findWay(addr.index, addr.tag);
+    access_count++;
+    if (sharing_profiler) {
+        sharing_profiler->noteAccess(pe_id, address, false);
+    }
+    if (reuse_profiler) {
+        reuse_profiler->access(block_address);
+    }
     
     if (way != -1) {
         // **HIT de lectura**
         stats.read_hits++;
-        CacheLine& line = cache_sets[addr.index].ways[way];
+        if (miss_classifier) {
+            miss_classifier->noteHit(block_address);
+        }
+        SetType& set = cache_sets[addr.index];
+        
+        // Primer uso de un bloque prefetcheado
+        bool prefetch_hit = set.isPrefetched(way);
+        if (prefetch_hit) {
+            consumePrefetch(addr.index, way, block_address);
+        }
         
         // Procesar con MESI (evento local)
-        MESIResult mesi_result = mesi_controller->processEvent(
-            line.mesi_state, BusEvent::LOCAL_READ
+        MESIResult mesi_result = coherence->processEvent(
+            set.getMESI(way), BusEvent::LOCAL_READ
         );
         
-        line.mesi_state = mesi_result.new_state;
+        set.setMESI(way, mesi_result.new_state);
         
         // Extraer dato
-        std::memcpy(&data, &line.data[addr.offset], sizeof(uint64_t));
+        std::memcpy(&data, blockData(addr.index, way) + addr.offset, sizeof(uint64_t));
         
-        // Actualizar LRU
-        cache_sets[addr.index].lru->access(way);
+        // Actualizar política de reemplazo
+        set.replacement.access(way);
         
-        std::cout << "[PE" << pe_id << "] READ HIT: addr=0x" 
-                  << std::hex << address << " data=0x" << data << std::dec 
-                  << " [" << MESIController::getStateName(line.mesi_state) << "]" << std::endl;
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] READ HIT: addr=0x" 
+              << std::hex << address << " data=0x" << data << std::dec 
+              << " [" << CoherenceController::getStateName(set.getMESI(way)) << "]");
         
+        runPrefetcher(block_address, prefetch_hit);
         return true;
         
     } else {
-        // **MISS de lectura**
-        stats.read_misses++;
+        // Un stream buffer puede tener el bloque: se mueve a la caché sin ir al bus
+        BlockType staged;
+        bool from_buffer = prefetcher && prefetcher->takeFromBuffer(block_address, staged.data());
         
-        std::cout << "[PE" << pe_id << "] READ MISS: addr=0x" 
-                  << std::hex << address << std::dec << std::endl;
+        if (from_buffer) {
+            stats.read_hits++;
+            stats.prefetch_useful++;
+            if (miss_classifier) {
+                miss_classifier->noteHit(block_address);
+            }
+            stats.prefetch_lead_accesses += prefetcher->noteUsed(block_address, access_count);
+            TRACE(CACHE, BASIC, "[PE" << pe_id << "] READ HIT (stream buffer): addr=0x" 
+                  << std::hex << address << std::dec);
+        } else {
+            // **MISS de lectura**
+            stats.read_misses++;
+            classifyMiss(addr.index, block_address);
+            TRACE(CACHE, BASIC, "[PE" << pe_id << "] READ MISS: addr=0x" 
+                  << std::hex << address << std::dec);
+        }
         
         // Seleccionar víctima
         int victim_way = selectVictim(addr.index);
-        CacheLine& line = cache_sets[addr.index].ways[victim_way];
+        SetType& set = cache_sets[addr.index];
         
         // Procesar evicción si la línea es válida
-        if (line.valid) {
-            MESIResult evict_result = mesi_controller->processEvent(
-                line.mesi_state, BusEvent::EVICTION
-            );
-            
-            if (evict_result.needs_writeback) {
-                writebackLine(addr.index, victim_way);
-            }
+        if (set.isValid(victim_way)) {
+            evictLine(addr.index, victim_way);
         }
         
         // Procesar miss con MESI - Esto genera el mensaje BUS_READ
-        MESIResult mesi_result = mesi_controller->processEvent(
+        MESIResult mesi_result = coherence->processEvent(
             MESIState::INVALID, BusEvent::LOCAL_READ
         );
         
-        // Enviar mensaje de BUS_READ al bus (solo si hay bus conectado)
-        if (mesi_result.needs_bus_message && bus_interface != nullptr) {
-            BusMessage msg{address, BusEvent::BUS_READ, pe_id};
-            bus_interface->sendMessage(msg);
-            std::cout << "[PE" << pe_id << "] Sending BUS_READ message for addr=0x" 
-                      << std::hex << address << std::dec << std::endl;
+        if (from_buffer) {
+            // El BusRd se emitió al prefetchear; un BusRdX posterior lo habría descartado.
+            // El buffer no responde a snoops, así que otro PE pudo leer el
+            // bloque entretanto: se instala en S por seguridad.
+            std::memcpy(blockData(addr.index, victim_way), staged.data(), BlockSize);
+            mesi_result.new_state = MESIState::SHARED;
+        } else {
+            // BUS_READ: la señal shared decide entre S y E
+            SnoopResponse snoop = fillBlock(BusEvent::BUS_READ, address,
+                                            blockData(addr.index, victim_way));
+            mesi_result.new_state = coherence->resolveReadFill(snoop.shared);
         }
-        
-        // SIEMPRE va a memoria
-        if (mesi_result.fetch_from_memory) {
-            fetchBlock(address, line.data.data());
+        if (mesi_result.new_state == MESIState::SHARED || mesi_result.new_state == MESIState::FORWARD) {
+            stats.shared_fills++;
         }
         
         // Actualizar metadatos
-        line.valid = true;
-        line.tag = addr.tag;
-        line.dirty = false;
-        line.mesi_state = mesi_result.new_state;
+        set.setValid(victim_way, true);
+        set.tags[victim_way] = addr.tag;
+        set.setDirty(victim_way, false);
+        set.setPrefetched(victim_way, false);
+        set.setMESI(victim_way, mesi_result.new_state);
         
         // Extraer dato
-        std::memcpy(&data, &line.data[addr.offset], sizeof(uint64_t));
+        std::memcpy(&data, blockData(addr.index, victim_way) + addr.offset, sizeof(uint64_t));
         
-        // Actualizar LRU
-        cache_sets[addr.index].lru->access(victim_way);
+        // Actualizar política de reemplazo (inserción)
+        set.replacement.insert(victim_way);
         
         stats.mesi_transitions++;
         
-        return false;
+        runPrefetcher(block_address, true);
+        return from_buffer;
     }
 }
 
-bool Cache::write(uint64_t address, uint64_t data) {
-    Address addr(address);
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::write(uint64_t address, uint64_t data) {
+    AddressType addr(address);
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
     int way = findWay(addr.index, addr.tag);
+    access_count++;
+    if (sharing_profiler) {
+        sharing_profiler->noteAccess(pe_id, address, true);
+    }
+    if (reuse_profiler) {
+        reuse_profiler->access(block_address);
+    }
     
     if (way != -1) {
         // **HIT de escritura**
         stats.write_hits++;
-        CacheLine& line = cache_sets[addr.index].ways[way];
+        if (miss_classifier) {
+            miss_classifier->noteHit(block_address);
+        }
+        SetType& set = cache_sets[addr.index];
+        
+        bool prefetch_hit = set.isPrefetched(way);
+        if (prefetch_hit) {
+            consumePrefetch(addr.index, way, block_address);
+        }
         
-        MESIState old_state = line.mesi_state;
+        MESIState old_state = set.getMESI(way);
         
         // Procesar con MESI (evento local)
-        MESIResult mesi_result = mesi_controller->processEvent(
-            line.mesi_state, BusEvent::LOCAL_WRITE
+        MESIResult mesi_result = coherence->processEvent(
+            old_state, BusEvent::LOCAL_WRITE
         );
         
         // Si estábamos en S y vamos a M, enviamos BUS_UPGRADE (solo si hay bus)
         if (mesi_result.needs_bus_message && bus_interface != nullptr) {
             BusMessage msg{address, BusEvent::BUS_UPGRADE, pe_id};
             bus_interface->sendMessage(msg);
-            std::cout << "[PE" << pe_id << "] Sending BUS_UPGRADE message for addr=0x" 
-                      << std::hex << address << std::dec << std::endl;
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Sending BUS_UPGRADE message for addr=0x" 
+                  << std::hex << address << std::dec);
         }
         
-        line.mesi_state = mesi_result.new_state;
+        set.setMESI(way, mesi_result.new_state);
         
         // Escribir dato en caché
-        std::memcpy(&line.data[addr.offset], &data, sizeof(uint64_t));
+        std::memcpy(blockData(addr.index, way) + addr.offset, &data, sizeof(uint64_t));
         
         // Aplicar política de escritura (Write-Back)
         if (write_policy->handleWriteHit()) {
-            line.dirty = true;
+            set.setDirty(way, true);
         }
         
-        // Actualizar LRU
-        cache_sets[addr.index].lru->access(way);
+        // Actualizar política de reemplazo
+        set.replacement.access(way);
         
-        if (old_state != line.mesi_state) {
+        if (old_state != mesi_result.new_state) {
             stats.mesi_transitions++;
         }
         
-        std::cout << "[PE" << pe_id << "] WRITE HIT: addr=0x" 
-                  << std::hex << address << " data=0x" << data << std::dec 
-                  << " [" << MESIController::getStateName(line.mesi_state) << "]" << std::endl;
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] WRITE HIT: addr=0x" 
+              << std::hex << address << " data=0x" << data << std::dec 
+              << " [" << CoherenceController::getStateName(mesi_result.new_state) << "]");
         
+        runPrefetcher(block_address, prefetch_hit);
         return true;
         
     } else {
         // **MISS de escritura**
         stats.write_misses++;
+        classifyMiss(addr.index, block_address);
         
-        std::cout << "[PE" << pe_id << "] WRITE MISS: addr=0x" 
-                  << std::hex << address << std::dec << std::endl;
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] WRITE MISS: addr=0x" 
+              << std::hex << address << std::dec);
         
         // Verificar política de Write-Allocate
         if (!write_policy->handleWriteMiss()) {
-            std::cout << "[PE" << pe_id << "] No-write-allocate: writing directly to memory" << std::endl;
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] No-write-allocate: writing directly to memory");
             return false;
         }
         
+        // La escritura pide el bloque en exclusiva: una copia en el stream
+        // buffer quedaría obsoleta
+        if (prefetcher) {
+            prefetcher->invalidate(block_address);
+        }
+        
         // Write-Allocate: traer el bloque primero
         int victim_way = selectVictim(addr.index);
-        CacheLine& line = cache_sets[addr.index].ways[victim_way];
+        SetType& set = cache_sets[addr.index];
         
         // Procesar evicción
-        if (line.valid) {
-            MESIResult evict_result = mesi_controller->processEvent(
-                line.mesi_state, BusEvent::EVICTION
-            );
-            
-            if (evict_result.needs_writeback) {
-                writebackLine(addr.index, victim_way);
-            }
+        if (set.isValid(victim_way)) {
+            evictLine(addr.index, victim_way);
         }
         
         // Procesar miss con MESI - Genera BUS_READX
-        MESIResult mesi_result = mesi_controller->processEvent(
+        MESIResult mesi_result = coherence->processEvent(
             MESIState::INVALID, BusEvent::LOCAL_WRITE
         );
         
-        // Enviar mensaje BUS_READX al bus (solo si hay bus conectado)
-        if (mesi_result.needs_bus_message && bus_interface != nullptr) {
-            BusMessage msg{address, BusEvent::BUS_READX, pe_id};
-            bus_interface->sendMessage(msg);
-            std::cout << "[PE" << pe_id << "] Sending BUS_READX message for addr=0x" 
-                      << std::hex << address << std::dec << std::endl;
-        }
-        
-        // SIEMPRE va a memoria
-        if (mesi_result.fetch_from_memory) {
-            fetchBlock(address, line.data.data());
-        }
+        // BUS_READX: invalida otras copias; una en M/E entrega el bloque
+        fillBlock(BusEvent::BUS_READX, address, blockData(addr.index, victim_way));
         
         // Actualizar metadatos
-        line.valid = true;
-        line.tag = addr.tag;
-        line.dirty = true;
-        line.mesi_state = mesi_result.new_state;
+        set.setValid(victim_way, true);
+        set.tags[victim_way] = addr.tag;
+        set.setDirty(victim_way, true);
+        set.setPrefetched(victim_way, false);
+        set.setMESI(victim_way, mesi_result.new_state);
         
         // Escribir el dato
-        std::memcpy(&line.data[addr.offset], &data, sizeof(uint64_t));
+        std::memcpy(blockData(addr.index, victim_way) + addr.offset, &data, sizeof(uint64_t));
         
-        // Actualizar LRU
-        cache_sets[addr.index].lru->access(victim_way);
+        // Actualizar política de reemplazo (inserción)
+        set.replacement.insert(victim_way);
         
         stats.mesi_transitions++;
         
+        runPrefetcher(block_address, true);
+        return false;
+    }
+}
+
+// ============================================================
+// ACCESOS NO BLOQUEANTES (MSHR)
+// ============================================================
+// El mensaje de bus del miss sale al asignar el MSHR, así que varios
+// misses están en el bus a la vez. Al completar, los targets se reproducen
+// en orden con read()/write(): el primero instala el bloque que trajo el
+// MSHR (y desaloja la víctima) y los fusionados lo encuentran. Si un snoop
+// tocó el bloque en vuelo, el fill se descarta y el miss se pide de nuevo.
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+AccessStatus Cache<Sets, Ways, BlockSize, Replacement>::readAsync(uint64_t address, CacheCallback callback) {
+    AddressType addr(address);
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
+    
+    // Hit-under-miss: otros bloques se sirven aunque haya misses en vuelo
+    if (mshrs->find(block_address) == nullptr && findWay(addr.index, addr.tag) != -1) {
+        uint64_t data = 0;
+        read(address, data);
+        if (callback) {
+            callback(address, data);
+        }
+        return AccessStatus::HIT;
+    }
+    return queueMiss(false, address, 0, std::move(callback));
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+AccessStatus Cache<Sets, Ways, BlockSize, Replacement>::writeAsync(uint64_t address, uint64_t data,
+                                                                  CacheCallback callback) {
+    AddressType addr(address);
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
+    
+    if (mshrs->find(block_address) == nullptr && findWay(addr.index, addr.tag) != -1) {
+        write(address, data);
+        if (callback) {
+            callback(address, data);
+        }
+        return AccessStatus::HIT;
+    }
+    return queueMiss(true, address, data, std::move(callback));
+}
+
+// Un hit de lectura no cambia el estado de coherencia; uno de escritura sólo
+// si la línea ya es exclusiva (M, o E que pasa a M en silencio). S, O y F
+// necesitan un BusUpgr.
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::hitsLocally(uint64_t address, bool is_write) const {
+    if (prefetcher || sharing_profiler) {
+        return false;
+    }
+    if (mshrs->find(address & ~AddressType::OFFSET_MASK) != nullptr) {
         return false;
     }
+    AddressType addr(address);
+    int way = cache_sets[addr.index].findWay(addr.tag);
+    if (way == -1) {
+        return false;
+    }
+    MESIState state = cache_sets[addr.index].getMESI(way);
+    return !is_write || state == MESIState::MODIFIED || state == MESIState::EXCLUSIVE;
 }
 
-void Cache::handleBusRead(uint64_t address) {
-    Address addr(address);
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+AccessStatus Cache<Sets, Ways, BlockSize, Replacement>::queueMiss(bool is_write, uint64_t address,
+                                                                 uint64_t data, CacheCallback callback) {
+    uint64_t block_address = address & ~AddressType::OFFSET_MASK;
+    
+    MSHREntry* entry = mshrs->find(block_address);
+    if (entry != nullptr) {
+        if (!mshrs->canMerge(*entry)) {
+            stats.mshr_stalls++;
+            return AccessStatus::STALLED;
+        }
+        entry->targets.push_back({is_write, address, data, std::move(callback)});
+        stats.mshr_merges++;
+        TRACE(CACHE, DETAIL, "[PE" << pe_id << "] MSHR merge: addr=0x" 
+              << std::hex << address << std::dec << " (" << entry->targets.size() << " targets)");
+        return AccessStatus::MISS_MERGED;
+    }
+    
+    entry = mshrs->allocate(block_address);
+    if (entry == nullptr) {
+        stats.mshr_stalls++;
+        return AccessStatus::STALLED;
+    }
+    entry->targets.push_back({is_write, address, data, std::move(callback)});
+    issueFill(*entry, is_write, address);
+    stats.mshr_allocations++;
+    if (mshrs->outstanding() > stats.mshr_peak_outstanding) {
+        stats.mshr_peak_outstanding = mshrs->outstanding();
+    }
+    TRACE(CACHE, DETAIL, "[PE" << pe_id << "] MSHR allocated: block=0x" 
+          << std::hex << block_address << std::dec << " (" << mshrs->outstanding() << " in flight)");
+    return AccessStatus::MISS_ISSUED;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::issueFill(MSHREntry& entry, bool is_write, uint64_t address) {
+    // Sin write-allocate, o con el bloque ya en el stream buffer, no hay
+    // nada que pedir por adelantado: se resuelve al completar
+    if (is_write ? !write_policy->handleWriteMiss()
+                 : prefetcher && prefetcher->holdsBlock(entry.block_address)) {
+        return;
+    }
+    entry.fill.resize(BlockSize);
+    SnoopResponse snoop = requestBlock(is_write ? BusEvent::BUS_READX : BusEvent::BUS_READ,
+                                       address, entry.fill.data());
+    entry.issued = true;
+    entry.exclusive = is_write;
+    entry.shared = snoop.shared;
+    entry.supplied = snoop.data_supplied;
+    // El miss no completa antes de que el interconnect entregue la respuesta
+    if (bus_interface != nullptr) {
+        entry.ticket = bus_interface->awaitResponse();
+    }
+}
+
+// Un snoop sobre un bloque con el fill en vuelo invalida la señal shared o
+// la exclusividad con que se pidió. Un bloque que llegó de otra caché por
+// BusRdX puede venir sucio: se baja a memoria antes de que el otro PE la lea.
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::noteSnoopInFlight(uint64_t address) {
+    MSHREntry* entry = mshrs->find(address & ~AddressType::OFFSET_MASK);
+    if (entry == nullptr || !entry->issued || entry->stale) {
+        return;
+    }
+    entry->stale = true;
+    if (entry->exclusive && entry->supplied && bus_interface != nullptr) {
+        bus_interface->writeToMemory(entry->block_address, entry->fill.data(), BlockSize);
+        stats.writebacks++;
+    }
+    TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Snoop on in-flight MSHR: block=0x" 
+          << std::hex << entry->block_address << std::dec << " will be refetched");
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::tick() {
+    if (advanceMisses()) {
+        completeMisses();
+    }
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::advanceMisses() {
+    if (mshrs->outstanding() == 0) {
+        return false;
+    }
+    return mshrs->advance([this](uint64_t ticket) {
+        return bus_interface == nullptr || bus_interface->responseArrived(ticket);
+    }) > 0;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::completeMisses() {
+    // Vector local: un callback puede volver a llamar a readAsync/tick
+    std::vector<MSHREntry> ready;
+    mshrs->collect(ready);
+    
+    for (MSHREntry& entry : ready) {
+        bool primary = true;
+        for (MSHRTarget& target : entry.targets) {
+            staged_fill = primary && entry.issued && !entry.stale ? &entry : nullptr;
+            primary = false;
+            uint64_t value = target.data;
+            if (target.is_write) {
+                write(target.address, target.data);
+            } else {
+                read(target.address, value);
+            }
+            staged_fill = nullptr;
+            if (target.callback) {
+                target.callback(target.address, value);
+            }
+        }
+    }
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::setMSHRConfig(const MSHRConfig& config) {
+    if (mshrs->outstanding() != 0) {
+        throw std::logic_error("No se puede reconfigurar los MSHRs con misses en vuelo");
+    }
+    mshrs = std::make_unique<MSHRFile>(config);
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::setCoherenceProtocol(CoherenceProtocol protocol) {
+    for (const SetType& set : cache_sets) {
+        if (set.valid_mask != 0) {
+            throw std::logic_error("No se puede cambiar el protocolo de coherencia con líneas válidas");
+        }
+    }
+    coherence = createCoherenceController(protocol, pe_id);
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::setMissClassification(bool enabled) {
+    miss_classifier = enabled ? std::make_unique<MissClassifier>(Sets, Ways) : nullptr;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::classifyMiss(uint32_t index, uint64_t block_address) {
+    if (!miss_classifier) {
+        return;
+    }
+    switch (miss_classifier->classifyMiss(block_address, index)) {
+        case MissKind::COMPULSORY: stats.miss_compulsory++; break;
+        case MissKind::CAPACITY:   stats.miss_capacity++;   break;
+        case MissKind::CONFLICT:   stats.miss_conflict++;   break;
+        case MissKind::COHERENCE:  stats.miss_coherence++;  break;
+        case MissKind::INCLUSION:  stats.miss_inclusion++;  break;
+    }
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+SnoopResponse Cache<Sets, Ways, BlockSize, Replacement>::handleBusRead(uint64_t address, uint8_t* supply) {
+    noteSnoopInFlight(address);
+    SnoopResponse response;
+    AddressType addr(address);
     int way = findWay(addr.index, addr.tag);
     
     if (way != -1) {
-        CacheLine& line = cache_sets[addr.index].ways[way];
+        SetType& set = cache_sets[addr.index];
         
-        MESIResult result = mesi_controller->processEvent(
-            line.mesi_state, BusEvent::BUS_READ
+        MESIResult result = coherence->processEvent(
+            set.getMESI(way), BusEvent::BUS_READ
         );
         
-        // Si estamos en M, hacemos writeback para que el solicitante vaya a memoria
+        // Si estamos en M, además de entregar el bloque actualizamos memoria
         if (result.needs_writeback) {
             writebackLine(addr.index, way);
-            std::cout << "[PE" << pe_id << "] Writeback due to BUS_READ (M->S), requester will fetch from memory" << std::endl;
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Writeback due to BUS_READ (M->S)");
         }
         
-        // Si estamos en E, proveemos el dato directamente
-        if (result.supply_data && bus_interface != nullptr) {
-            bus_interface->supplyData(address, line.data.data());
-            std::cout << "[PE" << pe_id << "] Supplying data DIRECTLY via interconnect for addr=0x" 
-                      << std::hex << address << std::dec << " (E->S)" << std::endl;
+        // En M o E proveemos el dato directamente
+        if (result.supply_data && supply != nullptr) {
+            std::memcpy(supply, blockData(addr.index, way), BlockSize);
+            response.data_supplied = true;
+            stats.c2c_supplied++;
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Supplying data DIRECTLY via interconnect for addr=0x" 
+                  << std::hex << address << std::dec << " (" 
+                  << CoherenceController::getStateName(set.getMESI(way)) << "->S)");
         }
         
-        line.mesi_state = result.new_state;
+        // La copia sigue válida: el solicitante debe instalarla en S
+        response.present = true;
+        response.shared = true;
+        set.setMESI(way, result.new_state);
         stats.mesi_transitions++;
     }
+    return response;
 }
 
-void Cache::handleBusReadX(uint64_t address) {
-    Address addr(address);
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+SnoopResponse Cache<Sets, Ways, BlockSize, Replacement>::handleBusReadX(uint64_t address, uint8_t* supply) {
+    noteSnoopInFlight(address);
+    SnoopResponse response;
+    AddressType addr(address);
     int way = findWay(addr.index, addr.tag);
     
     if (way != -1) {
-        CacheLine& line = cache_sets[addr.index].ways[way];
+        SetType& set = cache_sets[addr.index];
         
-        MESIResult result = mesi_controller->processEvent(
-            line.mesi_state, BusEvent::BUS_READX
+        MESIResult result = coherence->processEvent(
+            set.getMESI(way), BusEvent::BUS_READX
         );
         
-        // Si estamos en M, hacemos writeback primero
-        if (result.needs_writeback) {
-            writebackLine(addr.index, way);
-            std::cout << "[PE" << pe_id << "] Writeback due to BUS_READX (M->I), requester will fetch from memory" << std::endl;
+        response.present = true;
+        
+        // En M o E proveemos el dato antes de invalidar
+        if (result.supply_data && supply != nullptr) {
+            std::memcpy(supply, blockData(addr.index, way), BlockSize);
+            response.data_supplied = true;
+            stats.c2c_supplied++;
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Supplying data DIRECTLY via interconnect for addr=0x" 
+                  << std::hex << address << std::dec << " (" 
+                  << CoherenceController::getStateName(set.getMESI(way)) << "->I)");
         }
         
-        // Si estamos en E, proveemos el dato antes de invalidar
-        if (result.supply_data && bus_interface != nullptr) {
-            bus_interface->supplyData(address, line.data.data());
-            std::cout << "[PE" << pe_id << "] Supplying data DIRECTLY via interconnect for addr=0x" 
-                      << std::hex << address << std::dec << " (E->I)" << std::endl;
+        // Desde M el bloque sucio pasa al solicitante; sólo si nadie lo
+        // recogió hay que escribirlo a memoria
+        if (result.needs_writeback && !response.data_supplied) {
+            writebackLine(addr.index, way);
+            TRACE(CACHE, DETAIL, "[PE" << pe_id << "] Writeback due to BUS_READX (M->I)");
         }
         
         // Invalidar la línea
         if (result.needs_invalidate) {
-            line.valid = false;
-            line.mesi_state = MESIState::INVALID;
+            discardPrefetch(addr.index, way, address & ~AddressType::OFFSET_MASK);
+            set.setValid(way, false);
+            set.setDirty(way, false);
+            set.setMESI(way, MESIState::INVALID);
             stats.invalidations++;
+            if (sharing_profiler) {
+                sharing_profiler->noteInvalidation(pe_id, address);
+            }
+            if (miss_classifier) {
+                miss_classifier->noteInvalidation(address & ~AddressType::OFFSET_MASK);
+            }
         }
         
         stats.mesi_transitions++;
         
-        std::cout << "[PE" << pe_id << "] Invalidated line due to BUS_READX: addr=0x" 
-                  << std::hex << address << std::dec << std::endl;
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] Invalidated line due to BUS_READX: addr=0x" 
+              << std::hex << address << std::dec);
+    }
+    
+    if (prefetcher) {
+        prefetcher->invalidate(address & ~AddressType::OFFSET_MASK);
     }
+    return response;
 }
 
-void Cache::invalidateLine(uint64_t address) {
-    Address addr(address);
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::invalidateLine(uint64_t address) {
+    noteSnoopInFlight(address);
+    AddressType addr(address);
     int way = findWay(addr.index, addr.tag);
     
     if (way != -1) {
-        CacheLine& line = cache_sets[addr.index].ways[way];
-        line.valid = false;
-        line.mesi_state = MESIState::INVALID;
+        SetType& set = cache_sets[addr.index];
+        discardPrefetch(addr.index, way, address & ~AddressType::OFFSET_MASK);
+        set.setValid(way, false);
+        set.setMESI(way, MESIState::INVALID);
         stats.invalidations++;
+        if (sharing_profiler) {
+            sharing_profiler->noteInvalidation(pe_id, address);
+        }
+        if (miss_classifier) {
+            miss_classifier->noteInvalidation(address & ~AddressType::OFFSET_MASK);
+        }
         
-        std::cout << "[PE" << pe_id << "] Line invalidated: addr=0x" 
-                  << std::hex << address << std::dec << std::endl;
+        TRACE(CACHE, BASIC, "[PE" << pe_id << "] Line invalidated: addr=0x" 
+              << std::hex << address << std::dec);
+    }
+    
+    if (prefetcher) {
+        prefetcher->invalidate(address & ~AddressType::OFFSET_MASK);
+    }
+    return way != -1;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+bool Cache<Sets, Ways, BlockSize, Replacement>::backInvalidate(uint64_t address, uint8_t* dirty_data) {
+    AddressType addr(address);
+    int way = findWay(addr.index, addr.tag);
+    
+    if (prefetcher) {
+        prefetcher->invalidate(address & ~AddressType::OFFSET_MASK);
     }
+    if (way == -1) {
+        return false;
+    }
+    
+    SetType& set = cache_sets[addr.index];
+    discardPrefetch(addr.index, way, address & ~AddressType::OFFSET_MASK);
+    bool dirty = set.isDirty(way);
+    if (dirty && dirty_data != nullptr) {
+        std::memcpy(dirty_data, blockData(addr.index, way), BlockSize);
+    }
+    
+    set.setValid(way, false);
+    set.setDirty(way, false);
+    set.setMESI(way, MESIState::INVALID);
+    stats.back_invalidations++;
+    if (sharing_profiler) {
+        sharing_profiler->noteBackInvalidation(pe_id, address);
+    }
+    if (miss_classifier) {
+        miss_classifier->noteBackInvalidation(address & ~AddressType::OFFSET_MASK);
+    }
+    // El snoop filter/directorio deben saber que este PE ya no lo tiene
+    if (bus_interface != nullptr) {
+        bus_interface->notifyBackInvalidation(address & ~AddressType::OFFSET_MASK);
+    }
+    
+    TRACE(CACHE, BASIC, "[PE" << pe_id << "] Back-invalidation from L2: addr=0x" 
+          << std::hex << address << std::dec << (dirty ? " (dirty data returned)" : ""));
+    
+    return dirty;
 }
 
-void Cache::printStats() const {
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::printStats() const {
     std::cout << "\n=== Cache Statistics for PE" << pe_id << " ===" << std::endl;
     std::cout << "Read Hits: " << stats.read_hits << std::endl;
     std::cout << "Read Misses: " << stats.read_misses << std::endl;
@@ -363,7 +852,11 @@ void Cache::printStats() const {
     std::cout << "Write Misses: " << stats.write_misses << std::endl;
     std::cout << "Invalidations: " << stats.invalidations << std::endl;
     std::cout << "Writebacks: " << stats.writebacks << std::endl;
-    std::cout << "MESI Transitions: " << mesi_controller->getTransitionCount() << std::endl;
+    if (stats.back_invalidations > 0) {
+        std::cout << "Back-invalidations (L2): " << stats.back_invalidations << std::endl;
+    }
+    std::cout << coherenceProtocolName(coherence->protocol()) << " Transitions: " 
+              << coherence->getTransitionCount() << std::endl;
     
     uint64_t total_accesses = stats.read_hits + stats.read_misses + 
                                stats.write_hits + stats.write_misses;
@@ -373,31 +866,233 @@ void Cache::printStats() const {
         std::cout << "Hit Rate: " << std::fixed << std::setprecision(2) 
                   << hit_rate << "%" << std::endl;
     }
+    
+    if (stats.prefetch_issued > 0) {
+        uint64_t demand_misses = stats.read_misses + stats.write_misses;
+        uint64_t coverable = stats.prefetch_useful + demand_misses;
+        std::cout << "Prefetches (" << prefetcherKindName(prefetcher ? prefetcher->kind() : PrefetcherKind::NONE)
+                  << "): issued=" << stats.prefetch_issued
+                  << " useful=" << stats.prefetch_useful
+                  << " unused=" << stats.prefetch_unused << std::endl;
+        std::cout << "Prefetch Accuracy: " << std::fixed << std::setprecision(2)
+                  << 100.0 * stats.prefetch_useful / stats.prefetch_issued << "%"
+                  << "  Coverage: "
+                  << (coverable ? 100.0 * stats.prefetch_useful / coverable : 0.0) << "%";
+        if (stats.prefetch_useful > 0) {
+            std::cout << "  Avg lead: "
+                      << static_cast<double>(stats.prefetch_lead_accesses) / stats.prefetch_useful
+                      << " accesses";
+        }
+        std::cout << std::endl;
+    }
+    
+    if (stats.c2c_supplied > 0 || stats.c2c_received > 0 || stats.shared_fills > 0) {
+        std::cout << "Cache-to-cache: supplied=" << stats.c2c_supplied
+                  << " received=" << stats.c2c_received
+                  << " shared fills=" << stats.shared_fills << std::endl;
+    }
+    
+    if (miss_classifier) {
+        std::cout << "Miss Classification: compulsory=" << stats.miss_compulsory
+                  << " capacity=" << stats.miss_capacity
+                  << " conflict=" << stats.miss_conflict
+                  << " coherence=" << stats.miss_coherence
+                  << " inclusion=" << stats.miss_inclusion << std::endl;
+        miss_classifier->printSetBreakdown();
+    }
+    
+    if (reuse_profiler) {
+        reuse_profiler->printCurve(BlockSize);
+        std::cout << "Esta caché (" << Sets * Ways << " bloques, totalmente asociativa): "
+                  << std::fixed << std::setprecision(2)
+                  << 100.0 * reuse_profiler->predictedHitRate(Sets * Ways) << "%" << std::endl;
+    }
+    
+    if (stats.mshr_allocations > 0) {
+        std::cout << "MSHRs (" << mshrs->getConfig().entries << " x " 
+                  << mshrs->getConfig().targets_per_entry << " targets): allocations="
+                  << stats.mshr_allocations << " merges=" << stats.mshr_merges
+                  << " stalls=" << stats.mshr_stalls 
+                  << " peak=" << stats.mshr_peak_outstanding << std::endl;
+    }
 }
 
-void Cache::printCache() const {
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::printCache() const {
     std::cout << "\n=== Cache Contents for PE" << pe_id << " ===" << std::endl;
-    for (size_t set = 0; set < CACHE_SETS; set++) {
+    for (size_t set = 0; set < Sets; set++) {
         std::cout << "Set " << set << ":" << std::endl;
-        for (size_t way = 0; way < CACHE_WAYS; way++) {
-            const CacheLine& line = cache_sets[set].ways[way];
+        for (size_t way = 0; way < Ways; way++) {
+            const SetType& lines = cache_sets[set];
+            int w = static_cast<int>(way);
             std::cout << "  Way " << way << ": ";
-            if (line.valid) {
-                std::cout << "V=" << line.valid 
-                         << " D=" << line.dirty
-                         << " MESI=" << MESIController::getStateName(line.mesi_state)
-                         << " Tag=0x" << std::hex << line.tag << std::dec;
+            if (lines.isValid(w)) {
+                std::cout << "V=" << lines.isValid(w) 
+                         << " D=" << lines.isDirty(w)
+                         << " MESI=" << CoherenceController::getStateName(lines.getMESI(w))
+                         << " Tag=0x" << std::hex << lines.tags[w] << std::dec;
             } else {
                 std::cout << "INVALID";
             }
             std::cout << std::endl;
         }
-        std::cout << "  LRU victim would be: Way " << cache_sets[set].lru->findVictim() << std::endl;
+        std::cout << "  " << replacementKindName(PolicyType::KIND) << " victim would be: Way " 
+                  << cache_sets[set].replacement.peekVictim() << std::endl;
     }
 }
 
-void Cache::printLRUState(uint8_t index) const {
-    std::cout << "\n=== LRU State for Set " << static_cast<int>(index) << " ===" << std::endl;
-    cache_sets[index].lru->print();
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::printLRUState(size_t index) const {
+    std::cout << "\n=== Replacement State for Set " << static_cast<int>(index) << " ===" << std::endl;
+    cache_sets[index].replacement.print();
     std::cout << std::endl;
-}
\ No newline at end of file
+}
+
+// ============================================================
+// CHECKPOINT / CLONACIÓN
+// ============================================================
+// Sets, datos y estadísticas son trivialmente copiables, de modo que una
+// imagen completa de la caché se obtiene con tres memcpy sin asignaciones
+// por set. La cabecera va delante para rechazar imágenes ajenas.
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+std::vector<uint8_t> Cache<Sets, Ways, BlockSize, Replacement>::saveCheckpoint() const {
+    std::vector<uint8_t> image(CHECKPOINT_SIZE);
+    uint8_t* out = image.data();
+    CacheCheckpointHeader header;
+    header.sets = Sets;
+    header.ways = Ways;
+    header.block_size = BlockSize;
+    header.replacement = static_cast<uint32_t>(PolicyType::KIND);
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, &cache_sets, sizeof(cache_sets));
+    out += sizeof(cache_sets);
+    std::memcpy(out, &data_store, sizeof(data_store));
+    out += sizeof(data_store);
+    std::memcpy(out, &stats, sizeof(stats));
+    return image;
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+void Cache<Sets, Ways, BlockSize, Replacement>::restoreCheckpoint(const std::vector<uint8_t>& image) {
+    CacheCheckpointHeader header;
+    if (image.size() < sizeof(header)) {
+        throw std::invalid_argument("Checkpoint de caché incompatible: imagen de " +
+                                    std::to_string(image.size()) + " bytes sin cabecera");
+    }
+    std::memcpy(&header, image.data(), sizeof(header));
+    if (header.magic != CacheCheckpointHeader::MAGIC || header.version != CacheCheckpointHeader::VERSION) {
+        throw std::invalid_argument("Checkpoint de caché incompatible: formato o versión desconocidos");
+    }
+    if (header.sets != Sets || header.ways != Ways || header.block_size != BlockSize ||
+        header.replacement != static_cast<uint32_t>(PolicyType::KIND)) {
+        throw std::invalid_argument("Checkpoint de caché incompatible: imagen de " +
+                                    std::to_string(header.sets) + "x" + std::to_string(header.ways) + "x" +
+                                    std::to_string(header.block_size) + " " +
+                                    replacementKindName(static_cast<ReplacementKind>(header.replacement)) +
+                                    ", la caché es " + std::to_string(Sets) + "x" + std::to_string(Ways) +
+                                    "x" + std::to_string(BlockSize) + " " + replacementKindName(PolicyType::KIND));
+    }
+    if (image.size() != CHECKPOINT_SIZE) {
+        throw std::invalid_argument("Checkpoint de caché incompatible: " +
+                                    std::to_string(image.size()) + " bytes, se esperaban " +
+                                    std::to_string(CHECKPOINT_SIZE));
+    }
+    const uint8_t* in = image.data() + sizeof(header);
+    std::memcpy(&cache_sets, in, sizeof(cache_sets));
+    in += sizeof(cache_sets);
+    std::memcpy(&data_store, in, sizeof(data_store));
+    in += sizeof(data_store);
+    std::memcpy(&stats, in, sizeof(stats));
+}
+
+template <size_t Sets, size_t Ways, size_t BlockSize, template <size_t> class Replacement>
+std::unique_ptr<ICache> Cache<Sets, Ways, BlockSize, Replacement>::clone() const {
+    auto copy = std::make_unique<Cache>(pe_id);
+    copy->mshrs = std::make_unique<MSHRFile>(mshrs->getConfig());
+    copy->coherence = createCoherenceController(coherence->protocol(), pe_id);
+    std::memcpy(&copy->cache_sets, &cache_sets, sizeof(cache_sets));
+    std::memcpy(&copy->data_store, &data_store, sizeof(data_store));
+    copy->stats = stats;
+    return copy;
+}
+
+// ============================================================
+// GEOMETRÍAS PRE-INSTANCIADAS Y FÁBRICA
+// ============================================================
+
+template class Cache<8, 2, 32>;
+template class Cache<8, 4, 32>;
+template class Cache<16, 4, 32>;
+template class Cache<32, 4, 32>;
+template class Cache<64, 4, 32>;
+template class Cache<64, 4, 64>;
+template class Cache<64, 8, 32>;
+template class Cache<128, 8, 32>;
+template class Cache<256, 8, 32>;
+template class Cache<64, 16, 32>;
+template class Cache<16, 32, 32>;
+
+namespace {
+
+template <size_t Sets, size_t Ways, size_t BlockSize>
+std::unique_ptr<ICache> makeCache(int pe_id, ReplacementKind policy) {
+    switch (policy) {
+        case ReplacementKind::TREE_PLRU:
+            return std::make_unique<Cache<Sets, Ways, BlockSize, TreePLRUPolicy>>(pe_id);
+        case ReplacementKind::SRRIP:
+            return std::make_unique<Cache<Sets, Ways, BlockSize, SRRIPPolicy>>(pe_id);
+        case ReplacementKind::BRRIP:
+            return std::make_unique<Cache<Sets, Ways, BlockSize, BRRIPPolicy>>(pe_id);
+        case ReplacementKind::RANDOM:
+            return std::make_unique<Cache<Sets, Ways, BlockSize, RandomPolicy>>(pe_id);
+        case ReplacementKind::LRU:
+        default:
+            return std::make_unique<Cache<Sets, Ways, BlockSize, LRUPolicy>>(pe_id);
+    }
+}
+
+struct GeometryEntry {
+    CacheGeometry geometry;
+    std::unique_ptr<ICache> (*create)(int pe_id, ReplacementKind policy);
+};
+
+const GeometryEntry kGeometries[] = {
+    {{8, 2, 32},   &makeCache<8, 2, 32>},
+    {{8, 4, 32},   &makeCache<8, 4, 32>},
+    {{16, 4, 32},  &makeCache<16, 4, 32>},
+    {{32, 4, 32},  &makeCache<32, 4, 32>},
+    {{64, 4, 32},  &makeCache<64, 4, 32>},
+    {{64, 4, 64},  &makeCache<64, 4, 64>},
+    {{64, 8, 32},  &makeCache<64, 8, 32>},
+    {{128, 8, 32}, &makeCache<128, 8, 32>},
+    {{256, 8, 32}, &makeCache<256, 8, 32>},
+    {{64, 16, 32}, &makeCache<64, 16, 32>},
+    {{16, 32, 32}, &makeCache<16, 32, 32>},
+};
+
+} // namespace
+
+std::unique_ptr<ICache> createCache(int pe_id, const CacheGeometry& geometry,
+                                    ReplacementKind policy) {
+    for (const GeometryEntry& entry : kGeometries) {
+        if (entry.geometry.sets == geometry.sets &&
+            entry.geometry.ways == geometry.ways &&
+            entry.geometry.block_size == geometry.block_size) {
+            return entry.create(pe_id, policy);
+        }
+    }
+    throw std::invalid_argument("Geometría de caché no soportada: " +
+                                std::to_string(geometry.sets) + "x" +
+                                std::to_string(geometry.ways) + "x" +
+                                std::to_string(geometry.block_size));
+}
+
+std::vector<CacheGeometry> supportedCacheGeometries() {
+    std::vector<CacheGeometry> result;
+    for (const GeometryEntry& entry : kGeometries) {
+        result.push_back(entry.geometry);
+    }
+    return result;
+}
@@ -2,20 +2,35 @@
 #define CACHE_UPDATED_H
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 #include <memory>
-#include "lru_policy.hpp"
-#include "mesi_controller.hpp"
+#include <vector>
+#include <type_traits>
+#include "replacement_policy.hpp"
+#include "coherence_controller.hpp"
 #include "write_policy.hpp"
 #include "bus_interface.hpp"  // Solo la interfaz abstracta
+#include "tag_match.hpp"
+#include "prefetcher.hpp"
+#include "mshr.hpp"
+#include "sharing_profiler.hpp"
+#include "miss_classifier.hpp"
+#include "reuse_profiler.hpp"
 
-// Constantes de configuración
+// Geometría por defecto (configuración original: 8 sets x 2 ways x 32 bytes)
 constexpr size_t CACHE_BLOCK_SIZE = 32;
 constexpr size_t CACHE_WAYS = 2;
 constexpr size_t CACHE_SETS = 8;
-constexpr size_t OFFSET_BITS = 5;
-constexpr size_t INDEX_BITS = 3;
-constexpr size_t TAG_BITS = 52;
+
+// Utilidades constexpr para derivar máscaras y desplazamientos
+constexpr bool isPowerOfTwo(size_t n) {
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+constexpr size_t log2Exact(size_t n) {
+    return n <= 1 ? 0 : 1 + log2Exact(n / 2);
+}
 
 // Mensaje para el bus
 struct BusMessage {
@@ -24,52 +39,103 @@ struct BusMessage {
     int sender_pe_id;
 };
 
-// Estructura de una línea de caché
-struct CacheLine {
-    bool valid;
-    bool dirty;
-    MESIState mesi_state;
-    uint64_t tag;
-    std::array<uint8_t, CACHE_BLOCK_SIZE> data;
-    
-    CacheLine() : valid(false), dirty(false), 
-                  mesi_state(MESIState::INVALID), tag(0) {
-        data.fill(0);
-    }
-};
+// Estado empaquetado de una línea (metadatos fuera del bloque de datos):
+// bit 0 = dirty, bits 1-3 = estado MESI, bit 4 = traída por prefetch y aún
+// sin uso de demanda. La validez vive en CacheSet::valid_mask.
+namespace LineState {
+    constexpr uint8_t DIRTY = 0x01;
+    constexpr uint8_t MESI_SHIFT = 1;
+    constexpr uint8_t MESI_MASK = 0x0E;
+    constexpr uint8_t PREFETCHED = 0x10;
+}
 
-// Estructura de un conjunto con su propia política LRU
+// Conjunto en formato structure-of-arrays: tags y estado contiguos para
+// que findWay no toque los bytes de datos (que viven en Cache::data_store).
+// Policy es la política de reemplazo del set (ver replacement_policy.hpp);
+// su estado se guarda en línea, por lo que el set es trivialmente copiable.
+template <size_t Ways, typename Policy>
 struct CacheSet {
-    std::array<CacheLine, CACHE_WAYS> ways;
-    std::unique_ptr<LRUPolicy> lru;
-    
-    CacheSet() : lru(std::make_unique<LRUPolicy>(CACHE_WAYS)) {}
-    
-    CacheSet(const CacheSet& other) 
-        : ways(other.ways),
-          lru(std::make_unique<LRUPolicy>(CACHE_WAYS)) {
-        *lru = *(other.lru);
+    static_assert(Ways >= 1 && Ways <= 32, "valid_mask soporta hasta 32 ways");
+
+    static constexpr uint32_t ALL_WAYS = (Ways == 32) ? 0xFFFFFFFFu : ((1u << Ways) - 1);
+
+    alignas(32) std::array<uint64_t, Ways> tags;
+    std::array<uint8_t, Ways> state;
+    uint32_t valid_mask;
+    Policy replacement;
+
+    CacheSet() : valid_mask(0) {
+        tags.fill(0);
+        state.fill(0);
     }
-    
-    CacheSet& operator=(const CacheSet& other) {
-        if (this != &other) {
-            ways = other.ways;
-            lru = std::make_unique<LRUPolicy>(CACHE_WAYS);
-            *lru = *(other.lru);
+
+    // Accesores sobre el estado empaquetado
+    bool isValid(int way) const { return (valid_mask >> way) & 1u; }
+    bool isDirty(int way) const { return (state[way] & LineState::DIRTY) != 0; }
+    bool isPrefetched(int way) const { return (state[way] & LineState::PREFETCHED) != 0; }
+    MESIState getMESI(int way) const {
+        return static_cast<MESIState>((state[way] & LineState::MESI_MASK) >> LineState::MESI_SHIFT);
+    }
+
+    void setValid(int way, bool valid) {
+        if (valid) {
+            valid_mask |= (1u << way);
+        } else {
+            valid_mask &= ~(1u << way);
         }
-        return *this;
+    }
+    void setDirty(int way, bool dirty) {
+        state[way] = dirty ? (state[way] | LineState::DIRTY)
+                           : (state[way] & ~LineState::DIRTY);
+    }
+    void setPrefetched(int way, bool prefetched) {
+        state[way] = prefetched ? (state[way] | LineState::PREFETCHED)
+                                : (state[way] & ~LineState::PREFETCHED);
+    }
+    void setMESI(int way, MESIState mesi) {
+        state[way] = static_cast<uint8_t>((state[way] & ~LineState::MESI_MASK) |
+                     (static_cast<uint8_t>(mesi) << LineState::MESI_SHIFT));
+    }
+
+    // Comparación de todos los ways con una sola operación SIMD
+    int findWay(uint64_t tag) const {
+        uint32_t hits = matchTags<Ways>(tags.data(), tag) & valid_mask;
+        return hits ? countTrailingZeros(hits) : -1;
+    }
+
+    // Primer way libre, o -1 si el set está lleno
+    int findInvalidWay() const {
+        uint32_t free_ways = ~valid_mask & ALL_WAYS;
+        return free_ways ? countTrailingZeros(free_ways) : -1;
     }
 };
 
+// Descomposición de una dirección; máscaras y desplazamientos se
+// calculan en tiempo de compilación a partir de la geometría
+template <size_t Sets, size_t BlockSize>
 struct Address {
+    static_assert(isPowerOfTwo(Sets), "Sets debe ser potencia de 2");
+    static_assert(isPowerOfTwo(BlockSize), "BlockSize debe ser potencia de 2");
+
+    static constexpr size_t OFFSET_BITS = log2Exact(BlockSize);
+    static constexpr size_t INDEX_BITS = log2Exact(Sets);
+    static constexpr size_t TAG_SHIFT = OFFSET_BITS + INDEX_BITS;
+    static constexpr uint64_t OFFSET_MASK = BlockSize - 1;
+    static constexpr uint64_t INDEX_MASK = Sets - 1;
+
     uint64_t tag;
-    uint8_t index;
-    uint8_t offset;
-    
+    uint32_t index;
+    uint32_t offset;
+
     Address(uint64_t addr) {
-        offset = addr & 0x1F;
-        index = (addr >> OFFSET_BITS) & 0x7;
-        tag = addr >> (OFFSET_BITS + INDEX_BITS);
+        offset = static_cast<uint32_t>(addr & OFFSET_MASK);
+        index = static_cast<uint32_t>((addr >> OFFSET_BITS) & INDEX_MASK);
+        tag = addr >> TAG_SHIFT;
+    }
+
+    // Reconstruye la dirección base del bloque a partir de tag e índice
+    static constexpr uint64_t blockAddress(uint64_t tag, uint32_t index) {
+        return (tag << TAG_SHIFT) | (static_cast<uint64_t>(index) << OFFSET_BITS);
     }
 };
 
@@ -81,52 +147,293 @@ struct CacheStats {
     uint64_t invalidations = 0;
     uint64_t writebacks = 0;
     uint64_t mesi_transitions = 0;
-    
+    uint64_t back_invalidations = 0;  // Invalidaciones forzadas por una L2 inclusiva
+
+    // Prefetch. Precisión = useful / issued; cobertura = useful / (useful +
+    // misses de demanda); puntualidad = lead_accesses / useful (accesos
+    // de la caché entre la emisión del prefetch y su primer uso).
+    uint64_t prefetch_issued = 0;
+    uint64_t prefetch_useful = 0;
+    uint64_t prefetch_unused = 0;        // Desalojados o descartados sin uso
+    uint64_t prefetch_lead_accesses = 0;
+
+    // MSHRs (sólo accesos no bloqueantes). Los misses fusionados se
+    // completan como hits al reproducirse sobre el bloque ya instalado.
+    uint64_t mshr_allocations = 0;       // Misses primarios
+    uint64_t mshr_merges = 0;            // Misses secundarios al mismo bloque
+    uint64_t mshr_stalls = 0;            // Rechazos por MSHRs o targets llenos
+    uint64_t mshr_peak_outstanding = 0;
+
+    // Transferencias cache-to-cache (snoop con dato desde M/E)
+    uint64_t c2c_supplied = 0;           // Bloques entregados a otra caché
+    uint64_t c2c_received = 0;           // Fills servidos por otra caché en lugar de memoria
+    uint64_t shared_fills = 0;           // Fills de lectura instalados en S (o F)
+    uint64_t memory_fills = 0;           // Bloques leídos del nivel inferior
+
+    // Clasificación de misses de demanda (sólo con el clasificador activo)
+    uint64_t miss_compulsory = 0;
+    uint64_t miss_capacity = 0;
+    uint64_t miss_conflict = 0;
+    uint64_t miss_coherence = 0;
+    uint64_t miss_inclusion = 0;         // Víctimas de back-invalidations de la L2
+
     void reset() {
         read_hits = read_misses = write_hits = write_misses = 0;
         invalidations = writebacks = mesi_transitions = 0;
+        back_invalidations = 0;
+        prefetch_issued = prefetch_useful = prefetch_unused = prefetch_lead_accesses = 0;
+        mshr_allocations = mshr_merges = mshr_stalls = mshr_peak_outstanding = 0;
+        c2c_supplied = c2c_received = shared_fills = memory_fills = 0;
+        miss_compulsory = miss_capacity = miss_conflict = miss_coherence = miss_inclusion = 0;
     }
 };
 
-class Cache {
+// Geometría seleccionable en tiempo de ejecución
+struct CacheGeometry {
+    size_t sets;
+    size_t ways;
+    size_t block_size;
+
+    size_t capacity() const { return sets * ways * block_size; }
+};
+
+// Cabecera de un checkpoint: geometría y política que lo produjeron. El
+// estado de reemplazo sólo se puede interpretar con la misma política.
+struct CacheCheckpointHeader {
+    static constexpr uint32_t MAGIC = 0x4B484343;  // "CCHK"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint64_t sets = 0;
+    uint64_t ways = 0;
+    uint64_t block_size = 0;
+    uint32_t replacement = 0;  // ReplacementKind
+    uint32_t reserved = 0;
+};
+
+// Interfaz común a todas las geometrías; la usan Interconnect, BusController y los PEs
+class ICache {
+public:
+    virtual ~ICache() = default;
+
+    // Operaciones principales
+    virtual bool read(uint64_t address, uint64_t& data) = 0;
+    virtual bool write(uint64_t address, uint64_t data) = 0;
+
+    // Acceso no bloqueante: un hit se completa en el acto (incluso con misses
+    // en vuelo); un miss ocupa o se fusiona en un MSHR y su callback llega
+    // desde tick() cuando el bloque se instala
+    virtual AccessStatus readAsync(uint64_t address, CacheCallback callback) = 0;
+    virtual AccessStatus writeAsync(uint64_t address, uint64_t data, CacheCallback callback) = 0;
+    virtual void tick() = 0;
+    // tick() en dos partes: advanceMisses() cuenta la latencia y recoge las
+    // respuestas del interconnect sin tocar otras cachés, y devuelve true si
+    // algún miss puede completarse; completeMisses() los instala (desalojos,
+    // snoops de un fill repetido) y llama a sus callbacks.
+    virtual bool advanceMisses() = 0;
+    virtual void completeMisses() = 0;
+    virtual size_t outstandingMisses() const = 0;
+    // true si el acceso es un hit que no sale de esta caché: sin bus, sin
+    // MSHR en vuelo para el bloque y sin estado compartido con otras
+    // (prefetcher, perfil de compartición). Se puede servir sin bloquear a
+    // los demás PEs, sólo excluyendo los snoops sobre esta caché.
+    virtual bool hitsLocally(uint64_t address, bool is_write) const = 0;
+    // Lanza std::logic_error si hay misses en vuelo
+    virtual void setMSHRConfig(const MSHRConfig& config) = 0;
+
+    // Protocolo de coherencia (MESI por defecto). Lanza std::logic_error si
+    // la caché ya tiene líneas válidas: sus estados serían de otro protocolo.
+    virtual void setCoherenceProtocol(CoherenceProtocol protocol) = 0;
+    virtual CoherenceProtocol getCoherenceProtocol() const = 0;
+
+    // Protocolo MESI - Reacciones a mensajes del bus. Si la línea está en
+    // M/E y `supply` no es nulo, el bloque se copia ahí (cache-to-cache)
+    virtual SnoopResponse handleBusRead(uint64_t address, uint8_t* supply = nullptr) = 0;
+    virtual SnoopResponse handleBusReadX(uint64_t address, uint8_t* supply = nullptr) = 0;
+    // Devuelve true si la línea estaba presente
+    virtual bool invalidateLine(uint64_t address) = 0;
+
+    // Back-invalidation desde una L2 inclusiva: invalida la línea si está
+    // presente. Devuelve true si estaba sucia y copia el bloque en dirty_data.
+    virtual bool backInvalidate(uint64_t address, uint8_t* dirty_data) = 0;
+
+    // Configuración de bus (opcional)
+    virtual void setBusInterface(IBusInterface* bus) = 0;
+    
+    // Prefetcher (opcional; nullptr lo desactiva)
+    virtual void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher) = 0;
+
+    // Perfil de compartición común a todas las L1 (opcional; la caché no
+    // se adueña del perfil)
+    virtual void setSharingProfiler(SharingProfiler* profiler) = 0;
+
+    // Clasificación compulsory/capacity/conflict/coherence de cada miss con
+    // una caché sombra totalmente asociativa (desactivada por defecto)
+    virtual void setMissClassification(bool enabled) = 0;
+    virtual const MissClassifier* getMissClassifier() const = 0;
+
+    // Perfil de distancia de reúso de los accesos de demanda (desactivado
+    // por defecto); predice la tasa de aciertos para cualquier capacidad
+    virtual void setReuseProfiling(bool enabled) = 0;
+    virtual const ReuseDistanceProfiler* getReuseProfiler() const = 0;
+
+    // Utilidades
+    virtual int getPEId() const = 0;
+    virtual CacheGeometry getGeometry() const = 0;
+    virtual ReplacementKind getReplacementKind() const = 0;
+    virtual CacheStats getStats() const = 0;
+    virtual void printCache() const = 0;
+    virtual void printStats() const = 0;
+    virtual void printLRUState(size_t index) const = 0;
+    virtual void printTransitionMatrix() const = 0;
+
+    // Checkpoint binario del contenido (tags, estado, reemplazo, datos y
+    // estadísticas). restoreCheckpoint lanza std::invalid_argument si la
+    // imagen no corresponde a la misma geometría y política. Los misses en
+    // vuelo (MSHRs) no forman parte de la imagen.
+    virtual std::vector<uint8_t> saveCheckpoint() const = 0;
+    virtual void restoreCheckpoint(const std::vector<uint8_t>& image) = 0;
+
+    // Copia independiente del contenido, sin bus conectado
+    virtual std::unique_ptr<ICache> clone() const = 0;
+};
+
+template <size_t Sets = CACHE_SETS, size_t Ways = CACHE_WAYS, size_t BlockSize = CACHE_BLOCK_SIZE,
+          template <size_t> class Replacement = LRUPolicy>
+class Cache : public ICache {
+public:
+    using AddressType = Address<Sets, BlockSize>;
+    using PolicyType = Replacement<Ways>;
+    using SetType = CacheSet<Ways, PolicyType>;
+    using BlockType = std::array<uint8_t, BlockSize>;
+
+    static_assert(Ways >= 1 && Ways <= MAX_WAYS, "Ways fuera del rango soportado");
+    static_assert(isPowerOfTwo(Ways), "Ways debe ser potencia de 2");
+    static_assert(BlockSize >= sizeof(uint64_t), "El bloque debe contener al menos una palabra");
+    static_assert(std::is_trivially_copyable<SetType>::value,
+                  "CacheSet debe ser trivialmente copiable para clonarse con memcpy");
+
 private:
     int pe_id;
-    std::array<CacheSet, CACHE_SETS> cache_sets;
+    std::array<SetType, Sets> cache_sets;
+    std::array<BlockType, Sets * Ways> data_store;  // Datos separados de los metadatos
     CacheStats stats;
-    
+
     // Componentes modulares
-    std::unique_ptr<MESIController> mesi_controller;
+    std::unique_ptr<CoherenceController> coherence;
     std::unique_ptr<WritePolicy> write_policy;
-    
+
     // Interfaz de bus (puede ser nullptr para pruebas standalone)
     IBusInterface* bus_interface;
     
+    // Prefetcher opcional y su lista de candidatos reutilizada entre accesos
+    std::unique_ptr<Prefetcher> prefetcher;
+    std::vector<uint64_t> prefetch_candidates;
+    uint64_t access_count;
+    
+    // Misses en vuelo de los accesos no bloqueantes
+    std::unique_ptr<MSHRFile> mshrs;
+    // Entrada cuyo fill instala el próximo miss (sólo durante tick())
+    MSHREntry* staged_fill;
+    
+    // Perfil de compartición compartido (puede ser nullptr)
+    SharingProfiler* sharing_profiler;
+    
+    // Clasificador de misses opcional
+    std::unique_ptr<MissClassifier> miss_classifier;
+    std::unique_ptr<ReuseDistanceProfiler> reuse_profiler;
+
     // Métodos auxiliares
-    int findWay(uint8_t index, uint64_t tag);
-    int selectVictim(uint8_t index);
-    void writebackLine(uint8_t index, int way);
+    uint8_t* blockData(uint32_t index, int way) { return data_store[index * Ways + way].data(); }
+    int findWay(uint32_t index, uint64_t tag);
+    int selectVictim(uint32_t index);
+    void writebackLine(uint32_t index, int way);
+    void evictLine(uint32_t index, int way);
+    void consumePrefetch(uint32_t index, int way, uint64_t block_address);
+    void discardPrefetch(uint32_t index, int way, uint64_t block_address);
+    void runPrefetcher(uint64_t block_address, bool trigger);
+    void issuePrefetch(uint64_t block_address);
+    void classifyMiss(uint32_t index, uint64_t block_address);
+    AccessStatus queueMiss(bool is_write, uint64_t address, uint64_t data, CacheCallback callback);
+    void issueFill(MSHREntry& entry, bool is_write, uint64_t address);
+    void noteSnoopInFlight(uint64_t address);
     bool fetchBlock(uint64_t address, uint8_t* data);
-    
+    SnoopResponse requestBlock(BusEvent event, uint64_t address, uint8_t* data);
+    SnoopResponse fillBlock(BusEvent event, uint64_t address, uint8_t* data);
+
 public:
     Cache(int pe_id);
-    
+
     // Operaciones principales
-    bool read(uint64_t address, uint64_t& data);
-    bool write(uint64_t address, uint64_t data);
+    bool read(uint64_t address, uint64_t& data) override;
+    bool write(uint64_t address, uint64_t data) override;
     
+    AccessStatus readAsync(uint64_t address, CacheCallback callback) override;
+    AccessStatus writeAsync(uint64_t address, uint64_t data, CacheCallback callback) override;
+    void tick() override;
+    bool advanceMisses() override;
+    void completeMisses() override;
+    size_t outstandingMisses() const override { return mshrs->outstanding(); }
+    bool hitsLocally(uint64_t address, bool is_write) const override;
+    void setMSHRConfig(const MSHRConfig& config) override;
+    void setCoherenceProtocol(CoherenceProtocol protocol) override;
+    CoherenceProtocol getCoherenceProtocol() const override { return coherence->protocol(); }
+
     // Protocolo MESI - Reacciones a mensajes del bus
-    void handleBusRead(uint64_t address);
-    void handleBusReadX(uint64_t address);
-    void invalidateLine(uint64_t address);
-    
+    SnoopResponse handleBusRead(uint64_t address, uint8_t* supply = nullptr) override;
+    SnoopResponse handleBusReadX(uint64_t address, uint8_t* supply = nullptr) override;
+    bool invalidateLine(uint64_t address) override;
+    bool backInvalidate(uint64_t address, uint8_t* dirty_data) override;
+
     // Configuración de bus (opcional)
-    void setBusInterface(IBusInterface* bus) { bus_interface = bus; }
-    
+    void setBusInterface(IBusInterface* bus) override { bus_interface = bus; }
+    void setPrefetcher(std::unique_ptr<Prefetcher> p) override { prefetcher = std::move(p); }
+    void setSharingProfiler(SharingProfiler* profiler) override { sharing_profiler = profiler; }
+    void setMissClassification(bool enabled) override;
+    const MissClassifier* getMissClassifier() const override { return miss_classifier.get(); }
+    void setReuseProfiling(bool enabled) override {
+        reuse_profiler = enabled ? std::make_unique<ReuseDistanceProfiler>() : nullptr;
+    }
+    const ReuseDistanceProfiler* getReuseProfiler() const override { return reuse_profiler.get(); }
+
     // Utilidades
-    CacheStats getStats() const { return stats; }
-    void printCache() const;
-    void printStats() const;
-    void printLRUState(uint8_t index) const;
+    int getPEId() const override { return pe_id; }
+    CacheGeometry getGeometry() const override { return {Sets, Ways, BlockSize}; }
+    ReplacementKind getReplacementKind() const override { return PolicyType::KIND; }
+    CacheStats getStats() const override { return stats; }
+    void printCache() const override;
+    void printStats() const override;
+    void printLRUState(size_t index) const override;
+    void printTransitionMatrix() const override { coherence->printTransitionMatrix(); }
+
+    static constexpr size_t CHECKPOINT_SIZE = sizeof(CacheCheckpointHeader) +
+        sizeof(std::array<SetType, Sets>) + sizeof(std::array<BlockType, Sets * Ways>) + sizeof(CacheStats);
+
+    std::vector<uint8_t> saveCheckpoint() const override;
+    void restoreCheckpoint(const std::vector<uint8_t>& image) override;
+    std::unique_ptr<ICache> clone() const override;
 };
 
-#endif // CACHE_UPDATED_H
\ No newline at end of file
+// Geometrías pre-instanciadas en cache.cpp
+extern template class Cache<8, 2, 32>;
+extern template class Cache<8, 4, 32>;
+extern template class Cache<16, 4, 32>;
+extern template class Cache<32, 4, 32>;
+extern template class Cache<64, 4, 32>;
+extern template class Cache<64, 4, 64>;
+extern template class Cache<64, 8, 32>;
+extern template class Cache<128, 8, 32>;
+extern template class Cache<256, 8, 32>;
+extern template class Cache<64, 16, 32>;
+extern template class Cache<16, 32, 32>;
+
+// Fábrica: crea la instancia pre-compilada que corresponde a la geometría
+// y a la política de reemplazo. Lanza std::invalid_argument si la
+// geometría no está instanciada.
+std::unique_ptr<ICache> createCache(int pe_id, const CacheGeometry& geometry =
+                                    {CACHE_SETS, CACHE_WAYS, CACHE_BLOCK_SIZE},
+                                    ReplacementKind policy = ReplacementKind::LRU);
+std::vector<CacheGeometry> supportedCacheGeometries();
+
+#endif // CACHE_UPDATED_H
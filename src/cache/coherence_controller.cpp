@@ -0,0 +1,82 @@
+#include "coherence_controller.hpp"
+#include "mesi_controller.hpp"
+#include <iomanip>
+#include <iostream>
+
+const char* coherenceProtocolName(CoherenceProtocol protocol) {
+    switch (protocol) {
+        case CoherenceProtocol::MESI:  return "MESI";
+        case CoherenceProtocol::MOESI: return "MOESI";
+        case CoherenceProtocol::MESIF: return "MESIF";
+        default: return "?";
+    }
+}
+
+bool parseCoherenceProtocol(const std::string& text, CoherenceProtocol& protocol) {
+    if (text == "mesi")       protocol = CoherenceProtocol::MESI;
+    else if (text == "moesi") protocol = CoherenceProtocol::MOESI;
+    else if (text == "mesif") protocol = CoherenceProtocol::MESIF;
+    else return false;
+    return true;
+}
+
+const char* CoherenceController::getStateName(MESIState state) {
+    switch (state) {
+        case MESIState::INVALID:   return "I";
+        case MESIState::SHARED:    return "S";
+        case MESIState::EXCLUSIVE: return "E";
+        case MESIState::MODIFIED:  return "M";
+        case MESIState::OWNED:     return "O";
+        case MESIState::FORWARD:   return "F";
+        default: return "?";
+    }
+}
+
+const char* CoherenceController::getEventName(BusEvent event) {
+    switch (event) {
+        case BusEvent::LOCAL_READ:   return "LocalRead";
+        case BusEvent::LOCAL_WRITE:  return "LocalWrite";
+        case BusEvent::BUS_READ:     return "BusRead";
+        case BusEvent::BUS_READX:    return "BusReadX";
+        case BusEvent::BUS_UPGRADE:  return "BusUpgrade";
+        case BusEvent::EVICTION:     return "Eviction";
+        default: return "?";
+    }
+}
+
+void CoherenceController::printTransitionMatrix() const {
+    std::cout << "\n=== " << coherenceProtocolName(table.protocol) 
+              << " Transition Matrix for PE" << pe_id << " (hits->estado) ===" << std::endl;
+    std::cout << std::setw(4) << "";
+    for (size_t event = 0; event < NUM_BUS_EVENTS; event++) {
+        std::cout << std::setw(13) << getEventName(static_cast<BusEvent>(event));
+    }
+    std::cout << std::endl;
+    
+    for (size_t state = 0; state < NUM_COHERENCE_STATES; state++) {
+        if ((table.state_mask & (1u << state)) == 0) {
+            continue;
+        }
+        std::cout << std::setw(4) << getStateName(static_cast<MESIState>(state));
+        for (size_t event = 0; event < NUM_BUS_EVENTS; event++) {
+            const TransitionEntry& entry = table.entries[state][event];
+            uint64_t hits = transition_hits[entry.id];
+            std::string cell = hits == 0 ? "-" 
+                : std::to_string(hits) + "->" + getStateName(entry.result.new_state);
+            std::cout << std::setw(13) << cell;
+        }
+        std::cout << std::endl;
+    }
+}
+
+std::unique_ptr<CoherenceController> createCoherenceController(CoherenceProtocol protocol, int pe_id) {
+    switch (protocol) {
+        case CoherenceProtocol::MOESI:
+            return std::make_unique<MOESIController>(pe_id);
+        case CoherenceProtocol::MESIF:
+            return std::make_unique<MESIFController>(pe_id);
+        case CoherenceProtocol::MESI:
+        default:
+            return std::make_unique<MESIController>(pe_id);
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef COHERENCE_CONTROLLER_H
+#define COHERENCE_CONTROLLER_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../Trace/Trace.hpp"
+
+// Estados de coherencia. MESI usa los cuatro primeros; OWNED sólo aparece
+// con MOESI y FORWARD sólo con MESIF. Caben en los 3 bits de LineState.
+enum class MESIState : uint8_t {
+    INVALID = 0,    // I
+    SHARED = 1,     // S
+    EXCLUSIVE = 2,  // E
+    MODIFIED = 3,   // M
+    OWNED = 4,      // O: sucio y compartido, responde a los BusRd
+    FORWARD = 5     // F: limpio y compartido, único que responde a los BusRd
+};
+
+// Eventos del bus
+enum class BusEvent {
+    LOCAL_READ,      // Lectura local
+    LOCAL_WRITE,     // Escritura local
+    BUS_READ,        // Otro PE quiere leer (caché miss de lectura)
+    BUS_READX,       // Otro PE quiere escribir (caché miss de escritura)
+    BUS_UPGRADE,     // Upgrade de S a M
+    EVICTION         // Desalojo de línea
+};
+
+constexpr size_t NUM_COHERENCE_STATES = 6;
+constexpr size_t NUM_BUS_EVENTS = 6;
+
+// Resultado de una transición MESI
+struct MESIResult {
+    MESIState new_state;
+    bool needs_bus_message;      // ¿Necesita enviar mensaje al bus?
+    bool needs_writeback;        // ¿Necesita hacer writeback a memoria?
+    bool needs_invalidate;       // ¿Necesita invalidar la línea?
+    bool supply_data;            // ¿Debe proveer el dato directamente por interconnect?
+    bool fetch_from_memory;      // ¿Debe buscar el dato en memoria?
+
+    constexpr MESIResult() : new_state(MESIState::INVALID),
+                             needs_bus_message(false),
+                             needs_writeback(false),
+                             needs_invalidate(false),
+                             supply_data(false),
+                             fetch_from_memory(false) {}
+};
+
+// Protocolos disponibles (uno por corrida, común a todas las cachés)
+enum class CoherenceProtocol {
+    MESI,
+    MOESI,   // Owned: el dueño sucio responde a los BusRd sin writeback
+    MESIF    // Forward: un único sharer limpio responde a los BusRd
+};
+
+const char* coherenceProtocolName(CoherenceProtocol protocol);
+// Acepta "mesi", "moesi", "mesif"
+bool parseCoherenceProtocol(const std::string& text, CoherenceProtocol& protocol);
+
+// Celda (estado, evento) de la tabla de un protocolo. id = estado *
+// NUM_BUS_EVENTS + evento indexa la matriz de conteo.
+struct TransitionEntry {
+    MESIResult result;
+    uint8_t id = 0;
+};
+
+// Tabla completa de un protocolo, construida en tiempo de compilación
+struct TransitionTable {
+    CoherenceProtocol protocol = CoherenceProtocol::MESI;
+    uint8_t state_mask = 0;                         // Bit i: el protocolo usa el estado i
+    MESIState shared_fill = MESIState::SHARED;      // Estado de un miss de lectura con sharers
+    TransitionEntry entries[NUM_COHERENCE_STATES][NUM_BUS_EVENTS] = {};
+
+    constexpr const TransitionEntry& at(MESIState state, BusEvent event) const {
+        return entries[static_cast<size_t>(state)][static_cast<size_t>(event)];
+    }
+};
+
+// ------------------------------------------------------------
+// Controlador de coherencia: cada protocolo sólo aporta su tabla
+// (ver mesi_controller.hpp). processEvent es una carga de la tabla más
+// el conteo en la matriz estado x evento.
+// ------------------------------------------------------------
+class CoherenceController {
+public:
+    CoherenceController(const TransitionTable& table, int pe_id)
+        : table(table), pe_id(pe_id), transition_count(0), transition_hits{} {}
+    virtual ~CoherenceController() = default;
+
+    CoherenceProtocol protocol() const { return table.protocol; }
+
+    // Procesar evento y retornar acciones necesarias
+    const MESIResult& processEvent(MESIState current_state, BusEvent event) {
+        const TransitionEntry& entry = table.at(current_state, event);
+        transition_hits[entry.id]++;
+        if (entry.result.new_state != current_state) {
+            transition_count++;
+            TRACE(MESI, BASIC, "[PE" << pe_id << "] " << coherenceProtocolName(table.protocol) << ": " 
+                  << getStateName(current_state) << " -> " 
+                  << getStateName(entry.result.new_state) 
+                  << " (Event: " << getEventName(event) << ")");
+        }
+        return entry.result;
+    }
+
+    // Estado final de un miss de lectura (I -> S/E/F) según la señal shared del snoop
+    MESIState resolveReadFill(bool shared) const {
+        return shared ? table.shared_fill : MESIState::EXCLUSIVE;
+    }
+
+    // Obtener nombre del estado
+    static const char* getStateName(MESIState state);
+    static const char* getEventName(BusEvent event);
+
+    // Estadísticas
+    uint64_t getTransitionCount() const { return transition_count; }
+    uint64_t getTransitionHits(MESIState state, BusEvent event) const {
+        return transition_hits[table.at(state, event).id];
+    }
+    void resetStats() {
+        transition_count = 0;
+        transition_hits.fill(0);
+    }
+
+    // Matriz estado x evento: veces que se usó cada celda y estado destino
+    void printTransitionMatrix() const;
+
+protected:
+    const TransitionTable& table;
+    int pe_id;
+    uint64_t transition_count;
+    std::array<uint64_t, NUM_COHERENCE_STATES * NUM_BUS_EVENTS> transition_hits;
+};
+
+std::unique_ptr<CoherenceController> createCoherenceController(CoherenceProtocol protocol, int pe_id);
+
+#endif // COHERENCE_CONTROLLER_H
@@ -0,0 +1,350 @@
+#include "l2_cache.hpp"
+#include "../Trace/Trace.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <stdexcept>
+
+const char* inclusionPolicyName(InclusionPolicy policy) {
+    switch (policy) {
+        case InclusionPolicy::INCLUSIVE:     return "inclusive";
+        case InclusionPolicy::NON_INCLUSIVE: return "non-inclusive";
+        case InclusionPolicy::EXCLUSIVE:     return "exclusive";
+        default: return "?";
+    }
+}
+
+// Acepta "inclusive", "noninclusive" (o "nine") y "exclusive"
+bool parseInclusionPolicy(const std::string& text, InclusionPolicy& policy) {
+    if (text == "inclusive")                            policy = InclusionPolicy::INCLUSIVE;
+    else if (text == "noninclusive" || text == "nine")  policy = InclusionPolicy::NON_INCLUSIVE;
+    else if (text == "exclusive")                       policy = InclusionPolicy::EXCLUSIVE;
+    else return false;
+    return true;
+}
+
+SharedL2Cache::SharedL2Cache(const L2Config& config, std::shared_ptr<RAM> ram)
+    : config_(config), ram_(ram), access_clock_(0),
+      memory_reads_(0), memory_writes_(0), total_latency_(0) {
+    if (!isPowerOfTwo(config_.sets) || !isPowerOfTwo(config_.block_size) ||
+        config_.ways == 0 || config_.banks == 0 || config_.block_size < sizeof(uint64_t)) {
+        throw std::invalid_argument("Configuración de L2 inválida: " +
+                                    std::to_string(config_.sets) + "x" +
+                                    std::to_string(config_.ways) + "x" +
+                                    std::to_string(config_.block_size) + ", " +
+                                    std::to_string(config_.banks) + " bancos");
+    }
+    offset_bits_ = log2Exact(config_.block_size);
+    index_bits_ = log2Exact(config_.sets);
+    lines_.resize(config_.sets * config_.ways);
+    data_.assign(config_.sets * config_.ways * config_.block_size, 0);
+    bank_accesses_.assign(config_.banks, 0);
+}
+
+void SharedL2Cache::registerL1(ICache* cache) {
+    // Los fills y writebacks mueven bloques completos: la L1 debe usar el
+    // mismo tamaño de bloque. Se rechaza aquí y no en el primer acceso.
+    size_t l1_block = cache->getGeometry().block_size;
+    if (l1_block != config_.block_size) {
+        throw std::invalid_argument("L2: el bloque de L1 (" + std::to_string(l1_block) +
+                                    " bytes) no coincide con el de L2 (" +
+                                    std::to_string(config_.block_size) + " bytes)");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    l1_caches_.push_back(cache);
+}
+
+// ============================================================
+// UTILIDADES
+// ============================================================
+
+uint64_t SharedL2Cache::blockAddress(uint64_t address) const {
+    return address & ~static_cast<uint64_t>(config_.block_size - 1);
+}
+
+size_t SharedL2Cache::setIndex(uint64_t block_address) const {
+    return static_cast<size_t>((block_address >> offset_bits_) & (config_.sets - 1));
+}
+
+uint64_t SharedL2Cache::tagOf(uint64_t block_address) const {
+    return block_address >> (offset_bits_ + index_bits_);
+}
+
+uint8_t* SharedL2Cache::lineData(size_t set, size_t way) {
+    return &data_[(set * config_.ways + way) * config_.block_size];
+}
+
+int SharedL2Cache::findWay(size_t set, uint64_t tag) const {
+    for (size_t way = 0; way < config_.ways; way++) {
+        const Line& line = lines_[set * config_.ways + way];
+        if (line.valid && line.tag == tag) {
+            return static_cast<int>(way);
+        }
+    }
+    return -1;
+}
+
+size_t SharedL2Cache::selectVictim(size_t set) {
+    size_t victim = 0;
+    uint64_t oldest = UINT64_MAX;
+    for (size_t way = 0; way < config_.ways; way++) {
+        const Line& line = lines_[set * config_.ways + way];
+        if (!line.valid) {
+            return way;
+        }
+        if (line.last_use < oldest) {
+            oldest = line.last_use;
+            victim = way;
+        }
+    }
+    return victim;
+}
+
+void SharedL2Cache::touch(size_t set, size_t way) {
+    lines_[set * config_.ways + way].last_use = ++access_clock_;
+}
+
+// Bancos intercalados por dirección de bloque: bloques consecutivos
+// caen en bancos distintos
+void SharedL2Cache::accountAccess(uint64_t block_address, bool miss) {
+    bank_accesses_[(block_address >> offset_bits_) % config_.banks]++;
+    total_latency_ += config_.hit_latency + (miss ? config_.memory_latency : 0);
+}
+
+// ============================================================
+// ACCESO A RAM
+// ============================================================
+
+void SharedL2Cache::readMemory(uint64_t block_address, uint8_t* data) {
+    uint32_t ram_addr = static_cast<uint32_t>(block_address / sizeof(uint64_t)) & RAM::MAX_ADDRESS;
+    ram_->readBlock(ram_addr, data, config_.block_size);
+    memory_reads_++;
+}
+
+void SharedL2Cache::writeMemory(uint64_t block_address, const uint8_t* data) {
+    uint32_t ram_addr = static_cast<uint32_t>(block_address / sizeof(uint64_t)) & RAM::MAX_ADDRESS;
+    ram_->writeBlock(ram_addr, data, config_.block_size);
+    memory_writes_++;
+}
+
+// ============================================================
+// INSTALACIÓN Y DESALOJO
+// ============================================================
+
+void SharedL2Cache::evict(size_t set, size_t way) {
+    Line& line = lines_[set * config_.ways + way];
+    if (!line.valid) {
+        return;
+    }
+
+    uint64_t block_address = (line.tag << (offset_bits_ + index_bits_)) |
+                             (static_cast<uint64_t>(set) << offset_bits_);
+    uint8_t* data = lineData(set, way);
+    bool dirty = line.dirty;
+
+    // Inclusiva: ninguna L1 puede conservar un bloque que sale de L2.
+    // Si alguna lo tenía modificado, su copia es la más reciente.
+    if (config_.inclusion == InclusionPolicy::INCLUSIVE) {
+        for (ICache* l1 : l1_caches_) {
+            if (l1->backInvalidate(block_address, data)) {
+                dirty = true;
+            }
+        }
+        stats_.back_invalidations++;
+    }
+
+    if (dirty) {
+        writeMemory(block_address, data);
+        stats_.writebacks++;
+    }
+
+    TRACE(CACHE, DETAIL, "[L2] Evict addr=0x" << std::hex << block_address << std::dec
+          << (dirty ? " (writeback)" : ""));
+
+    line.valid = false;
+    line.dirty = false;
+}
+
+size_t SharedL2Cache::install(uint64_t block_address, const uint8_t* data, bool dirty) {
+    size_t set = setIndex(block_address);
+    uint64_t tag = tagOf(block_address);
+
+    int found = findWay(set, tag);
+    size_t way;
+    if (found != -1) {
+        way = static_cast<size_t>(found);
+    } else {
+        way = selectVictim(set);
+        evict(set, way);
+    }
+
+    Line& line = lines_[set * config_.ways + way];
+    line.valid = true;
+    line.tag = tag;
+    // Un bloque ya presente conserva su marca de sucio
+    line.dirty = (found != -1 && line.dirty) || dirty;
+    std::memcpy(lineData(set, way), data, config_.block_size);
+    touch(set, way);
+    return way;
+}
+
+// ============================================================
+// INTERFAZ HACIA LAS L1
+// ============================================================
+
+void SharedL2Cache::readBlock(int requester, uint64_t address, uint8_t* data, size_t size) {
+    if (size != config_.block_size) {
+        throw std::invalid_argument("L2: el bloque de L1 (" + std::to_string(size) +
+                                    " bytes) no coincide con el de L2 (" +
+                                    std::to_string(config_.block_size) + " bytes)");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t block_address = blockAddress(address);
+    size_t set = setIndex(block_address);
+    int way = findWay(set, tagOf(block_address));
+
+    if (way != -1) {
+        stats_.read_hits++;
+        accountAccess(block_address, false);
+        std::memcpy(data, lineData(set, way), size);
+
+        if (config_.inclusion == InclusionPolicy::EXCLUSIVE) {
+            // El bloque sube a L1 y deja L2. La L1 lo instala limpio, así que
+            // una copia sucia se escribe antes a memoria.
+            Line& line = lines_[set * config_.ways + way];
+            if (line.dirty) {
+                writeMemory(block_address, data);
+                stats_.writebacks++;
+            }
+            line.valid = false;
+            line.dirty = false;
+        } else {
+            touch(set, static_cast<size_t>(way));
+        }
+
+        TRACE(CACHE, BASIC, "[L2] READ HIT for PE" << requester << ": addr=0x"
+              << std::hex << block_address << std::dec);
+        return;
+    }
+
+    stats_.read_misses++;
+    accountAccess(block_address, true);
+    readMemory(block_address, data);
+
+    // En modo exclusivo el bloque va directo a L1 sin ocupar L2
+    if (config_.inclusion != InclusionPolicy::EXCLUSIVE) {
+        install(block_address, data, false);
+    }
+
+    TRACE(CACHE, BASIC, "[L2] READ MISS for PE" << requester << ": addr=0x"
+          << std::hex << block_address << std::dec);
+}
+
+void SharedL2Cache::writeBlock(int requester, uint64_t address, const uint8_t* data, size_t size) {
+    if (size != config_.block_size) {
+        throw std::invalid_argument("L2: el bloque de L1 (" + std::to_string(size) +
+                                    " bytes) no coincide con el de L2 (" +
+                                    std::to_string(config_.block_size) + " bytes)");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t block_address = blockAddress(address);
+    size_t set = setIndex(block_address);
+    bool hit = findWay(set, tagOf(block_address)) != -1;
+
+    if (hit) {
+        stats_.write_hits++;
+    } else {
+        stats_.write_misses++;
+    }
+    accountAccess(block_address, false);
+
+    // Write-back + write-allocate en todos los modos: el writeback de L1
+    // queda en L2 y sólo llega a RAM cuando L2 lo desaloja
+    install(block_address, data, true);
+
+    TRACE(CACHE, BASIC, "[L2] WRITEBACK from PE" << requester << ": addr=0x"
+          << std::hex << block_address << std::dec << (hit ? " (hit)" : " (allocate)"));
+}
+
+void SharedL2Cache::handleL1Eviction(int requester, uint64_t address, const uint8_t* data,
+                                     size_t size, bool written_back) {
+    // Sólo la L2 exclusiva recibe las víctimas limpias; las sucias ya
+    // llegaron por writeBlock
+    if (config_.inclusion != InclusionPolicy::EXCLUSIVE || written_back) {
+        return;
+    }
+    if (size != config_.block_size) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t block_address = blockAddress(address);
+    accountAccess(block_address, false);
+    install(block_address, data, false);
+
+    TRACE(CACHE, DETAIL, "[L2] Victim from PE" << requester << " installed: addr=0x"
+          << std::hex << block_address << std::dec);
+}
+
+void SharedL2Cache::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t set = 0; set < config_.sets; set++) {
+        for (size_t way = 0; way < config_.ways; way++) {
+            Line& line = lines_[set * config_.ways + way];
+            if (line.valid && line.dirty) {
+                uint64_t block_address = (line.tag << (offset_bits_ + index_bits_)) |
+                                         (static_cast<uint64_t>(set) << offset_bits_);
+                writeMemory(block_address, lineData(set, way));
+                stats_.writebacks++;
+                line.dirty = false;
+            }
+        }
+    }
+}
+
+// ============================================================
+// ESTADÍSTICAS
+// ============================================================
+
+CacheStats SharedL2Cache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SharedL2Cache::printStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "\n=== Shared L2 Statistics (" << config_.sets << "x" << config_.ways
+              << "x" << config_.block_size << ", " << inclusionPolicyName(config_.inclusion)
+              << ", " << config_.banks << " banks) ===" << std::endl;
+    std::cout << "Read Hits: " << stats_.read_hits << std::endl;
+    std::cout << "Read Misses: " << stats_.read_misses << std::endl;
+    std::cout << "Writeback Hits: " << stats_.write_hits << std::endl;
+    std::cout << "Writeback Misses: " << stats_.write_misses << std::endl;
+    std::cout << "Writebacks to RAM: " << stats_.writebacks << std::endl;
+    std::cout << "Back-invalidation rounds: " << stats_.back_invalidations << std::endl;
+    std::cout << "RAM block reads: " << memory_reads_ << std::endl;
+    std::cout << "RAM block writes: " << memory_writes_ << std::endl;
+
+    uint64_t reads = stats_.read_hits + stats_.read_misses;
+    if (reads > 0) {
+        double hit_rate = static_cast<double>(stats_.read_hits) / reads * 100.0;
+        std::cout << "Read Hit Rate: " << std::fixed << std::setprecision(2)
+                  << hit_rate << "%" << std::endl;
+    }
+
+    uint64_t accesses = 0;
+    for (uint64_t count : bank_accesses_) {
+        accesses += count;
+    }
+    if (accesses > 0) {
+        std::cout << "Avg access latency: " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(total_latency_) / accesses << " cycles" << std::endl;
+        std::cout << "Bank accesses:";
+        for (size_t bank = 0; bank < bank_accesses_.size(); bank++) {
+            std::cout << " B" << bank << "=" << bank_accesses_[bank];
+        }
+        std::cout << std::endl;
+    }
+}
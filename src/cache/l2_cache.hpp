@@ -0,0 +1,106 @@
+#ifndef L2_CACHE_H
+#define L2_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cache.hpp"
+#include "../ram/ram.hpp"
+
+// Relación de inclusión entre la L2 compartida y las L1 privadas
+enum class InclusionPolicy {
+    INCLUSIVE,      // Todo bloque en L1 está en L2; un desalojo en L2 invalida las L1
+    NON_INCLUSIVE,  // L2 se llena con cada miss de L1 pero no fuerza invalidaciones
+    EXCLUSIVE       // L2 actúa como victim cache: sólo guarda lo que sale de las L1
+};
+
+const char* inclusionPolicyName(InclusionPolicy policy);
+bool parseInclusionPolicy(const std::string& text, InclusionPolicy& policy);
+
+struct L2Config {
+    size_t sets = 16;
+    size_t ways = 8;
+    size_t block_size = CACHE_BLOCK_SIZE;
+    size_t banks = 4;                  // Bancos intercalados por índice de bloque
+    uint32_t hit_latency = 12;         // Ciclos por acceso a L2
+    uint32_t memory_latency = 100;     // Ciclos adicionales si se va a RAM
+    InclusionPolicy inclusion = InclusionPolicy::INCLUSIVE;
+};
+
+// Última cache compartida entre las L1 privadas y la RAM. Las L1 la ven a
+// través de IBusInterface (readFromMemory/writeToMemory/notifyEviction).
+class SharedL2Cache {
+public:
+    SharedL2Cache(const L2Config& config, std::shared_ptr<RAM> ram);
+
+    // L1 que deben recibir back-invalidations en modo inclusivo. Lanza
+    // std::invalid_argument si su tamaño de bloque no es el de la L2.
+    void registerL1(ICache* cache);
+
+    // Fill de una L1 (miss en L1)
+    void readBlock(int requester, uint64_t address, uint8_t* data, size_t size);
+    // Writeback de una línea sucia de L1
+    void writeBlock(int requester, uint64_t address, const uint8_t* data, size_t size);
+    // Una L1 desalojó un bloque; written_back indica si ya pasó por writeBlock
+    void handleL1Eviction(int requester, uint64_t address, const uint8_t* data,
+                          size_t size, bool written_back);
+
+    // Escribe a RAM todas las líneas sucias (fin de simulación)
+    void flush();
+
+    const L2Config& getConfig() const { return config_; }
+    CacheStats getStats() const;
+    uint64_t getMemoryReads() const { return memory_reads_; }
+    uint64_t getMemoryWrites() const { return memory_writes_; }
+    uint64_t getTotalLatency() const { return total_latency_; }
+    const std::vector<uint64_t>& getBankAccesses() const { return bank_accesses_; }
+    void printStats() const;
+
+private:
+    struct Line {
+        bool valid = false;
+        bool dirty = false;
+        uint64_t tag = 0;
+        uint64_t last_use = 0;  // LRU por marca de tiempo
+    };
+
+    L2Config config_;
+    std::shared_ptr<RAM> ram_;
+    std::vector<ICache*> l1_caches_;
+
+    std::vector<Line> lines_;                 // sets * ways
+    std::vector<uint8_t> data_;               // sets * ways * block_size
+    size_t offset_bits_;
+    size_t index_bits_;
+    uint64_t access_clock_;
+
+    CacheStats stats_;
+    uint64_t memory_reads_;
+    uint64_t memory_writes_;
+    uint64_t total_latency_;
+    std::vector<uint64_t> bank_accesses_;
+
+    mutable std::mutex mutex_;
+
+    uint64_t blockAddress(uint64_t address) const;
+    size_t setIndex(uint64_t block_address) const;
+    uint64_t tagOf(uint64_t block_address) const;
+    uint8_t* lineData(size_t set, size_t way);
+
+    int findWay(size_t set, uint64_t tag) const;
+    size_t selectVictim(size_t set);
+    void touch(size_t set, size_t way);
+    void accountAccess(uint64_t block_address, bool miss);
+
+    // Instala un bloque (desalojando si hace falta) y devuelve el way usado
+    size_t install(uint64_t block_address, const uint8_t* data, bool dirty);
+    void evict(size_t set, size_t way);
+
+    void readMemory(uint64_t block_address, uint8_t* data);
+    void writeMemory(uint64_t block_address, const uint8_t* data);
+};
+
+#endif // L2_CACHE_H
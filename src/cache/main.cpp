@@ -1,6 +1,91 @@
 #include "cache.hpp"
+#include "l2_cache.hpp"
+#include "../PE/StoreBuffer.hpp"
 #include <iostream>
 #include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+// Bus mínimo que lleva fills, writebacks y desalojos de una L1 a la L2
+class L2Port : public IBusInterface {
+    SharedL2Cache& l2;
+    int pe_id;
+public:
+    L2Port(SharedL2Cache& l2, int pe_id) : l2(l2), pe_id(pe_id) {}
+    SnoopResponse sendMessage(const BusMessage&, uint8_t*) override { return {}; }
+    void readFromMemory(uint64_t address, uint8_t* data, size_t size) override {
+        l2.readBlock(pe_id, address, data, size);
+    }
+    void writeToMemory(uint64_t address, const uint8_t* data, size_t size) override {
+        l2.writeBlock(pe_id, address, data, size);
+    }
+    void notifyEviction(uint64_t address, const uint8_t* data, size_t size, bool written_back) override {
+        l2.handleL1Eviction(pe_id, address, data, size, written_back);
+    }
+    std::vector<uint64_t> back_invalidated;
+    void notifyBackInvalidation(uint64_t address) override {
+        back_invalidated.push_back(address);
+    }
+};
+
+// Puerto del store buffer sobre los MSHRs, como el CacheMemPort del
+// simulador; anota el orden en que cada escritura se hace visible
+class MSHRStorePort : public IMemPort {
+    ICache& cache;
+    size_t pending = 0;
+public:
+    std::vector<uint64_t> visible;
+    explicit MSHRStorePort(ICache& cache) : cache(cache) {}
+    uint64_t load(uint64_t addr) override {
+        uint64_t data = 0;
+        cache.read(addr * sizeof(uint64_t), data);
+        return data;
+    }
+    void store(uint64_t addr, uint64_t data) override { cache.write(addr * sizeof(uint64_t), data); }
+    bool tryStore(uint64_t addr, uint64_t data) override {
+        pending++;
+        auto on_complete = [this](uint64_t address, uint64_t) {
+            pending--;
+            visible.push_back(address / sizeof(uint64_t));
+        };
+        if (cache.writeAsync(addr * sizeof(uint64_t), data, on_complete) == AccessStatus::STALLED) {
+            pending--;
+            return false;
+        }
+        return true;
+    }
+    void tick() override { cache.tick(); }
+    size_t pendingStores() const override { return pending; }
+};
+
+// Bus que cuenta mensajes y lecturas de memoria; cada palabra de memoria
+// vale su dirección de palabra
+class CountingPort : public IBusInterface {
+public:
+    size_t messages = 0;
+    size_t fills = 0;
+    SnoopResponse sendMessage(const BusMessage&, uint8_t*) override {
+        messages++;
+        return {};
+    }
+    void readFromMemory(uint64_t address, uint8_t* data, size_t size) override {
+        fills++;
+        for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+            uint64_t word = address / sizeof(uint64_t) + i;
+            std::memcpy(data + i * sizeof(uint64_t), &word, sizeof(uint64_t));
+        }
+    }
+    void writeToMemory(uint64_t, const uint8_t*, size_t) override {}
+};
+
+// Interconnect que todavía no entregó la respuesta de los misses
+class AwaitingPort : public CountingPort {
+public:
+    bool arrived = false;
+    uint64_t awaitResponse() override { return 1; }
+    bool responseArrived(uint64_t) override { return arrived; }
+};
 
 int main() {
     // Crear una caché para PE0
@@ -44,6 +129,445 @@ int main() {
     assert(stats.read_misses == 2);
     assert(stats.write_hits == 1);
     assert(stats.write_misses == 1);
+    
+    std::cout << "\n--- Test 6: Factory de geometrías ---" << std::endl;
+    for (const CacheGeometry& g : supportedCacheGeometries()) {
+        auto sized = createCache(1, g);
+        CacheGeometry got = sized->getGeometry();
+        assert(got.sets == g.sets && got.ways == g.ways && got.block_size == g.block_size);
+    }
+    // Con 64 sets, addr1 y addr3 (0x100) ya no compiten por el mismo set
+    auto wide = createCache(1, {64, 4, 32});
+    wide->read(addr1, data);
+    wide->read(addr3, data);
+    wide->read(addr1, data);
+    assert(wide->getStats().read_hits == 1);
+    
+    std::cout << "\n--- Test 7: Políticas de reemplazo ---" << std::endl;
+    // A..E mapean al mismo set de una caché 8x4 (stride de 256 bytes)
+    const ReplacementKind kinds[] = {ReplacementKind::LRU, ReplacementKind::TREE_PLRU,
+                                     ReplacementKind::SRRIP, ReplacementKind::BRRIP};
+    for (ReplacementKind kind : kinds) {
+        auto assoc = createCache(2, {8, 4, 32}, kind);
+        assert(assoc->getReplacementKind() == kind);
+        for (uint64_t block = 0; block < 4; block++) {
+            assoc->read(block * 0x100, data);
+        }
+        assoc->read(0x000, data);   // A pasa a ser el más reciente
+        assoc->read(0x400, data);   // E fuerza un reemplazo
+        bool a_hit = assoc->read(0x000, data);
+        assert(a_hit);              // A no debe haber sido la víctima
+    }
+    auto random_cache = createCache(2, {16, 32, 32}, ReplacementKind::RANDOM);
+    for (uint64_t block = 0; block < 64; block++) {
+        random_cache->read(block * 0x200, data);
+    }
+    assert(random_cache->getStats().read_misses == 64);
+    
+    std::cout << "\n--- Test 8: Checkpoint y clonación ---" << std::endl;
+    auto original = createCache(3, {64, 8, 32}, ReplacementKind::SRRIP);
+    original->write(0x40, 0x1111);
+    std::vector<uint8_t> image = original->saveCheckpoint();
+    auto copy = original->clone();
+    original->write(0x40, 0x2222);
+    original->read(0x40, data);
+    assert(data == 0x2222);
+    copy->read(0x40, data);
+    assert(data == 0x1111);
+    original->restoreCheckpoint(image);
+    assert(original->getStats().write_misses == 1 && original->getStats().write_hits == 0);
+    original->read(0x40, data);
+    assert(data == 0x1111);
+    
+    bool rejected = false;
+    try {
+        createCache(1, {3, 2, 32});
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    rejected = false;
+    try {
+        original->restoreCheckpoint(cache.saveCheckpoint());
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    // Misma geometría, otra política: los bits de Tree-PLRU no son edades LRU
+    auto plru = createCache(1, {64, 8, 32}, ReplacementKind::TREE_PLRU);
+    auto lru = createCache(1, {64, 8, 32}, ReplacementKind::LRU);
+    rejected = false;
+    try {
+        lru->restoreCheckpoint(plru->saveCheckpoint());
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    lru->restoreCheckpoint(createCache(2, {64, 8, 32}, ReplacementKind::LRU)->saveCheckpoint());
+    
+    std::cout << "\n--- Test 9: L2 compartida ---" << std::endl;
+    {
+        // L2 de un solo set: los bloques 0x000, 0x020 y 0x040 compiten por él
+        // aunque en L1 caen en sets distintos
+        auto ram = std::make_shared<RAM>(false);
+        L2Config config;
+        config.sets = 1;
+        config.ways = 2;
+        SharedL2Cache l2(config, ram);
+        auto l1 = createCache(0);
+        L2Port port(l2, 0);
+        l1->setBusInterface(&port);
+        l1->setMissClassification(true);
+        l2.registerL1(l1.get());
+        
+        l1->write(0x000, 0x77);
+        l1->read(0x020, data);
+        l1->read(0x040, data);
+        // Inclusiva: sacar 0x000 de L2 lo invalida en L1 y su dato sucio llega a RAM
+        assert(l1->getStats().back_invalidations == 1);
+        assert(ram->read(0) == 0x77);
+        assert(port.back_invalidated == std::vector<uint64_t>{0x000});
+        assert(!l1->read(0x000, data) && data == 0x77);
+        // Víctima de la inclusión, no conflicto ni coherencia
+        assert(l1->getStats().miss_inclusion == 1 && l1->getStats().miss_coherence == 0);
+    }
+    {
+        auto ram = std::make_shared<RAM>(false);
+        ram->write(0, 0x55);
+        L2Config config;
+        config.inclusion = InclusionPolicy::EXCLUSIVE;
+        SharedL2Cache l2(config, ram);
+        auto l1 = createCache(0);
+        L2Port port(l2, 0);
+        l1->setBusInterface(&port);
+        l2.registerL1(l1.get());
+        
+        // Los fills no se quedan en L2; la víctima limpia de L1 sí
+        l1->read(0x000, data);
+        l1->read(0x100, data);
+        l1->read(0x200, data);
+        assert(l2.getStats().read_misses == 3 && l2.getMemoryReads() == 3);
+        l1->read(0x000, data);
+        assert(data == 0x55);
+        assert(l2.getStats().read_hits == 1 && l2.getMemoryReads() == 3);
+    }
+    {
+        // Una L1 con otro tamaño de bloque se rechaza al registrarla
+        SharedL2Cache l2(L2Config{}, std::make_shared<RAM>(false));
+        auto wide = createCache(0, {64, 4, 64}, ReplacementKind::LRU);
+        bool rejected = false;
+        try {
+            l2.registerL1(wide.get());
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        assert(rejected);
+    }
+    
+    std::cout << "\n--- Test 10: Prefetchers ---" << std::endl;
+    {
+        // Recorrido secuencial de 16 bloques: sólo el primero debe fallar
+        auto next_line = createCache(0, {64, 4, 32});
+        next_line->setPrefetcher(createPrefetcher(PrefetcherKind::NEXT_LINE, 32, 2));
+        for (uint64_t block = 0; block < 16; block++) {
+            next_line->read(block * 32, data);
+        }
+        assert(next_line->getStats().read_misses == 1);
+        assert(next_line->getStats().prefetch_useful == 15);
+        
+        // Stride de 2 bloques: tras dos saltos iguales los demás ya están en caché
+        auto stride = createCache(0, {64, 4, 32});
+        stride->setPrefetcher(createPrefetcher(PrefetcherKind::STRIDE, 32, 2));
+        for (uint64_t block = 0; block < 32; block += 2) {
+            stride->read(block * 32, data);
+        }
+        assert(stride->getStats().read_misses == 3);
+        assert(stride->getStats().prefetch_useful == 13);
+        
+        // Stream buffer: los bloques llegan desde el buffer lateral
+        auto stream = createCache(0, {64, 4, 32});
+        stream->setPrefetcher(createPrefetcher(PrefetcherKind::STREAM_BUFFER, 32, 4));
+        for (uint64_t block = 0; block < 8; block++) {
+            stream->read(block * 32, data);
+        }
+        assert(stream->getStats().read_misses == 1 && stream->getStats().read_hits == 7);
+        // Un BusRdX de otro PE descarta la copia del buffer
+        stream->handleBusReadX(8 * 32);
+        stream->read(8 * 32, data);
+        assert(stream->getStats().read_misses == 2);
+        assert(stream->getStats().prefetch_unused == 1);
+    }
+    
+    std::cout << "\n--- Test 11: MSHRs y hit-under-miss ---" << std::endl;
+    {
+        auto nb = createCache(0);
+        MSHRConfig mshr_config;
+        mshr_config.entries = 2;
+        mshr_config.targets_per_entry = 2;
+        mshr_config.miss_latency = 2;
+        nb->setMSHRConfig(mshr_config);
+        nb->read(0x100, data);  // Bloque presente para el hit-under-miss
+        
+        std::vector<uint64_t> completed;
+        auto on_complete = [&](uint64_t address, uint64_t) { completed.push_back(address); };
+        
+        assert(nb->readAsync(0x00, on_complete) == AccessStatus::MISS_ISSUED);
+        assert(nb->readAsync(0x08, on_complete) == AccessStatus::MISS_MERGED);
+        assert(nb->writeAsync(0x10, 5, on_complete) == AccessStatus::STALLED);  // Targets llenos
+        assert(nb->readAsync(0x20, on_complete) == AccessStatus::MISS_ISSUED);
+        assert(nb->readAsync(0x40, on_complete) == AccessStatus::STALLED);      // MSHRs llenos
+        assert(nb->readAsync(0x100, on_complete) == AccessStatus::HIT);
+        assert(completed.size() == 1 && completed[0] == 0x100);
+        assert(nb->outstandingMisses() == 2);
+        
+        nb->tick();
+        assert(completed.size() == 1);
+        nb->tick();
+        assert(nb->outstandingMisses() == 0);
+        assert((completed == std::vector<uint64_t>{0x100, 0x00, 0x08, 0x20}));
+        
+        CacheStats nb_stats = nb->getStats();
+        assert(nb_stats.mshr_allocations == 2 && nb_stats.mshr_merges == 1);
+        assert(nb_stats.mshr_stalls == 2 && nb_stats.mshr_peak_outstanding == 2);
+        
+        bool reconfig_rejected = false;
+        nb->readAsync(0x200, on_complete);
+        try {
+            nb->setMSHRConfig(mshr_config);
+        } catch (const std::logic_error&) {
+            reconfig_rejected = true;
+        }
+        assert(reconfig_rejected);
+    }
+    
+    std::cout << "\n--- Test 12: Perfil de compartición ---" << std::endl;
+    {
+        SharingProfiler profiler(32);
+        auto c0 = createCache(0);
+        auto c1 = createCache(1);
+        c0->setSharingProfiler(&profiler);
+        c1->setSharingProfiler(&profiler);
+        
+        // Cada PE escribe su palabra: la escritura de c1 invalida a c0
+        c0->write(0xc0, 1);
+        c1->write(0xc8, 2);
+        c0->handleBusReadX(0xc0);
+        c0->write(0xc0, 3);
+        BlockSharingReport false_block = profiler.getBlock(0xc0);
+        assert(false_block.pattern == SharingPattern::FALSE_SHARED);
+        assert(false_block.invalidations == 1 && false_block.coherence_misses == 1);
+        assert(false_block.writers == 0b11 && false_block.word_writers[1] == 0b10);
+        
+        // Contador que pasa de PE en PE: leer y luego escribir
+        for (uint64_t round = 0; round < 3; round++) {
+            c0->read(0x100, data);
+            c0->write(0x100, round);
+            c1->read(0x100, data);
+            c1->write(0x100, round);
+        }
+        assert(profiler.getBlock(0x100).pattern == SharingPattern::MIGRATORY);
+        
+        // Productor-consumidor sobre la misma palabra
+        c0->write(0x140, 1);
+        c1->read(0x140, data);
+        c1->read(0x140, data);
+        c0->write(0x140, 2);
+        c1->read(0x140, data);
+        assert(profiler.getBlock(0x140).pattern == SharingPattern::TRUE_SHARED);
+        
+        c0->read(0x180, data);
+        c1->read(0x188, data);
+        c0->read(0x1c0, data);
+        assert(profiler.getBlock(0x180).pattern == SharingPattern::READ_SHARED);
+        assert(profiler.getBlock(0x1c0).pattern == SharingPattern::PRIVATE);
+        assert(profiler.getPatternCount(SharingPattern::READ_SHARED) == 1);
+        
+        assert(profiler.getBlockCount() == 5 && profiler.ranked()[0].block_address == 0xc0);
+        profiler.printReport();
+    }
+    
+    std::cout << "\n--- Test 13: Clasificación de misses ---" << std::endl;
+    {
+        // 8 sets x 2 ways: 16 bloques de capacidad
+        auto classified = createCache(0);
+        classified->setMissClassification(true);
+        
+        // Tres bloques del set 0: la totalmente asociativa los mantiene
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint64_t block : {0x000, 0x100, 0x200}) {
+                classified->read(block, data);
+            }
+        }
+        CacheStats classified_stats = classified->getStats();
+        assert(classified_stats.miss_compulsory == 3 && classified_stats.miss_conflict == 3);
+        assert(classified->getMissClassifier()->getSetCount(0, MissKind::CONFLICT) == 3);
+        
+        // 17 bloques recorridos dos veces: el set 0 recibe tres y los vuelve a
+        // perder, pero la asociativa también los pierde (LRU cíclico)
+        auto streaming = createCache(0);
+        streaming->setMissClassification(true);
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint64_t block = 0; block < 17; block++) {
+                streaming->read(block * 32, data);
+            }
+        }
+        assert(streaming->getStats().miss_compulsory == 17 && streaming->getStats().miss_capacity == 3);
+        assert(streaming->getStats().miss_conflict == 0);
+        
+        // Un BusRdX de otro PE: el próximo miss es de coherencia
+        classified->read(0x040, data);
+        classified->handleBusReadX(0x040);
+        classified->read(0x040, data);
+        assert(classified->getStats().miss_coherence == 1);
+        assert(classified->getMissClassifier()->getSetCount(2, MissKind::COHERENCE) == 1);
+        classified->printStats();
+    }
+    
+    std::cout << "\n--- Test 14: Distancia de reúso ---" << std::endl;
+    {
+        ReuseDistanceProfiler profiler;
+        for (uint64_t block : {0xa0, 0xb0, 0xc0, 0xa0, 0xa0, 0xb0}) {
+            profiler.access(block);
+        }
+        assert(profiler.getColdAccesses() == 3 && profiler.getDistinctBlocks() == 3);
+        assert((profiler.getHistogram() == std::vector<uint64_t>{1, 0, 2}));
+        assert(profiler.predictedHits(1) == 1 && profiler.predictedHits(2) == 1);
+        assert(profiler.predictedHits(3) == 3 && profiler.predictedHits(64) == 3);
+        
+        // Contra una pila LRU explícita, con renumeraciones frecuentes
+        ReuseDistanceProfiler small(4);
+        std::vector<uint64_t> stack;
+        uint64_t seed = 12345;
+        for (int i = 0; i < 2000; i++) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            uint64_t block = (seed >> 33) % 50;
+            auto it = std::find(stack.begin(), stack.end(), block);
+            uint64_t expected = ReuseDistanceProfiler::COLD;
+            if (it != stack.end()) {
+                expected = static_cast<uint64_t>(it - stack.begin());
+                stack.erase(it);
+            }
+            stack.insert(stack.begin(), block);
+            assert(small.access(block) == expected);
+        }
+        
+        // La caché expone la curva de sus propios accesos
+        auto profiled = createCache(0);
+        profiled->setReuseProfiling(true);
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint64_t block = 0; block < 4; block++) {
+                profiled->read(block * 32, data);
+            }
+        }
+        assert(profiled->getReuseProfiler()->predictedHits(4) == 4);
+        assert(profiled->getReuseProfiler()->predictedHits(3) == 0);
+        profiled->printStats();
+    }
+    
+    std::cout << "\n--- Test 15: Store buffer en orden con misses en vuelo ---" << std::endl;
+    {
+        // A (palabra 0x40) falla y espera 4 ticks en su MSHR; B (palabra 0)
+        // acierta. B no puede hacerse visible antes que A.
+        auto tso = createCache(0);
+        MSHRConfig mshr_config;
+        mshr_config.miss_latency = 4;
+        tso->setMSHRConfig(mshr_config);
+        tso->write(0x00, 0);
+        
+        MSHRStorePort port(*tso);
+        StoreBuffer buffer(4);
+        buffer.push(0x40, 0xA);
+        buffer.push(0x00, 0xB);
+        uint64_t cycles = buffer.drainAll(port);
+        assert((port.visible == std::vector<uint64_t>{0x40, 0x00}));
+        assert(cycles > mshr_config.miss_latency);
+        tso->read(0x200, data);
+        assert(data == 0xA);
+        tso->read(0x00, data);
+        assert(data == 0xB);
+    }
+    
+    std::cout << "\n--- Test 16: Misses solapados en los MSHRs ---" << std::endl;
+    {
+        // Los dos misses piden su bloque al asignar el MSHR, antes de
+        // cualquier tick, y al completar se instalan sin volver al bus
+        auto overlap = createCache(0);
+        MSHRConfig mshr_config;
+        mshr_config.miss_latency = 3;
+        overlap->setMSHRConfig(mshr_config);
+        CountingPort port;
+        overlap->setBusInterface(&port);
+        
+        std::vector<uint64_t> values;
+        auto on_complete = [&](uint64_t, uint64_t value) { values.push_back(value); };
+        assert(overlap->readAsync(0x00, on_complete) == AccessStatus::MISS_ISSUED);
+        assert(overlap->readAsync(0x28, on_complete) == AccessStatus::MISS_ISSUED);
+        assert(port.messages == 2 && port.fills == 2);
+        for (uint32_t t = 0; t < mshr_config.miss_latency; t++) {
+            overlap->tick();
+        }
+        assert(port.messages == 2 && port.fills == 2);
+        assert((values == std::vector<uint64_t>{0x00, 0x28 / 8}));
+        CacheStats overlap_stats = overlap->getStats();
+        assert(overlap_stats.read_misses == 2 && overlap_stats.memory_fills == 2);
+        
+        // Un BusRdX de otro PE sobre el bloque en vuelo deja el fill
+        // obsoleto: el miss se repite por el bus al completar
+        overlap->writeAsync(0x40, 9, on_complete);
+        overlap->handleBusReadX(0x40);
+        for (uint32_t t = 0; t < mshr_config.miss_latency; t++) {
+            overlap->tick();
+        }
+        assert(port.messages == 4 && port.fills == 4);
+        overlap->read(0x40, data);
+        assert(data == 9);
+        assert(overlap->getStats().write_misses == 1);
+        
+        // Cumplida la latencia, el miss sigue esperando la respuesta del
+        // interconnect
+        auto awaiting = createCache(0);
+        awaiting->setMSHRConfig(mshr_config);
+        AwaitingPort slow;
+        awaiting->setBusInterface(&slow);
+        values.clear();
+        awaiting->readAsync(0x00, on_complete);
+        for (uint32_t t = 0; t < 2 * mshr_config.miss_latency; t++) {
+            awaiting->tick();
+        }
+        assert(values.empty() && awaiting->outstandingMisses() == 1);
+        slow.arrived = true;
+        assert(awaiting->advanceMisses());
+        awaiting->completeMisses();
+        assert(values.size() == 1 && slow.fills == 1);
+    }
+    
+    std::cout << "\n--- Test 17: Hits locales ---" << std::endl;
+    {
+        // Sólo un hit sin MSHR, y en escritura sólo desde M/E, se resuelve
+        // sin el bus (el simulador lo sirve con el lock de la L1)
+        auto local = createCache(0);
+        CountingPort port;
+        local->setBusInterface(&port);
+        assert(!local->hitsLocally(0x00, false));
+        auto on_complete = [](uint64_t, uint64_t) {};
+        assert(local->readAsync(0x00, on_complete) == AccessStatus::MISS_ISSUED);
+        assert(!local->hitsLocally(0x00, false));
+        while (local->outstandingMisses() > 0) {
+            local->tick();
+        }
+        assert(local->hitsLocally(0x08, false) && local->hitsLocally(0x08, true));
+        
+        // En S la escritura necesita un BusUpgr
+        local->handleBusRead(0x00);
+        assert(local->hitsLocally(0x00, false) && !local->hitsLocally(0x00, true));
+        
+        // El prefetcher puede emitir BusRd en cualquier acceso
+        local->setPrefetcher(createPrefetcher(PrefetcherKind::NEXT_LINE, 32, 1));
+        assert(!local->hitsLocally(0x00, false));
+    }
+    
     std::cout << "All assertions passed!" << std::endl;
     
     return 0;
@@ -1,55 +1,29 @@
 #include "mesi_controller.hpp"
-#include <iostream>
 
-MESIController::MESIController(int pe_id) : pe_id(pe_id), transition_count(0) {}
+namespace {
 
-MESIResult MESIController::processEvent(MESIState current_state, BusEvent event) {
-    MESIResult result;
-    
-    switch (current_state) {
-        case MESIState::INVALID:
-            result = handleInvalidState(event);
-            break;
-        case MESIState::SHARED:
-            result = handleSharedState(event);
-            break;
-        case MESIState::EXCLUSIVE:
-            result = handleExclusiveState(event);
-            break;
-        case MESIState::MODIFIED:
-            result = handleModifiedState(event);
-            break;
-    }
-    
-    if (result.new_state != current_state) {
-        transition_count++;
-        std::cout << "[PE" << pe_id << "] MESI: " 
-                  << getStateName(current_state) << " -> " 
-                  << getStateName(result.new_state) 
-                  << " (Event: " << getEventName(event) << ")" << std::endl;
-    }
-    
-    return result;
-}
+// ============================================================
+// MESI
+// ============================================================
 
-MESIResult MESIController::handleInvalidState(BusEvent event) {
+constexpr MESIResult mesiInvalid(BusEvent event) {
     MESIResult result;
     result.new_state = MESIState::INVALID;
     
     switch (event) {
         case BusEvent::LOCAL_READ:
             // I -> E o I -> S (depende de respuesta de otros PEs)
-            // Enviamos BUS_READ y esperamos respuesta
-            result.new_state = MESIState::EXCLUSIVE;  // Asumimos E, se ajustará a S si otro responde
+            // Enviamos BUS_READ; la caché ajusta el estado con resolveReadFill()
+            result.new_state = MESIState::EXCLUSIVE;  // Provisional: S si otro asserta shared
             result.needs_bus_message = true;          // Enviar BUS_READ por interconnect
-            result.fetch_from_memory = true;          // Siempre va a memoria (puede ser interceptado)
+            result.fetch_from_memory = true;          // Salvo que otra caché entregue el bloque
             break;
             
         case BusEvent::LOCAL_WRITE:
             // I -> M
             result.new_state = MESIState::MODIFIED;
             result.needs_bus_message = true;          // Enviar BUS_READX para invalidar otros
-            result.fetch_from_memory = true;          // Va a memoria por el bloque
+            result.fetch_from_memory = true;          // Salvo que otra caché entregue el bloque
             break;
             
         case BusEvent::BUS_READ:
@@ -68,7 +42,7 @@ MESIResult MESIController::handleInvalidState(BusEvent event) {
     return result;
 }
 
-MESIResult MESIController::handleSharedState(BusEvent event) {
+constexpr MESIResult mesiShared(BusEvent event) {
     MESIResult result;
     result.new_state = MESIState::SHARED;
     
@@ -86,8 +60,8 @@ MESIResult MESIController::handleSharedState(BusEvent event) {
             
         case BusEvent::BUS_READ:
             // S -> S (otro también lee, permanecemos en S)
+            // Sólo assertamos shared: sin dueño designado, el dato viene de memoria
             result.new_state = MESIState::SHARED;
-            result.supply_data = true;  // Podemos proveer el dato si se requiere
             break;
             
         case BusEvent::BUS_READX:
@@ -111,7 +85,7 @@ MESIResult MESIController::handleSharedState(BusEvent event) {
     return result;
 }
 
-MESIResult MESIController::handleExclusiveState(BusEvent event) {
+constexpr MESIResult mesiExclusive(BusEvent event) {
     MESIResult result;
     result.new_state = MESIState::EXCLUSIVE;
     
@@ -153,7 +127,7 @@ MESIResult MESIController::handleExclusiveState(BusEvent event) {
     return result;
 }
 
-MESIResult MESIController::handleModifiedState(BusEvent event) {
+constexpr MESIResult mesiModified(BusEvent event) {
     MESIResult result;
     result.new_state = MESIState::MODIFIED;
     
@@ -170,20 +144,21 @@ MESIResult MESIController::handleModifiedState(BusEvent event) {
             
         case BusEvent::BUS_READ:
             // M -> S (otro quiere leer)
-            // Debemos hacer writeback primero para actualizar memoria
-            // Luego el PE solicitante va a memoria
+            // Le pasamos el bloque directamente y además actualizamos
+            // memoria: en MESI ninguna copia S puede quedar sucia
             result.new_state = MESIState::SHARED;
             result.needs_writeback = true;  // Actualizar memoria
-            result.supply_data = false;      // NO le pasamos directamente, va a memoria
+            result.supply_data = true;      // Cache-to-cache, el solicitante no lee memoria
             break;
             
         case BusEvent::BUS_READX:
             // M -> I (otro quiere escribir)
-            // Hacemos writeback primero, luego invalidamos
+            // El bloque sucio pasa al solicitante, que queda en M; el
+            // writeback sólo hace falta si nadie recoge el dato
             result.new_state = MESIState::INVALID;
-            result.needs_writeback = true;   // Actualizar memoria primero
+            result.needs_writeback = true;   // Omitido si se entrega el bloque
             result.needs_invalidate = true;
-            result.supply_data = false;      // El otro PE va a memoria después del writeback
+            result.supply_data = true;
             break;
             
         case BusEvent::BUS_UPGRADE:
@@ -201,24 +176,182 @@ MESIResult MESIController::handleModifiedState(BusEvent event) {
     return result;
 }
 
-std::string MESIController::getStateName(MESIState state) {
+constexpr MESIResult mesiRule(MESIState state, BusEvent event) {
     switch (state) {
-        case MESIState::INVALID:   return "I";
-        case MESIState::SHARED:    return "S";
-        case MESIState::EXCLUSIVE: return "E";
-        case MESIState::MODIFIED:  return "M";
-        default: return "?";
+        case MESIState::INVALID:   return mesiInvalid(event);
+        case MESIState::SHARED:    return mesiShared(event);
+        case MESIState::EXCLUSIVE: return mesiExclusive(event);
+        case MESIState::MODIFIED:  return mesiModified(event);
+        default:                   return MESIResult();  // O y F no existen en MESI
     }
 }
 
-std::string MESIController::getEventName(BusEvent event) {
+// ============================================================
+// MOESI
+// ============================================================
+
+constexpr MESIResult moesiOwned(BusEvent event) {
+    MESIResult result;
+    result.new_state = MESIState::OWNED;
+    
     switch (event) {
-        case BusEvent::LOCAL_READ:   return "LocalRead";
-        case BusEvent::LOCAL_WRITE:  return "LocalWrite";
-        case BusEvent::BUS_READ:     return "BusRead";
-        case BusEvent::BUS_READX:    return "BusReadX";
-        case BusEvent::BUS_UPGRADE:  return "BusUpgrade";
-        case BusEvent::EVICTION:     return "Eviction";
-        default: return "?";
+        case BusEvent::LOCAL_READ:
+            // O -> O (hit sucio)
+            break;
+            
+        case BusEvent::LOCAL_WRITE:
+            // O -> M (hay sharers: BUS_UPGRADE para invalidarlos)
+            result.new_state = MESIState::MODIFIED;
+            result.needs_bus_message = true;
+            break;
+            
+        case BusEvent::BUS_READ:
+            // O -> O (seguimos siendo el dueño y entregamos el bloque)
+            result.supply_data = true;
+            break;
+            
+        case BusEvent::BUS_READX:
+            // O -> I (el bloque sucio pasa al solicitante)
+            result.new_state = MESIState::INVALID;
+            result.needs_writeback = true;   // Omitido si se entrega el bloque
+            result.needs_invalidate = true;
+            result.supply_data = true;
+            break;
+            
+        case BusEvent::BUS_UPGRADE:
+            // O -> I (un sharer con el mismo dato pasa a M y hereda el writeback)
+            result.new_state = MESIState::INVALID;
+            result.needs_invalidate = true;
+            break;
+            
+        case BusEvent::EVICTION:
+            // O -> I (el dueño debe actualizar memoria)
+            result.new_state = MESIState::INVALID;
+            result.needs_writeback = true;
+            break;
     }
-}
\ No newline at end of file
+    
+    return result;
+}
+
+constexpr MESIResult moesiRule(MESIState state, BusEvent event) {
+    if (state == MESIState::OWNED) {
+        return moesiOwned(event);
+    }
+    MESIResult result = mesiRule(state, event);
+    if (state == MESIState::MODIFIED && event == BusEvent::BUS_READ) {
+        // M -> O: compartimos el bloque sucio sin actualizar memoria
+        result.new_state = MESIState::OWNED;
+        result.needs_writeback = false;
+    }
+    return result;
+}
+
+// ============================================================
+// MESIF
+// ============================================================
+
+constexpr MESIResult mesifForward(BusEvent event) {
+    MESIResult result;
+    result.new_state = MESIState::FORWARD;
+    
+    switch (event) {
+        case BusEvent::LOCAL_READ:
+            // F -> F (hit limpio)
+            break;
+            
+        case BusEvent::LOCAL_WRITE:
+            // F -> M (BUS_UPGRADE para invalidar a los S)
+            result.new_state = MESIState::MODIFIED;
+            result.needs_bus_message = true;
+            break;
+            
+        case BusEvent::BUS_READ:
+            // F -> S (entregamos el bloque; el solicitante pasa a ser F)
+            result.new_state = MESIState::SHARED;
+            result.supply_data = true;
+            break;
+            
+        case BusEvent::BUS_READX:
+            // F -> I (entregamos el bloque antes de invalidar)
+            result.new_state = MESIState::INVALID;
+            result.needs_invalidate = true;
+            result.supply_data = true;
+            break;
+            
+        case BusEvent::BUS_UPGRADE:
+            // F -> I
+            result.new_state = MESIState::INVALID;
+            result.needs_invalidate = true;
+            break;
+            
+        case BusEvent::EVICTION:
+            // F -> I (limpio; los S restantes leerán de memoria)
+            result.new_state = MESIState::INVALID;
+            break;
+    }
+    
+    return result;
+}
+
+constexpr MESIResult mesifRule(MESIState state, BusEvent event) {
+    // El resto es MESI; un miss de lectura con sharers se instala en F (shared_fill)
+    return state == MESIState::FORWARD ? mesifForward(event) : mesiRule(state, event);
+}
+
+// ============================================================
+// CONSTRUCCIÓN DE LAS TABLAS
+// ============================================================
+
+constexpr uint8_t stateBit(MESIState state) {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(state));
+}
+
+constexpr uint8_t MESI_STATES = stateBit(MESIState::INVALID) | stateBit(MESIState::SHARED) |
+                                stateBit(MESIState::EXCLUSIVE) | stateBit(MESIState::MODIFIED);
+
+constexpr TransitionTable buildTable(CoherenceProtocol protocol, uint8_t state_mask,
+                                     MESIState shared_fill, MESIResult (*rule)(MESIState, BusEvent)) {
+    TransitionTable table;
+    table.protocol = protocol;
+    table.state_mask = state_mask;
+    table.shared_fill = shared_fill;
+    for (size_t state = 0; state < NUM_COHERENCE_STATES; state++) {
+        for (size_t event = 0; event < NUM_BUS_EVENTS; event++) {
+            TransitionEntry& entry = table.entries[state][event];
+            entry.result = rule(static_cast<MESIState>(state), static_cast<BusEvent>(event));
+            entry.id = static_cast<uint8_t>(state * NUM_BUS_EVENTS + event);
+        }
+    }
+    return table;
+}
+
+constexpr TransitionTable MESI_RULES = buildTable(
+    CoherenceProtocol::MESI, MESI_STATES, MESIState::SHARED, mesiRule);
+constexpr TransitionTable MOESI_RULES = buildTable(
+    CoherenceProtocol::MOESI, MESI_STATES | stateBit(MESIState::OWNED), MESIState::SHARED, moesiRule);
+constexpr TransitionTable MESIF_RULES = buildTable(
+    CoherenceProtocol::MESIF, MESI_STATES | stateBit(MESIState::FORWARD), MESIState::FORWARD, mesifRule);
+
+// Las tablas se verifican al compilar
+static_assert(MESI_RULES.at(MESIState::INVALID, BusEvent::LOCAL_READ).result.needs_bus_message,
+              "Un miss de lectura debe emitir BusRd");
+static_assert(MESI_RULES.at(MESIState::MODIFIED, BusEvent::BUS_READ).result.needs_writeback,
+              "MESI: M -> S actualiza memoria");
+static_assert(MOESI_RULES.at(MESIState::MODIFIED, BusEvent::BUS_READ).result.new_state == MESIState::OWNED &&
+              !MOESI_RULES.at(MESIState::MODIFIED, BusEvent::BUS_READ).result.needs_writeback,
+              "MOESI: M -> O sin writeback");
+static_assert(MOESI_RULES.at(MESIState::OWNED, BusEvent::EVICTION).result.needs_writeback,
+              "MOESI: desalojar O requiere writeback");
+static_assert(!MESIF_RULES.at(MESIState::SHARED, BusEvent::BUS_READ).result.supply_data &&
+              MESIF_RULES.at(MESIState::FORWARD, BusEvent::BUS_READ).result.supply_data,
+              "MESIF: sólo F responde a los BusRd");
+static_assert(MESIF_RULES.at(MESIState::EXCLUSIVE, BusEvent::LOCAL_WRITE).id ==
+              static_cast<uint8_t>(MESIState::EXCLUSIVE) * NUM_BUS_EVENTS + static_cast<uint8_t>(BusEvent::LOCAL_WRITE),
+              "id = estado * NUM_BUS_EVENTS + evento");
+
+} // namespace
+
+const TransitionTable MESI_TABLE = MESI_RULES;
+const TransitionTable MOESI_TABLE = MOESI_RULES;
+const TransitionTable MESIF_TABLE = MESIF_RULES;
@@ -0,0 +1,108 @@
+#include "miss_classifier.hpp"
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+const char* missKindName(MissKind kind) {
+    switch (kind) {
+        case MissKind::COMPULSORY: return "compulsory";
+        case MissKind::CAPACITY:   return "capacity";
+        case MissKind::CONFLICT:   return "conflict";
+        case MissKind::COHERENCE:  return "coherence";
+        case MissKind::INCLUSION:  return "inclusion";
+        default: return "?";
+    }
+}
+
+MissClassifier::MissClassifier(size_t sets, size_t ways)
+    : capacity_(sets * ways), per_set_(sets) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("MissClassifier: la caché debe tener al menos un bloque");
+    }
+}
+
+bool MissClassifier::touch(uint64_t block_address) {
+    auto it = shadow_.find(block_address);
+    if (it != shadow_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return true;
+    }
+    lru_.push_front(block_address);
+    shadow_[block_address] = lru_.begin();
+    if (lru_.size() > capacity_) {
+        shadow_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    return false;
+}
+
+void MissClassifier::noteHit(uint64_t block_address) {
+    touch(block_address);
+    seen_.insert(block_address);
+    lost_.erase(block_address);  // Pudo volver por un prefetch
+    back_invalidated_.erase(block_address);
+}
+
+MissKind MissClassifier::classifyMiss(uint64_t block_address, size_t set_index) {
+    bool in_shadow = touch(block_address);
+    
+    MissKind kind;
+    if (seen_.insert(block_address).second) {
+        kind = MissKind::COMPULSORY;
+    } else if (lost_.erase(block_address) != 0) {
+        kind = MissKind::COHERENCE;
+    } else if (back_invalidated_.erase(block_address) != 0) {
+        kind = MissKind::INCLUSION;
+    } else if (!in_shadow) {
+        kind = MissKind::CAPACITY;
+    } else {
+        kind = MissKind::CONFLICT;
+    }
+    
+    counts_[static_cast<size_t>(kind)]++;
+    per_set_.at(set_index)[static_cast<size_t>(kind)]++;
+    return kind;
+}
+
+void MissClassifier::noteInvalidation(uint64_t block_address) {
+    lost_.insert(block_address);
+    // La sombra tampoco conserva la copia invalidada
+    auto it = shadow_.find(block_address);
+    if (it != shadow_.end()) {
+        lru_.erase(it->second);
+        shadow_.erase(it);
+    }
+}
+
+void MissClassifier::noteBackInvalidation(uint64_t block_address) {
+    // La sombra modela una L1 totalmente asociativa, que la L2 también
+    // habría invalidado; el bloque deja de contar como hit en ella
+    back_invalidated_.insert(block_address);
+    lost_.erase(block_address);
+    auto it = shadow_.find(block_address);
+    if (it != shadow_.end()) {
+        lru_.erase(it->second);
+        shadow_.erase(it);
+    }
+}
+
+void MissClassifier::printSetBreakdown() const {
+    std::cout << "Misses por set:" << std::endl;
+    std::cout << std::setw(6) << "Set";
+    for (size_t k = 0; k < NUM_MISS_KINDS; k++) {
+        std::cout << std::setw(12) << missKindName(static_cast<MissKind>(k));
+    }
+    std::cout << std::endl;
+    for (size_t set = 0; set < per_set_.size(); set++) {
+        const Counts& counts = per_set_[set];
+        if (std::accumulate(counts.begin(), counts.end(), uint64_t{0}) == 0) {
+            continue;
+        }
+        std::cout << std::setw(6) << set;
+        for (uint64_t count : counts) {
+            std::cout << std::setw(12) << count;
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef MISS_CLASSIFIER_H
+#define MISS_CLASSIFIER_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Clasificación 3C de los misses más los de coherencia
+enum class MissKind {
+    COMPULSORY,   // Primer acceso al bloque (fallaría aun con caché infinita)
+    CAPACITY,     // También falla en una caché totalmente asociativa del mismo tamaño
+    CONFLICT,     // La totalmente asociativa lo tendría: culpa del indexado por set
+    COHERENCE,    // El bloque se perdió por una invalidación de otro PE
+    INCLUSION     // La L2 inclusiva lo desalojó y se llevó la copia de L1
+};
+
+constexpr size_t NUM_MISS_KINDS = 5;
+
+const char* missKindName(MissKind kind);
+
+// ------------------------------------------------------------
+// Clasificador de misses de una caché. Mantiene una caché sombra
+// totalmente asociativa LRU con la misma capacidad en bloques y el
+// conjunto de bloques vistos alguna vez (caché infinita). La caché le
+// muestra cada acceso de demanda; las direcciones son de bloque.
+// ------------------------------------------------------------
+class MissClassifier {
+public:
+    MissClassifier(size_t sets, size_t ways);
+    
+    void noteHit(uint64_t block_address);
+    MissKind classifyMiss(uint64_t block_address, size_t set_index);
+    // Snoop invalidante: el próximo miss al bloque es de coherencia
+    void noteInvalidation(uint64_t block_address);
+    // Back-invalidation de la L2: el próximo miss es víctima de la inclusión
+    void noteBackInvalidation(uint64_t block_address);
+    
+    uint64_t getCount(MissKind kind) const { return counts_[static_cast<size_t>(kind)]; }
+    uint64_t getSetCount(size_t set_index, MissKind kind) const {
+        return per_set_.at(set_index)[static_cast<size_t>(kind)];
+    }
+    size_t getSets() const { return per_set_.size(); }
+    
+    // Tabla por set (sólo los sets con misses)
+    void printSetBreakdown() const;
+    
+private:
+    using Counts = std::array<uint64_t, NUM_MISS_KINDS>;
+    
+    size_t capacity_;
+    // Caché sombra: frente = MRU
+    std::list<uint64_t> lru_;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> shadow_;
+    std::unordered_set<uint64_t> seen_;
+    std::unordered_set<uint64_t> lost_;   // Invalidados por coherencia y no vueltos a traer
+    std::unordered_set<uint64_t> back_invalidated_;  // Sacados por la L2 y no vueltos a traer
+    Counts counts_{};
+    std::vector<Counts> per_set_;
+    
+    // Acceso a la caché sombra; devuelve true si el bloque estaba
+    bool touch(uint64_t block_address);
+};
+
+#endif // MISS_CLASSIFIER_H
@@ -0,0 +1,87 @@
+#include "mshr.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+const char* accessStatusName(AccessStatus status) {
+    switch (status) {
+        case AccessStatus::HIT:         return "HIT";
+        case AccessStatus::MISS_ISSUED: return "MISS_ISSUED";
+        case AccessStatus::MISS_MERGED: return "MISS_MERGED";
+        case AccessStatus::STALLED:     return "STALLED";
+        default: return "?";
+    }
+}
+
+MSHRFile::MSHRFile(const MSHRConfig& config)
+    : config_(config), outstanding_(0), next_sequence_(0) {
+    if (config_.entries == 0 || config_.targets_per_entry == 0 || config_.miss_latency == 0) {
+        throw std::invalid_argument("MSHRConfig: entries, targets_per_entry y miss_latency deben ser > 0");
+    }
+    entries_.resize(config_.entries);
+    for (MSHREntry& entry : entries_) {
+        entry.targets.reserve(config_.targets_per_entry);
+    }
+}
+
+MSHREntry* MSHRFile::find(uint64_t block_address) {
+    if (outstanding_ == 0) {
+        return nullptr;
+    }
+    for (MSHREntry& entry : entries_) {
+        if (entry.valid && entry.block_address == block_address) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+MSHREntry* MSHRFile::allocate(uint64_t block_address) {
+    for (MSHREntry& entry : entries_) {
+        if (!entry.valid) {
+            entry.valid = true;
+            entry.block_address = block_address;
+            entry.remaining = config_.miss_latency;
+            entry.sequence = next_sequence_++;
+            entry.targets.clear();
+            entry.issued = entry.exclusive = entry.shared = entry.supplied = entry.stale = false;
+            entry.ticket = 0;
+            outstanding_++;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+size_t MSHRFile::advance(const std::function<bool(uint64_t)>& arrived) {
+    size_t ready = 0;
+    for (MSHREntry& entry : entries_) {
+        if (!entry.valid) {
+            continue;
+        }
+        if (entry.remaining > 0) {
+            entry.remaining--;
+        }
+        if (entry.ticket != 0 && (!arrived || arrived(entry.ticket))) {
+            entry.ticket = 0;
+        }
+        if (entry.remaining == 0 && entry.ticket == 0) {
+            ready++;
+        }
+    }
+    return ready;
+}
+
+void MSHRFile::collect(std::vector<MSHREntry>& ready) {
+    size_t first = ready.size();
+    for (MSHREntry& entry : entries_) {
+        if (entry.valid && entry.remaining == 0 && entry.ticket == 0) {
+            ready.push_back(std::move(entry));
+            entry.valid = false;
+            entry.targets.clear();
+            entry.targets.reserve(config_.targets_per_entry);
+            outstanding_--;
+        }
+    }
+    std::sort(ready.begin() + first, ready.end(),
+              [](const MSHREntry& a, const MSHREntry& b) { return a.sequence < b.sequence; });
+}
@@ -0,0 +1,87 @@
+#ifndef MSHR_H
+#define MSHR_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Configuración de los Miss Status Holding Registers de una caché
+struct MSHRConfig {
+    size_t entries = 4;             // Misses de bloques distintos en vuelo
+    size_t targets_per_entry = 4;   // Accesos fusionables por bloque
+    uint32_t miss_latency = 1;      // Ticks hasta completar un miss
+};
+
+// Resultado de un acceso no bloqueante
+enum class AccessStatus {
+    HIT,          // Completado; el callback ya se invocó
+    MISS_ISSUED,  // Miss primario: se asignó un MSHR
+    MISS_MERGED,  // Miss secundario: se fusionó con el MSHR del bloque
+    STALLED       // Sin MSHR o sin espacio para otro target: reintentar tras tick()
+};
+
+const char* accessStatusName(AccessStatus status);
+
+// Callback hacia el solicitante: (dirección del acceso, dato leído o escrito)
+using CacheCallback = std::function<void(uint64_t, uint64_t)>;
+
+struct MSHRTarget {
+    bool is_write;
+    uint64_t address;
+    uint64_t data;
+    CacheCallback callback;
+};
+
+struct MSHREntry {
+    bool valid = false;
+    uint64_t block_address = 0;
+    uint32_t remaining = 0;         // Ticks restantes
+    uint64_t sequence = 0;          // Orden de asignación
+    std::vector<MSHRTarget> targets;
+    
+    // Fill en vuelo: el mensaje de bus sale al asignar la entrada y el
+    // bloque espera aquí hasta que se completa
+    bool issued = false;
+    bool exclusive = false;         // Pedido con BusRdX
+    bool shared = false;            // Señal shared del BusRd
+    bool supplied = false;          // Lo entregó otra caché
+    bool stale = false;             // Un snoop tocó el bloque: se repite el miss
+    std::vector<uint8_t> fill;
+    // Respuesta pendiente del interconnect (IBusInterface::awaitResponse);
+    // 0 si no hay que esperarla. La entrada no completa hasta que llega.
+    uint64_t ticket = 0;
+};
+
+class MSHRFile {
+public:
+    explicit MSHRFile(const MSHRConfig& config = MSHRConfig());
+
+    const MSHRConfig& getConfig() const { return config_; }
+    size_t outstanding() const { return outstanding_; }
+    bool full() const { return outstanding_ == entries_.size(); }
+
+    // Entrada en vuelo para el bloque, o nullptr
+    MSHREntry* find(uint64_t block_address);
+    // Nueva entrada, o nullptr si están todas ocupadas
+    MSHREntry* allocate(uint64_t block_address);
+    bool canMerge(const MSHREntry& entry) const {
+        return entry.targets.size() < config_.targets_per_entry;
+    }
+
+    // Avanza un tick la latencia de las entradas en vuelo. `arrived` dice si
+    // ya llegó la respuesta de un ticket; devuelve cuántas están listas
+    // (latencia cumplida y sin respuesta pendiente).
+    size_t advance(const std::function<bool(uint64_t)>& arrived = nullptr);
+    // Las entradas listas se mueven a `ready` (en orden de asignación) y su
+    // registro queda libre
+    void collect(std::vector<MSHREntry>& ready);
+
+private:
+    MSHRConfig config_;
+    std::vector<MSHREntry> entries_;
+    size_t outstanding_;
+    uint64_t next_sequence_;
+};
+
+#endif // MSHR_H
@@ -0,0 +1,240 @@
+#include "prefetcher.hpp"
+#include <cstring>
+
+const char* prefetcherKindName(PrefetcherKind kind) {
+    switch (kind) {
+        case PrefetcherKind::NONE:          return "none";
+        case PrefetcherKind::NEXT_LINE:     return "next-N-line";
+        case PrefetcherKind::STRIDE:        return "stride";
+        case PrefetcherKind::STREAM_BUFFER: return "stream-buffer";
+        default: return "?";
+    }
+}
+
+bool parsePrefetcherKind(const std::string& text, PrefetcherKind& kind) {
+    if (text == "none")          kind = PrefetcherKind::NONE;
+    else if (text == "nextline") kind = PrefetcherKind::NEXT_LINE;
+    else if (text == "stride")   kind = PrefetcherKind::STRIDE;
+    else if (text == "stream")   kind = PrefetcherKind::STREAM_BUFFER;
+    else return false;
+    return true;
+}
+
+uint64_t Prefetcher::noteUsed(uint64_t block_address, uint64_t now) {
+    auto it = issued_at_.find(block_address);
+    if (it == issued_at_.end()) {
+        return 0;
+    }
+    uint64_t lead = now - it->second;
+    issued_at_.erase(it);
+    return lead;
+}
+
+// ============================================================
+// NEXT-N-LINE
+// ============================================================
+
+void NextLinePrefetcher::observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) {
+    if (!trigger) {
+        return;
+    }
+    for (size_t k = 1; k <= degree_; k++) {
+        candidates.push_back(block_address + k * block_size_);
+    }
+}
+
+// ============================================================
+// STRIDE (sin PC)
+// ============================================================
+
+StridePrefetcher::StridePrefetcher(size_t block_size, size_t degree)
+    : Prefetcher(block_size, degree) {}
+
+void StridePrefetcher::observe(uint64_t block_address, bool /*trigger*/, std::vector<uint64_t>& candidates) {
+    int64_t block = static_cast<int64_t>(block_address / block_size_);
+    clock_++;
+
+    // Flujo más cercano dentro de la ventana
+    Stream* match = nullptr;
+    int64_t best_distance = WINDOW + 1;
+    for (Stream& stream : streams_) {
+        if (!stream.valid) {
+            continue;
+        }
+        int64_t distance = block - stream.last_block;
+        if (distance < 0) {
+            distance = -distance;
+        }
+        if (distance < best_distance) {
+            best_distance = distance;
+            match = &stream;
+        }
+    }
+
+    if (match == nullptr) {
+        // Nuevo flujo: reemplaza el libre o el menos usado
+        Stream* victim = &streams_[0];
+        for (Stream& stream : streams_) {
+            if (!stream.valid) {
+                victim = &stream;
+                break;
+            }
+            if (stream.last_use < victim->last_use) {
+                victim = &stream;
+            }
+        }
+        *victim = Stream{true, block, 0, 0, clock_};
+        return;
+    }
+
+    match->last_use = clock_;
+    int64_t delta = block - match->last_block;
+    if (delta == 0) {
+        return;  // Mismo bloque: no aporta información de stride
+    }
+
+    if (delta == match->stride) {
+        if (match->confidence < MAX_CONFIDENCE) {
+            match->confidence++;
+        }
+    } else {
+        match->stride = delta;
+        match->confidence = 0;
+    }
+    match->last_block = block;
+
+    // Dos saltos iguales consecutivos bastan para emitir
+    if (match->confidence >= 1) {
+        for (size_t k = 1; k <= degree_; k++) {
+            int64_t target = block + match->stride * static_cast<int64_t>(k);
+            if (target >= 0) {
+                candidates.push_back(static_cast<uint64_t>(target) * block_size_);
+            }
+        }
+    }
+}
+
+// ============================================================
+// STREAM BUFFERS
+// ============================================================
+
+StreamBufferPrefetcher::StreamBufferPrefetcher(size_t block_size, size_t degree)
+    : Prefetcher(block_size, degree) {}
+
+void StreamBufferPrefetcher::refill(Buffer& buffer, std::vector<uint64_t>& candidates) {
+    while (buffer.entries.size() < degree_) {
+        buffer.entries.push_back({buffer.next_block, false, {}});
+        candidates.push_back(buffer.next_block);
+        buffer.next_block += block_size_;
+    }
+}
+
+bool StreamBufferPrefetcher::takeFromBuffer(uint64_t block_address, uint8_t* data) {
+    refill_buffer_ = -1;
+    for (size_t b = 0; b < BUFFERS; b++) {
+        Buffer& buffer = buffers_[b];
+        for (size_t pos = 0; pos < buffer.entries.size(); pos++) {
+            Entry& entry = buffer.entries[pos];
+            if (entry.block_address != block_address || !entry.ready) {
+                continue;
+            }
+            std::memcpy(data, entry.data.data(), block_size_);
+
+            // Los bloques anteriores en la FIFO se saltaron: se descartan
+            for (size_t skipped = 0; skipped < pos; skipped++) {
+                if (buffer.entries[skipped].ready) {
+                    dropped_++;
+                }
+                noteDropped(buffer.entries[skipped].block_address);
+            }
+            buffer.entries.erase(buffer.entries.begin(), buffer.entries.begin() + pos + 1);
+            buffer.last_use = ++clock_;
+            refill_buffer_ = static_cast<int>(b);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StreamBufferPrefetcher::holdsBlock(uint64_t block_address) const {
+    for (const Buffer& buffer : buffers_) {
+        for (const Entry& entry : buffer.entries) {
+            if (entry.block_address == block_address && entry.ready) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void StreamBufferPrefetcher::observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) {
+    if (!trigger) {
+        return;
+    }
+
+    // El miss lo sirvió un buffer: sólo hay que reponer su cola
+    if (refill_buffer_ >= 0) {
+        refill(buffers_[refill_buffer_], candidates);
+        refill_buffer_ = -1;
+        return;
+    }
+
+    // Miss fuera de todos los buffers: reasignar el menos usado al nuevo flujo
+    Buffer* victim = &buffers_[0];
+    for (Buffer& buffer : buffers_) {
+        if (buffer.last_use < victim->last_use) {
+            victim = &buffer;
+        }
+    }
+    for (const Entry& entry : victim->entries) {
+        if (entry.ready) {
+            dropped_++;
+        }
+        noteDropped(entry.block_address);
+    }
+    victim->entries.clear();
+    victim->next_block = block_address + block_size_;
+    victim->last_use = ++clock_;
+    refill(*victim, candidates);
+}
+
+void StreamBufferPrefetcher::fillBuffer(uint64_t block_address, const uint8_t* data) {
+    for (Buffer& buffer : buffers_) {
+        for (Entry& entry : buffer.entries) {
+            if (entry.block_address == block_address && !entry.ready) {
+                entry.data.assign(data, data + block_size_);
+                entry.ready = true;
+                return;
+            }
+        }
+    }
+}
+
+void StreamBufferPrefetcher::invalidate(uint64_t block_address) {
+    for (Buffer& buffer : buffers_) {
+        for (size_t pos = 0; pos < buffer.entries.size(); pos++) {
+            if (buffer.entries[pos].block_address == block_address) {
+                if (buffer.entries[pos].ready) {
+                    dropped_++;
+                }
+                noteDropped(block_address);
+                buffer.entries.erase(buffer.entries.begin() + pos);
+                break;
+            }
+        }
+    }
+}
+
+std::unique_ptr<Prefetcher> createPrefetcher(PrefetcherKind kind, size_t block_size, size_t degree) {
+    switch (kind) {
+        case PrefetcherKind::NEXT_LINE:
+            return std::make_unique<NextLinePrefetcher>(block_size, degree);
+        case PrefetcherKind::STRIDE:
+            return std::make_unique<StridePrefetcher>(block_size, degree);
+        case PrefetcherKind::STREAM_BUFFER:
+            return std::make_unique<StreamBufferPrefetcher>(block_size, degree);
+        case PrefetcherKind::NONE:
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Prefetchers disponibles (uno por caché, elegido en tiempo de ejecución)
+enum class PrefetcherKind {
+    NONE,
+    NEXT_LINE,      // Next-N-line: en cada miss trae los N bloques siguientes
+    STRIDE,         // Stride sin PC: detecta saltos constantes por flujo de direcciones
+    STREAM_BUFFER   // Stream buffers: los bloques esperan en un buffer lateral FIFO
+};
+
+const char* prefetcherKindName(PrefetcherKind kind);
+// Acepta "none", "nextline", "stride", "stream"
+bool parsePrefetcherKind(const std::string& text, PrefetcherKind& kind);
+
+// ------------------------------------------------------------
+// Interfaz común. La caché le muestra cada acceso de demanda (dirección
+// de bloque) y emite como BusRd los candidatos devueltos. Las direcciones
+// son siempre direcciones de byte alineadas al bloque.
+// ------------------------------------------------------------
+class Prefetcher {
+public:
+    Prefetcher(size_t block_size, size_t degree) : block_size_(block_size), degree_(degree) {}
+    virtual ~Prefetcher() = default;
+
+    virtual PrefetcherKind kind() const = 0;
+
+    // trigger = miss de demanda o primer uso de un bloque prefetcheado
+    virtual void observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) = 0;
+
+    // Buffer lateral (sólo STREAM_BUFFER): los prefetches no se instalan en la caché
+    virtual bool usesSideBuffer() const { return false; }
+    virtual bool takeFromBuffer(uint64_t /*block_address*/, uint8_t* /*data*/) { return false; }
+    virtual bool holdsBlock(uint64_t /*block_address*/) const { return false; }
+    virtual void fillBuffer(uint64_t /*block_address*/, const uint8_t* /*data*/) {}
+    // Un snoop invalidante debe descartar la copia del buffer
+    virtual void invalidate(uint64_t /*block_address*/) {}
+
+    // Puntualidad: accesos transcurridos entre la emisión y el primer uso
+    void noteIssued(uint64_t block_address, uint64_t now) { issued_at_[block_address] = now; }
+    uint64_t noteUsed(uint64_t block_address, uint64_t now);
+    void noteDropped(uint64_t block_address) { issued_at_.erase(block_address); }
+
+    // Bloques descartados sin uso desde la última llamada (buffers lateral)
+    uint64_t takeDropped() {
+        uint64_t dropped = dropped_;
+        dropped_ = 0;
+        return dropped;
+    }
+
+    size_t getDegree() const { return degree_; }
+
+protected:
+    size_t block_size_;
+    size_t degree_;
+    uint64_t dropped_ = 0;
+    std::unordered_map<uint64_t, uint64_t> issued_at_;
+};
+
+// Next-N-line (tagged): dispara en miss y en el primer hit sobre un bloque prefetcheado
+class NextLinePrefetcher : public Prefetcher {
+public:
+    using Prefetcher::Prefetcher;
+    PrefetcherKind kind() const override { return PrefetcherKind::NEXT_LINE; }
+    void observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) override;
+};
+
+// Stride sin PC: una tabla pequeña de flujos; cada acceso se asocia al flujo
+// cuyo último bloque está más cerca (así A[i] y B[i] intercalados se separan)
+class StridePrefetcher : public Prefetcher {
+public:
+    static constexpr size_t STREAMS = 8;
+    static constexpr int64_t WINDOW = 16;     // Distancia máxima (en bloques) para asociar a un flujo
+    static constexpr uint8_t MAX_CONFIDENCE = 3;
+
+    StridePrefetcher(size_t block_size, size_t degree);
+    PrefetcherKind kind() const override { return PrefetcherKind::STRIDE; }
+    void observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) override;
+
+private:
+    struct Stream {
+        bool valid = false;
+        int64_t last_block = 0;
+        int64_t stride = 0;
+        uint8_t confidence = 0;
+        uint64_t last_use = 0;
+    };
+    Stream streams_[STREAMS];
+    uint64_t clock_ = 0;
+};
+
+// Stream buffers: BUFFERS colas FIFO de `degree` bloques. Un miss que no
+// encuentra su bloque en ningún buffer reasigna el menos usado.
+class StreamBufferPrefetcher : public Prefetcher {
+public:
+    static constexpr size_t BUFFERS = 4;
+
+    StreamBufferPrefetcher(size_t block_size, size_t degree);
+    PrefetcherKind kind() const override { return PrefetcherKind::STREAM_BUFFER; }
+    void observe(uint64_t block_address, bool trigger, std::vector<uint64_t>& candidates) override;
+
+    bool usesSideBuffer() const override { return true; }
+    bool takeFromBuffer(uint64_t block_address, uint8_t* data) override;
+    bool holdsBlock(uint64_t block_address) const override;
+    void fillBuffer(uint64_t block_address, const uint8_t* data) override;
+    void invalidate(uint64_t block_address) override;
+
+private:
+    struct Entry {
+        uint64_t block_address;
+        bool ready;                 // Dato recibido
+        std::vector<uint8_t> data;
+    };
+    struct Buffer {
+        std::vector<Entry> entries;  // FIFO: entries[0] es la cabeza
+        uint64_t next_block = 0;     // Siguiente bloque a pedir
+        uint64_t last_use = 0;
+    };
+    Buffer buffers_[BUFFERS];
+    uint64_t clock_ = 0;
+    int refill_buffer_ = -1;        // Buffer que acaba de servir un miss
+
+    void refill(Buffer& buffer, std::vector<uint64_t>& candidates);
+};
+
+std::unique_ptr<Prefetcher> createPrefetcher(PrefetcherKind kind, size_t block_size, size_t degree);
+
+#endif // PREFETCHER_H
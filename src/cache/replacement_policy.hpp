@@ -0,0 +1,282 @@
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string>
+#include <iostream>
+#include "tag_match.hpp"  // countTrailingZeros
+
+constexpr size_t MAX_WAYS = 32;  // Soporta hasta 32-way
+
+// Políticas de reemplazo disponibles (se elige una por instancia de caché)
+enum class ReplacementKind {
+    LRU,        // LRU verdadero con contadores de edad
+    TREE_PLRU,  // Pseudo-LRU en árbol binario, O(log ways)
+    SRRIP,      // Static Re-Reference Interval Prediction (RRPV de 2 bits)
+    BRRIP,      // Bimodal RRIP: inserta casi siempre con RRPV distante
+    RANDOM      // Víctima pseudoaleatoria (xorshift)
+};
+
+inline const char* replacementKindName(ReplacementKind kind) {
+    switch (kind) {
+        case ReplacementKind::LRU:       return "LRU";
+        case ReplacementKind::TREE_PLRU: return "Tree-PLRU";
+        case ReplacementKind::SRRIP:     return "SRRIP";
+        case ReplacementKind::BRRIP:     return "BRRIP";
+        case ReplacementKind::RANDOM:    return "Random";
+        default: return "?";
+    }
+}
+
+// Acepta "lru", "plru", "srrip", "brrip", "random"
+inline bool parseReplacementKind(const std::string& text, ReplacementKind& kind) {
+    if (text == "lru")         kind = ReplacementKind::LRU;
+    else if (text == "plru")   kind = ReplacementKind::TREE_PLRU;
+    else if (text == "srrip")  kind = ReplacementKind::SRRIP;
+    else if (text == "brrip")  kind = ReplacementKind::BRRIP;
+    else if (text == "random") kind = ReplacementKind::RANDOM;
+    else return false;
+    return true;
+}
+
+// ------------------------------------------------------------
+// Interfaz común (despacho en tiempo de compilación vía plantilla):
+//   reset()             estado inicial
+//   access(way)         acierto sobre `way`
+//   insert(way)         línea nueva instalada en `way`
+//   findVictim()        víctima cuando el set está lleno (puede envejecer estado)
+//   peekVictim() const  víctima sin modificar el estado (para depuración)
+//   print() const
+// ------------------------------------------------------------
+
+// LRU verdadero: edad 0 = más reciente, Ways-1 = menos reciente
+template <size_t Ways>
+class LRUPolicy {
+    static_assert(Ways >= 1 && Ways <= MAX_WAYS, "LRUPolicy: ways fuera de rango");
+    std::array<uint8_t, Ways> age;
+
+public:
+    static constexpr ReplacementKind KIND = ReplacementKind::LRU;
+
+    LRUPolicy() { reset(); }
+
+    void reset() {
+        // Way 0 comienza como el menos recientemente usado
+        for (size_t i = 0; i < Ways; i++) {
+            age[i] = static_cast<uint8_t>(Ways - 1 - i);
+        }
+    }
+
+    void access(int way) {
+        uint8_t current = age[way];
+        for (size_t i = 0; i < Ways; i++) {
+            if (age[i] < current) {
+                age[i]++;
+            }
+        }
+        age[way] = 0;
+    }
+
+    void insert(int way) { access(way); }
+
+    int findVictim() { return peekVictim(); }
+
+    int peekVictim() const {
+        for (size_t i = 0; i < Ways; i++) {
+            if (age[i] == Ways - 1) {
+                return static_cast<int>(i);
+            }
+        }
+        return 0;
+    }
+
+    void print() const {
+        std::cout << "LRU ages:";
+        for (size_t i = 0; i < Ways; i++) {
+            std::cout << " W" << i << "=" << static_cast<int>(age[i]);
+        }
+        std::cout << std::endl;
+    }
+};
+
+// Tree-PLRU: Ways-1 bits de decisión; cada bit apunta a la mitad menos reciente
+template <size_t Ways>
+class TreePLRUPolicy {
+    static_assert(Ways >= 1 && Ways <= MAX_WAYS, "TreePLRUPolicy: ways fuera de rango");
+    static_assert((Ways & (Ways - 1)) == 0, "TreePLRUPolicy requiere ways potencia de 2");
+
+    static constexpr size_t LEVELS = (Ways <= 1) ? 0 : (Ways <= 2) ? 1 : (Ways <= 4) ? 2 :
+                                     (Ways <= 8) ? 3 : (Ways <= 16) ? 4 : 5;
+    uint32_t tree;
+
+public:
+    static constexpr ReplacementKind KIND = ReplacementKind::TREE_PLRU;
+
+    TreePLRUPolicy() { reset(); }
+
+    void reset() { tree = 0; }
+
+    void access(int way) {
+        size_t node = 0;
+        for (size_t level = 0; level < LEVELS; level++) {
+            uint32_t bit = (static_cast<uint32_t>(way) >> (LEVELS - 1 - level)) & 1u;
+            // Apuntar hacia la mitad contraria a la recién usada
+            if (bit) {
+                tree &= ~(1u << node);
+            } else {
+                tree |= (1u << node);
+            }
+            node = 2 * node + 1 + bit;
+        }
+    }
+
+    void insert(int way) { access(way); }
+
+    int findVictim() { return peekVictim(); }
+
+    int peekVictim() const {
+        size_t node = 0;
+        int way = 0;
+        for (size_t level = 0; level < LEVELS; level++) {
+            uint32_t bit = (tree >> node) & 1u;
+            way = (way << 1) | static_cast<int>(bit);
+            node = 2 * node + 1 + bit;
+        }
+        return way;
+    }
+
+    void print() const {
+        std::cout << "PLRU tree bits: 0x" << std::hex << tree << std::dec
+                  << " (victim W" << peekVictim() << ")" << std::endl;
+    }
+};
+
+// RRIP con RRPV de 2 bits guardado en dos planos de bits (lo/hi), de modo
+// que la búsqueda de víctima y el envejecimiento son operaciones de máscara
+template <size_t Ways, bool Bimodal>
+class RRIPPolicyBase {
+    static_assert(Ways >= 1 && Ways <= MAX_WAYS, "RRIPPolicy: ways fuera de rango");
+
+    static constexpr uint32_t ALL_WAYS = (Ways == 32) ? 0xFFFFFFFFu : ((1u << Ways) - 1);
+    static constexpr uint32_t BIMODAL_PERIOD = 32;  // 1 de cada 32 inserciones es "larga"
+
+    uint32_t lo;
+    uint32_t hi;
+    uint32_t insert_count;
+
+    void setRRPV(int way, uint32_t rrpv) {
+        uint32_t bit = 1u << way;
+        lo = (rrpv & 1u) ? (lo | bit) : (lo & ~bit);
+        hi = (rrpv & 2u) ? (hi | bit) : (hi & ~bit);
+    }
+
+    uint32_t rrpv(size_t way) const {
+        return ((lo >> way) & 1u) | (((hi >> way) & 1u) << 1);
+    }
+
+public:
+    RRIPPolicyBase() { reset(); }
+
+    void reset() {
+        // Todas las líneas comienzan con re-referencia distante (RRPV = 3)
+        lo = ALL_WAYS;
+        hi = ALL_WAYS;
+        insert_count = 0;
+    }
+
+    void access(int way) { setRRPV(way, 0); }
+
+    void insert(int way) {
+        if (Bimodal && (insert_count++ % BIMODAL_PERIOD) != 0) {
+            setRRPV(way, 3);
+        } else {
+            setRRPV(way, 2);
+        }
+    }
+
+    int findVictim() {
+        uint32_t distant = lo & hi & ALL_WAYS;
+        while (distant == 0) {
+            // Ningún way en RRPV=3: incrementar todos (sin saturación posible)
+            hi = (hi ^ lo) & ALL_WAYS;
+            lo = ~lo & ALL_WAYS;
+            distant = lo & hi;
+        }
+        return countTrailingZeros(distant);
+    }
+
+    int peekVictim() const {
+        // Primer way con el RRPV máximo (el mismo que elegiría findVictim)
+        uint32_t best = 0;
+        int victim = 0;
+        for (size_t i = 0; i < Ways; i++) {
+            if (rrpv(i) > best) {
+                best = rrpv(i);
+                victim = static_cast<int>(i);
+                if (best == 3) {
+                    break;
+                }
+            }
+        }
+        return victim;
+    }
+
+    void print() const {
+        std::cout << (Bimodal ? "BRRIP" : "SRRIP") << " RRPV:";
+        for (size_t i = 0; i < Ways; i++) {
+            std::cout << " W" << i << "=" << rrpv(i);
+        }
+        std::cout << std::endl;
+    }
+};
+
+template <size_t Ways>
+class SRRIPPolicy : public RRIPPolicyBase<Ways, false> {
+public:
+    static constexpr ReplacementKind KIND = ReplacementKind::SRRIP;
+};
+
+template <size_t Ways>
+class BRRIPPolicy : public RRIPPolicyBase<Ways, true> {
+public:
+    static constexpr ReplacementKind KIND = ReplacementKind::BRRIP;
+};
+
+// Reemplazo aleatorio con xorshift32 por set
+template <size_t Ways>
+class RandomPolicy {
+    static_assert(Ways >= 1 && Ways <= MAX_WAYS, "RandomPolicy: ways fuera de rango");
+    uint32_t state;
+
+    static uint32_t next(uint32_t x) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    }
+
+public:
+    static constexpr ReplacementKind KIND = ReplacementKind::RANDOM;
+
+    RandomPolicy() { reset(); }
+
+    void reset() { state = 0x9E3779B9u; }
+
+    void access(int) {}
+    void insert(int) {}
+
+    int findVictim() {
+        state = next(state);
+        return static_cast<int>(state % Ways);
+    }
+
+    int peekVictim() const { return static_cast<int>(next(state) % Ways); }
+
+    void print() const {
+        std::cout << "Random state: 0x" << std::hex << state << std::dec << std::endl;
+    }
+};
+
+#endif // REPLACEMENT_POLICY_H
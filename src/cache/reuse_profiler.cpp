@@ -0,0 +1,115 @@
+#include "reuse_profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+ReuseDistanceProfiler::ReuseDistanceProfiler(size_t initial_capacity)
+    : initial_capacity_(initial_capacity), tree_(initial_capacity + 1, 0),
+      now_(0), accesses_(0), cold_(0) {
+    if (initial_capacity == 0) {
+        throw std::invalid_argument("ReuseDistanceProfiler: la capacidad inicial debe ser > 0");
+    }
+}
+
+void ReuseDistanceProfiler::add(uint64_t time, int delta) {
+    for (size_t i = time + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += delta;
+    }
+}
+
+uint64_t ReuseDistanceProfiler::marksBefore(uint64_t time) const {
+    uint64_t sum = 0;
+    for (size_t i = time; i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+void ReuseDistanceProfiler::compact() {
+    // Renumerar las marcas vivas 0..k-1 conservando su orden
+    std::vector<std::pair<uint64_t, uint64_t>> marks;
+    marks.reserve(last_access_.size());
+    for (const auto& entry : last_access_) {
+        marks.emplace_back(entry.second, entry.first);
+    }
+    std::sort(marks.begin(), marks.end());
+    
+    size_t capacity = std::max(initial_capacity_, 2 * marks.size());
+    tree_.assign(capacity + 1, 0);
+    for (size_t time = 0; time < marks.size(); time++) {
+        last_access_[marks[time].second] = time;
+        tree_[time + 1] = 1;
+    }
+    // Construcción lineal: cada nodo suma el suyo al padre
+    for (size_t i = 1; i < tree_.size(); i++) {
+        size_t parent = i + (i & (~i + 1));
+        if (parent < tree_.size()) {
+            tree_[parent] += tree_[i];
+        }
+    }
+    now_ = marks.size();
+}
+
+uint64_t ReuseDistanceProfiler::access(uint64_t block_address) {
+    if (now_ + 1 >= tree_.size()) {
+        compact();
+    }
+    accesses_++;
+    
+    uint64_t distance = COLD;
+    auto it = last_access_.find(block_address);
+    if (it != last_access_.end()) {
+        // Bloques distintos desde el uso anterior = marcas posteriores a él
+        distance = last_access_.size() - marksBefore(it->second + 1);
+        add(it->second, -1);
+        it->second = now_;
+        if (distance >= histogram_.size()) {
+            histogram_.resize(distance + 1, 0);
+        }
+        histogram_[distance]++;
+    } else {
+        cold_++;
+        last_access_.emplace(block_address, now_);
+    }
+    add(now_, +1);
+    now_++;
+    return distance;
+}
+
+uint64_t ReuseDistanceProfiler::predictedHits(size_t blocks) const {
+    uint64_t hits = 0;
+    for (size_t d = 0; d < blocks && d < histogram_.size(); d++) {
+        hits += histogram_[d];
+    }
+    return hits;
+}
+
+double ReuseDistanceProfiler::predictedHitRate(size_t blocks) const {
+    return accesses_ ? static_cast<double>(predictedHits(blocks)) / accesses_ : 0.0;
+}
+
+void ReuseDistanceProfiler::printCurve(size_t block_size) const {
+    std::cout << "Reuse distance: " << accesses_ << " accesos, " << getDistinctBlocks()
+              << " bloques distintos, " << cold_ << " fríos" << std::endl;
+    if (accesses_ == 0) {
+        return;
+    }
+    std::cout << std::setw(10) << "Bloques" << std::setw(10) << "Bytes" << std::setw(12) << "Hit rate" << std::endl;
+    
+    // Con capacidad >= histograma la curva ya no sube
+    uint64_t hits = 0;
+    size_t d = 0;
+    for (size_t blocks = 1; ; blocks *= 2) {
+        for (; d < blocks && d < histogram_.size(); d++) {
+            hits += histogram_[d];
+        }
+        std::cout << std::setw(10) << blocks << std::setw(10) << blocks * block_size
+                  << std::setw(11) << std::fixed << std::setprecision(2)
+                  << 100.0 * hits / accesses_ << "%" << std::endl;
+        if (blocks >= histogram_.size()) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef REUSE_PROFILER_H
+#define REUSE_PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------
+// Perfil de distancia de reúso (pila de Mattson) de una caché. La
+// distancia de un acceso es el número de bloques distintos tocados desde
+// el uso anterior del mismo bloque; una caché totalmente asociativa LRU
+// de C bloques acierta exactamente los accesos con distancia < C, así que
+// un solo recorrido da la tasa de aciertos para todos los tamaños.
+//
+// Cada bloque deja una marca en el instante de su último acceso; las
+// marcas viven en un árbol de Fenwick y contar las posteriores a un
+// instante cuesta O(log n). Cuando se acaban los instantes se renumeran
+// las marcas vivas, así la memoria depende de los bloques distintos y no
+// del largo de la traza.
+// ------------------------------------------------------------
+class ReuseDistanceProfiler {
+public:
+    static constexpr uint64_t COLD = std::numeric_limits<uint64_t>::max();
+    
+    explicit ReuseDistanceProfiler(size_t initial_capacity = 1024);
+    
+    // Registra un acceso (dirección de bloque) y devuelve su distancia o COLD
+    uint64_t access(uint64_t block_address);
+    
+    uint64_t getAccesses() const { return accesses_; }
+    uint64_t getColdAccesses() const { return cold_; }
+    size_t getDistinctBlocks() const { return last_access_.size(); }
+    // histogram[d] = accesos con distancia d
+    const std::vector<uint64_t>& getHistogram() const { return histogram_; }
+    
+    // Aciertos de una caché totalmente asociativa LRU de `blocks` bloques
+    uint64_t predictedHits(size_t blocks) const;
+    double predictedHitRate(size_t blocks) const;
+    
+    // Curva de tasa de aciertos para capacidades potencia de 2
+    void printCurve(size_t block_size) const;
+    
+private:
+    size_t initial_capacity_;
+    std::vector<uint32_t> tree_;   // Fenwick, índices desde 1
+    uint64_t now_;                 // Próximo instante libre
+    std::unordered_map<uint64_t, uint64_t> last_access_;
+    std::vector<uint64_t> histogram_;
+    uint64_t accesses_;
+    uint64_t cold_;
+    
+    void add(uint64_t time, int delta);
+    uint64_t marksBefore(uint64_t time) const;   // Marcas en [0, time)
+    void compact();
+};
+
+#endif // REUSE_PROFILER_H
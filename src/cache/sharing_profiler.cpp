@@ -0,0 +1,239 @@
+#include "sharing_profiler.hpp"
+#include <algorithm>
+#include <bitset>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+const char* sharingPatternName(SharingPattern pattern) {
+    switch (pattern) {
+        case SharingPattern::PRIVATE:      return "private";
+        case SharingPattern::READ_SHARED:  return "read-shared";
+        case SharingPattern::MIGRATORY:    return "migratory";
+        case SharingPattern::TRUE_SHARED:  return "true-shared";
+        case SharingPattern::FALSE_SHARED: return "falsely-shared";
+        default: return "?";
+    }
+}
+
+static size_t popcount(uint64_t mask) {
+    return std::bitset<64>(mask).count();
+}
+
+SharingProfiler::SharingProfiler(size_t block_size)
+    : block_size_(block_size), words_per_block_(block_size / sizeof(uint64_t)) {
+    if (words_per_block_ == 0) {
+        throw std::invalid_argument("SharingProfiler: el bloque debe contener al menos una palabra");
+    }
+}
+
+void SharingProfiler::noteAccess(int pe_id, uint64_t address, bool is_write) {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= MAX_PES) {
+        throw std::out_of_range("SharingProfiler: PE id fuera de rango");
+    }
+    BlockProfile& profile = blocks_[address / block_size_];
+    if (profile.word_readers.empty()) {
+        profile.word_readers.assign(words_per_block_, 0);
+        profile.word_writers.assign(words_per_block_, 0);
+    }
+    
+    uint64_t pe_bit = 1ull << pe_id;
+    size_t word = (address % block_size_) / sizeof(uint64_t);
+    if (is_write) {
+        profile.writes++;
+        profile.word_writers[word] |= pe_bit;
+    } else {
+        profile.reads++;
+        profile.word_readers[word] |= pe_bit;
+    }
+    
+    if (profile.invalidated & pe_bit) {
+        profile.coherence_misses++;
+        profile.invalidated &= ~pe_bit;
+    }
+    
+    // Una racha nueva empieza cuando el bloque cambia de PE; es migratoria
+    // si llega por una lectura y el mismo PE lo escribe antes de soltarlo
+    if (pe_id != profile.last_pe) {
+        profile.runs++;
+        profile.last_pe = pe_id;
+        profile.run_starts_with_read = !is_write;
+        profile.run_migrated = false;
+    }
+    if (is_write && profile.run_starts_with_read && !profile.run_migrated && profile.runs > 1) {
+        profile.migratory_runs++;
+        profile.run_migrated = true;
+    }
+}
+
+void SharingProfiler::noteInvalidation(int pe_id, uint64_t address) {
+    auto it = blocks_.find(address / block_size_);
+    if (it == blocks_.end() || pe_id < 0 || static_cast<size_t>(pe_id) >= MAX_PES) {
+        return;
+    }
+    it->second.invalidations++;
+    it->second.invalidated |= 1ull << pe_id;
+}
+
+void SharingProfiler::noteBackInvalidation(int pe_id, uint64_t address) {
+    auto it = blocks_.find(address / block_size_);
+    if (it == blocks_.end() || pe_id < 0 || static_cast<size_t>(pe_id) >= MAX_PES) {
+        return;
+    }
+    it->second.invalidated &= ~(1ull << pe_id);
+}
+
+SharingPattern SharingProfiler::classify(const BlockProfile& profile) const {
+    uint64_t readers = 0;
+    uint64_t writers = 0;
+    bool communicates = false;
+    for (size_t word = 0; word < words_per_block_; word++) {
+        readers |= profile.word_readers[word];
+        writers |= profile.word_writers[word];
+        // Una palabra escrita que tocan dos o más PEs lleva datos entre ellos
+        if (profile.word_writers[word] != 0 &&
+            popcount(profile.word_readers[word] | profile.word_writers[word]) > 1) {
+            communicates = true;
+        }
+    }
+    
+    if (popcount(readers | writers) <= 1) {
+        return SharingPattern::PRIVATE;
+    }
+    if (writers == 0) {
+        return SharingPattern::READ_SHARED;
+    }
+    if (!communicates) {
+        return SharingPattern::FALSE_SHARED;
+    }
+    // Migratorio: la mayoría de los traspasos son leer-y-escribir
+    uint64_t handoffs = profile.runs - 1;
+    if (profile.migratory_runs > 0 && profile.migratory_runs * 2 >= handoffs) {
+        return SharingPattern::MIGRATORY;
+    }
+    return SharingPattern::TRUE_SHARED;
+}
+
+BlockSharingReport SharingProfiler::makeReport(uint64_t block_number, const BlockProfile& profile) const {
+    BlockSharingReport report;
+    report.block_address = block_number * block_size_;
+    report.pattern = classify(profile);
+    report.reads = profile.reads;
+    report.writes = profile.writes;
+    report.invalidations = profile.invalidations;
+    report.coherence_misses = profile.coherence_misses;
+    report.word_readers = profile.word_readers;
+    report.word_writers = profile.word_writers;
+    for (size_t word = 0; word < words_per_block_; word++) {
+        report.readers |= profile.word_readers[word];
+        report.writers |= profile.word_writers[word];
+    }
+    return report;
+}
+
+BlockSharingReport SharingProfiler::getBlock(uint64_t address) const {
+    uint64_t block_number = address / block_size_;
+    auto it = blocks_.find(block_number);
+    if (it == blocks_.end()) {
+        throw std::out_of_range("SharingProfiler: bloque sin accesos");
+    }
+    return makeReport(block_number, it->second);
+}
+
+std::vector<BlockSharingReport> SharingProfiler::ranked() const {
+    std::vector<BlockSharingReport> reports;
+    reports.reserve(blocks_.size());
+    for (const auto& [block_number, profile] : blocks_) {
+        reports.push_back(makeReport(block_number, profile));
+    }
+    std::sort(reports.begin(), reports.end(), [](const BlockSharingReport& a, const BlockSharingReport& b) {
+        if (a.invalidations != b.invalidations) return a.invalidations > b.invalidations;
+        if (a.coherence_misses != b.coherence_misses) return a.coherence_misses > b.coherence_misses;
+        if (a.reads + a.writes != b.reads + b.writes) return a.reads + a.writes > b.reads + b.writes;
+        return a.block_address < b.block_address;
+    });
+    return reports;
+}
+
+uint64_t SharingProfiler::getPatternCount(SharingPattern pattern) const {
+    uint64_t count = 0;
+    for (const auto& entry : blocks_) {
+        if (classify(entry.second) == pattern) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// "0,2,3" a partir de una máscara de PEs
+static std::string peList(uint64_t mask) {
+    std::ostringstream out;
+    bool first = true;
+    for (size_t pe = 0; pe < SharingProfiler::MAX_PES; pe++) {
+        if (mask & (1ull << pe)) {
+            out << (first ? "" : ",") << pe;
+            first = false;
+        }
+    }
+    return first ? "-" : out.str();
+}
+
+void SharingProfiler::printReport(size_t top) const {
+    std::vector<BlockSharingReport> reports = ranked();
+    uint64_t counts[NUM_SHARING_PATTERNS] = {};
+    for (const BlockSharingReport& report : reports) {
+        counts[static_cast<size_t>(report.pattern)]++;
+    }
+    
+    std::cout << "\n=== Sharing Report (" << reports.size() << " bloques) ===" << std::endl;
+    for (size_t p = 0; p < NUM_SHARING_PATTERNS; p++) {
+        std::cout << (p == 0 ? "" : "  ") << sharingPatternName(static_cast<SharingPattern>(p))
+                  << "=" << counts[p];
+    }
+    std::cout << std::endl;
+    
+    // Por palabra: PEs que la escribieron (W) y los que sólo la leyeron (R)
+    size_t shown = 0;
+    for (const BlockSharingReport& report : reports) {
+        if (shown == top) {
+            break;
+        }
+        if (report.pattern == SharingPattern::PRIVATE && report.invalidations == 0) {
+            continue;
+        }
+        if (shown == 0) {
+            std::cout << std::left << std::setw(4) << "#" << std::setw(10) << "Bloque"
+                      << std::setw(16) << "Patrón" << std::right << std::setw(7) << "Inval"
+                      << std::setw(10) << "CohMiss" << std::setw(9) << "Lect" << std::setw(9) << "Escr"
+                      << "  Escritores  Palabras" << std::endl;
+        }
+        shown++;
+        std::ostringstream address;
+        address << "0x" << std::hex << report.block_address;
+        std::cout << std::left << std::setw(4) << shown << std::setw(10) << address.str()
+                  << std::setw(16) << sharingPatternName(report.pattern) << std::right
+                  << std::setw(7) << report.invalidations << std::setw(10) << report.coherence_misses
+                  << std::setw(9) << report.reads << std::setw(9) << report.writes
+                  << "  " << std::left << std::setw(11) << peList(report.writers) << std::right;
+        for (size_t word = 0; word < report.word_writers.size(); word++) {
+            uint64_t writers = report.word_writers[word];
+            uint64_t readers = report.word_readers[word] & ~writers;
+            std::cout << " w" << word << "=";
+            if (writers != 0) {
+                std::cout << "W" << peList(writers);
+            }
+            if (readers != 0) {
+                std::cout << (writers != 0 ? ":" : "") << "R" << peList(readers);
+            }
+            if ((writers | readers) == 0) {
+                std::cout << ".";
+            }
+        }
+        std::cout << std::endl;
+    }
+    if (shown == 0) {
+        std::cout << "Sin bloques compartidos." << std::endl;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef SHARING_PROFILER_H
+#define SHARING_PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Patrón de compartición de un bloque según los accesos a nivel de palabra
+enum class SharingPattern {
+    PRIVATE,        // Un solo PE accede al bloque
+    READ_SHARED,    // Varios PEs, nadie escribe
+    MIGRATORY,      // Palabras compartidas que pasan de PE en PE (leer y luego escribir)
+    TRUE_SHARED,    // Varios PEs leen/escriben las mismas palabras
+    FALSE_SHARED    // Varios PEs, pero ninguna palabra escrita la toca más de uno
+};
+
+constexpr size_t NUM_SHARING_PATTERNS = 5;
+
+const char* sharingPatternName(SharingPattern pattern);
+
+// Resumen de un bloque para el reporte
+struct BlockSharingReport {
+    uint64_t block_address = 0;
+    SharingPattern pattern = SharingPattern::PRIVATE;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t invalidations = 0;       // Copias invalidadas por snoops/directorio
+    uint64_t coherence_misses = 0;    // Accesos de un PE que había perdido la copia
+    uint64_t readers = 0;             // Máscara de PEs
+    uint64_t writers = 0;
+    std::vector<uint64_t> word_readers;   // Por palabra, máscara de PEs
+    std::vector<uint64_t> word_writers;
+};
+
+// ------------------------------------------------------------
+// Perfil de compartición. Lo comparten todas las L1 (ver
+// ICache::setSharingProfiler): cada acceso de demanda y cada invalidación
+// de coherencia se anotan por bloque y por palabra. No es thread-safe; en
+// el simulador, con el perfil activo, ningún acceso es hit local
+// (ICache::hitsLocally) y todos se serializan con el lock del bus.
+// ------------------------------------------------------------
+class SharingProfiler {
+public:
+    static constexpr size_t MAX_PES = 64;
+    
+    explicit SharingProfiler(size_t block_size);
+    
+    void noteAccess(int pe_id, uint64_t address, bool is_write);
+    void noteInvalidation(int pe_id, uint64_t address);
+    // La L2 inclusiva sacó la copia del PE: no es una invalidación de
+    // coherencia y su próximo acceso no cuenta como fallo de coherencia
+    void noteBackInvalidation(int pe_id, uint64_t address);
+    
+    // Lanza std::out_of_range si el bloque nunca se accedió
+    BlockSharingReport getBlock(uint64_t address) const;
+    // Bloques ordenados de peor a mejor: invalidaciones, fallos de coherencia, accesos
+    std::vector<BlockSharingReport> ranked() const;
+    size_t getBlockCount() const { return blocks_.size(); }
+    uint64_t getPatternCount(SharingPattern pattern) const;
+    
+    // Resumen por patrón y los `top` bloques compartidos más costosos
+    void printReport(size_t top = 10) const;
+    
+private:
+    struct BlockProfile {
+        std::vector<uint64_t> word_readers;
+        std::vector<uint64_t> word_writers;
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t invalidations = 0;
+        uint64_t coherence_misses = 0;
+        uint64_t invalidated = 0;      // PEs que perdieron la copia y aún no volvieron
+        // Rachas de accesos consecutivos de un mismo PE
+        int last_pe = -1;
+        bool run_starts_with_read = false;
+        bool run_migrated = false;
+        uint64_t runs = 0;
+        uint64_t migratory_runs = 0;   // Rachas que recibieron el bloque, lo leyeron y lo escribieron
+    };
+    
+    size_t block_size_;
+    size_t words_per_block_;
+    std::unordered_map<uint64_t, BlockProfile> blocks_;
+    
+    SharingPattern classify(const BlockProfile& profile) const;
+    BlockSharingReport makeReport(uint64_t block_address, const BlockProfile& profile) const;
+};
+
+#endif // SHARING_PROFILER_H
@@ -0,0 +1,68 @@
+#ifndef TAG_MATCH_H
+#define TAG_MATCH_H
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Comparación de tags de todos los ways de un set en paralelo.
+// Devuelve una máscara con el bit i encendido si tags[i] == tag.
+// Ruta AVX2 (4 tags por instrucción), SSE4.1/SSE2 (2 tags) o escalar.
+
+inline int countTrailingZeros(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int n = 0;
+    while ((mask & 1u) == 0) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+template <size_t Ways>
+inline uint32_t matchTags(const uint64_t* tags, uint64_t tag) {
+    static_assert(Ways <= 32, "La máscara de coincidencia soporta hasta 32 ways");
+    uint32_t mask = 0;
+    size_t way = 0;
+
+#if defined(__AVX2__)
+    const __m256i key4 = _mm256_set1_epi64x(static_cast<long long>(tag));
+    for (; way + 4 <= Ways; way += 4) {
+        __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + way));
+        __m256i eq = _mm256_cmpeq_epi64(t, key4);
+        mask |= static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))) << way;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i key2 = _mm_set1_epi64x(static_cast<long long>(tag));
+    for (; way + 2 <= Ways; way += 2) {
+        __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + way));
+#if defined(__SSE4_1__)
+        __m128i eq = _mm_cmpeq_epi64(t, key2);
+#else
+        // SSE2 no tiene comparación de 64 bits: comparar mitades de 32 bits
+        // y exigir que ambas mitades coincidan
+        __m128i eq32 = _mm_cmpeq_epi32(t, key2);
+        __m128i eq = _mm_and_si128(eq32, _mm_shuffle_epi32(eq32, _MM_SHUFFLE(2, 3, 0, 1)));
+#endif
+        mask |= static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(eq))) << way;
+    }
+#endif
+
+    // Fallback escalar (y ways sobrantes)
+    for (; way < Ways; way++) {
+        if (tags[way] == tag) {
+            mask |= 1u << way;
+        }
+    }
+    return mask;
+}
+
+#endif // TAG_MATCH_H
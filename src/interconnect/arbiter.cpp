@@ -0,0 +1,173 @@
+#include "arbiter.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+const char* arbitrationPolicyName(ArbitrationPolicy policy) {
+    switch (policy) {
+        case ArbitrationPolicy::ROUND_ROBIN:    return "round-robin";
+        case ArbitrationPolicy::FIXED_PRIORITY: return "fixed-priority";
+        case ArbitrationPolicy::OLDEST_FIRST:   return "oldest-first";
+        case ArbitrationPolicy::WEIGHTED_FAIR:  return "weighted-fair";
+        case ArbitrationPolicy::LOTTERY:        return "lottery";
+        default: return "?";
+    }
+}
+
+bool parseArbitrationPolicy(const std::string& text, ArbitrationPolicy& policy) {
+    if (text == "rr")           policy = ArbitrationPolicy::ROUND_ROBIN;
+    else if (text == "fixed")   policy = ArbitrationPolicy::FIXED_PRIORITY;
+    else if (text == "oldest")  policy = ArbitrationPolicy::OLDEST_FIRST;
+    else if (text == "wfq")     policy = ArbitrationPolicy::WEIGHTED_FAIR;
+    else if (text == "lottery") policy = ArbitrationPolicy::LOTTERY;
+    else return false;
+    return true;
+}
+
+// ============================================================
+// ESTADÍSTICAS DE ESPERA
+// ============================================================
+
+size_t PEWaitStats::bucket(uint64_t wait) {
+    if (wait == 0) {
+        return 0;
+    }
+    size_t bits = 64 - static_cast<size_t>(__builtin_clzll(wait));
+    return std::min(bits, BUCKETS - 1);
+}
+
+std::string PEWaitStats::bucketLabel(size_t bucket) {
+    if (bucket == 0) {
+        return "0";
+    }
+    uint64_t low = 1ull << (bucket - 1);
+    if (bucket == BUCKETS - 1) {
+        return ">=" + std::to_string(low);
+    }
+    if (bucket == 1) {
+        return "1";
+    }
+    return std::to_string(low) + "-" + std::to_string(2 * low - 1);
+}
+
+void PEWaitStats::record(uint64_t wait) {
+    grants++;
+    total_wait += wait;
+    max_wait = std::max(max_wait, wait);
+    histogram[bucket(wait)]++;
+}
+
+// ============================================================
+// POLÍTICAS
+// ============================================================
+
+namespace {
+
+size_t weightOf(const std::vector<size_t>& weights, size_t pe) {
+    return pe < weights.size() ? weights[pe] : 1;
+}
+
+}
+
+size_t RoundRobinArbiter::choose(const std::vector<ArbiterRequest>& candidates) {
+    // El primero desde el turno actual; si no hay, se da la vuelta
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (candidates[i].pe >= turn_) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+size_t FixedPriorityArbiter::choose(const std::vector<ArbiterRequest>& candidates) {
+    if (priorities_.empty()) {
+        return 0;  // Id más bajo
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < candidates.size(); i++) {
+        if (weightOf(priorities_, candidates[i].pe) > weightOf(priorities_, candidates[best].pe)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+size_t OldestFirstArbiter::choose(const std::vector<ArbiterRequest>& candidates) {
+    size_t best = 0;
+    for (size_t i = 1; i < candidates.size(); i++) {
+        if (candidates[i].head->arrival_cycle < candidates[best].head->arrival_cycle) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+WeightedFairArbiter::WeightedFairArbiter(const std::vector<size_t>& weights, size_t num_pes)
+    : cost_(num_pes), finish_(num_pes, 0.0) {
+    for (size_t pe = 0; pe < num_pes; pe++) {
+        cost_[pe] = 1.0 / static_cast<double>(weightOf(weights, pe));
+    }
+}
+
+// Un PE que estuvo inactivo no acumula crédito: arranca desde el tiempo virtual
+double WeightedFairArbiter::tag(size_t pe) const {
+    return std::max(virtual_time_, finish_[pe]);
+}
+
+size_t WeightedFairArbiter::choose(const std::vector<ArbiterRequest>& candidates) {
+    size_t best = 0;
+    for (size_t i = 1; i < candidates.size(); i++) {
+        if (tag(candidates[i].pe) < tag(candidates[best].pe)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void WeightedFairArbiter::granted(size_t pe) {
+    virtual_time_ = tag(pe);
+    finish_[pe] = virtual_time_ + cost_[pe];
+}
+
+LotteryArbiter::LotteryArbiter(const std::vector<size_t>& tickets, size_t num_pes, uint32_t seed)
+    : tickets_(num_pes), rng_(seed) {
+    for (size_t pe = 0; pe < num_pes; pe++) {
+        tickets_[pe] = weightOf(tickets, pe);
+    }
+}
+
+size_t LotteryArbiter::choose(const std::vector<ArbiterRequest>& candidates) {
+    uint64_t total = 0;
+    for (const ArbiterRequest& candidate : candidates) {
+        total += tickets_[candidate.pe];
+    }
+    uint64_t draw = std::uniform_int_distribution<uint64_t>(0, total - 1)(rng_);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (draw < tickets_[candidates[i].pe]) {
+            return i;
+        }
+        draw -= tickets_[candidates[i].pe];
+    }
+    return candidates.size() - 1;
+}
+
+std::unique_ptr<Arbiter> createArbiter(const ArbitrationConfig& config, size_t num_pes) {
+    bool weighted = config.policy == ArbitrationPolicy::WEIGHTED_FAIR ||
+                    config.policy == ArbitrationPolicy::LOTTERY;
+    if (weighted && std::find(config.weights.begin(), config.weights.end(), 0) != config.weights.end()) {
+        throw std::invalid_argument(std::string("Arbiter: ") + arbitrationPolicyName(config.policy)
+                                    + " necesita pesos mayores que cero");
+    }
+    switch (config.policy) {
+        case ArbitrationPolicy::FIXED_PRIORITY:
+            return std::make_unique<FixedPriorityArbiter>(config.weights);
+        case ArbitrationPolicy::OLDEST_FIRST:
+            return std::make_unique<OldestFirstArbiter>();
+        case ArbitrationPolicy::WEIGHTED_FAIR:
+            return std::make_unique<WeightedFairArbiter>(config.weights, num_pes);
+        case ArbitrationPolicy::LOTTERY:
+            return std::make_unique<LotteryArbiter>(config.weights, num_pes, config.seed);
+        case ArbitrationPolicy::ROUND_ROBIN:
+        default:
+            return std::make_unique<RoundRobinArbiter>(num_pes);
+    }
+}
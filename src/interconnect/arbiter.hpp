@@ -0,0 +1,141 @@
+#ifndef ARBITER_HPP
+#define ARBITER_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "../bus/bus.hpp"
+
+// Políticas de arbitraje del bus
+enum class ArbitrationPolicy {
+    ROUND_ROBIN,     // Turno rotativo a partir del último ganador
+    FIXED_PRIORITY,  // Siempre gana el PE de mayor prioridad
+    OLDEST_FIRST,    // La solicitud que lleva más tiempo en cola
+    WEIGHTED_FAIR,   // WFQ: ancho de banda proporcional al peso
+    LOTTERY          // Sorteo con tickets proporcionales al peso
+};
+
+const char* arbitrationPolicyName(ArbitrationPolicy policy);
+// Acepta "rr", "fixed", "oldest", "wfq", "lottery"
+bool parseArbitrationPolicy(const std::string& text, ArbitrationPolicy& policy);
+
+struct ArbitrationConfig {
+    ArbitrationPolicy policy = ArbitrationPolicy::ROUND_ROBIN;
+    // Por PE: prioridad (FIXED_PRIORITY, mayor gana), peso (WEIGHTED_FAIR) o
+    // tickets (LOTTERY). Los PEs sin valor usan 1; sin valores, FIXED_PRIORITY
+    // da prioridad al PE de id más bajo.
+    std::vector<size_t> weights;
+    // Los BusWB van en una cola propia de menor prioridad que las lecturas
+    // de demanda; uno que espera writeback_max_wait ciclos pasa delante
+    bool separate_writebacks = false;
+    uint64_t writeback_max_wait = 64;
+    uint32_t seed = 1;  // LOTTERY
+};
+
+// Solicitud candidata: la primera de la cola de un PE
+struct ArbiterRequest {
+    size_t pe;
+    const BusTransaction* head;
+};
+
+// Espera de las solicitudes de un PE, en ciclos del bus (o en turnos de
+// arbitraje cuando el bus no tiene modelo de tiempo), desde que entran a su
+// ring hasta que ganan el bus. Un miss no completa antes de que se entregue
+// su transacción, que es posterior al grant: el orden de arbitraje decide
+// qué PE sigue primero y esta espera es parte de la que sufre el PE.
+struct PEWaitStats {
+    static constexpr size_t BUCKETS = 12;  // 0, 1, 2-3, 4-7, ..., >=1024
+
+    uint64_t grants = 0;
+    uint64_t total_wait = 0;
+    uint64_t max_wait = 0;  // Peor inanición observada
+    std::array<uint64_t, BUCKETS> histogram{};
+
+    void record(uint64_t wait);
+    static size_t bucket(uint64_t wait);
+    static std::string bucketLabel(size_t bucket);
+};
+
+// ------------------------------------------------------------
+// Elige entre los PEs con solicitudes pendientes. choose recibe los
+// candidatos en orden creciente de PE (nunca vacío) y devuelve el índice
+// del ganador; granted se llama a continuación con ese PE.
+// ------------------------------------------------------------
+class Arbiter {
+public:
+    virtual ~Arbiter() = default;
+
+    virtual ArbitrationPolicy policy() const = 0;
+    virtual size_t choose(const std::vector<ArbiterRequest>& candidates) = 0;
+    virtual void granted(size_t pe) { (void)pe; }
+};
+
+class RoundRobinArbiter : public Arbiter {
+public:
+    explicit RoundRobinArbiter(size_t num_pes) : num_pes_(num_pes) {}
+
+    ArbitrationPolicy policy() const override { return ArbitrationPolicy::ROUND_ROBIN; }
+    size_t choose(const std::vector<ArbiterRequest>& candidates) override;
+    void granted(size_t pe) override { turn_ = (pe + 1) % num_pes_; }
+
+private:
+    size_t num_pes_;
+    size_t turn_ = 0;
+};
+
+class FixedPriorityArbiter : public Arbiter {
+public:
+    explicit FixedPriorityArbiter(const std::vector<size_t>& priorities) : priorities_(priorities) {}
+
+    ArbitrationPolicy policy() const override { return ArbitrationPolicy::FIXED_PRIORITY; }
+    size_t choose(const std::vector<ArbiterRequest>& candidates) override;
+
+private:
+    std::vector<size_t> priorities_;
+};
+
+class OldestFirstArbiter : public Arbiter {
+public:
+    ArbitrationPolicy policy() const override { return ArbitrationPolicy::OLDEST_FIRST; }
+    size_t choose(const std::vector<ArbiterRequest>& candidates) override;
+};
+
+// Start-time fair queuing: gana la menor etiqueta de inicio
+// max(tiempo virtual, fin de la concesión anterior del PE) y cada
+// concesión avanza el fin del PE en 1/peso
+class WeightedFairArbiter : public Arbiter {
+public:
+    WeightedFairArbiter(const std::vector<size_t>& weights, size_t num_pes);
+
+    ArbitrationPolicy policy() const override { return ArbitrationPolicy::WEIGHTED_FAIR; }
+    size_t choose(const std::vector<ArbiterRequest>& candidates) override;
+    void granted(size_t pe) override;
+
+private:
+    std::vector<double> cost_;    // 1/peso por PE
+    std::vector<double> finish_;  // Etiqueta de la última concesión de cada PE
+    double virtual_time_ = 0.0;
+
+    double tag(size_t pe) const;
+};
+
+class LotteryArbiter : public Arbiter {
+public:
+    LotteryArbiter(const std::vector<size_t>& tickets, size_t num_pes, uint32_t seed);
+
+    ArbitrationPolicy policy() const override { return ArbitrationPolicy::LOTTERY; }
+    size_t choose(const std::vector<ArbiterRequest>& candidates) override;
+
+private:
+    std::vector<size_t> tickets_;
+    std::mt19937 rng_;
+};
+
+// Lanza std::invalid_argument si WEIGHTED_FAIR o LOTTERY reciben un peso cero
+std::unique_ptr<Arbiter> createArbiter(const ArbitrationConfig& config, size_t num_pes);
+
+#endif // ARBITER_HPP
@@ -0,0 +1,310 @@
+#include "directory.hpp"
+#include "../Trace/Trace.hpp"
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+const char* sharerEncodingName(SharerEncoding encoding) {
+    switch (encoding) {
+        case SharerEncoding::FULL_VECTOR:      return "full-vector";
+        case SharerEncoding::LIMITED_POINTERS: return "limited-pointers";
+        case SharerEncoding::COARSE_VECTOR:    return "coarse-vector";
+        default: return "?";
+    }
+}
+
+bool parseSharerEncoding(const std::string& text, SharerEncoding& encoding) {
+    if (text == "full")         encoding = SharerEncoding::FULL_VECTOR;
+    else if (text == "limited") encoding = SharerEncoding::LIMITED_POINTERS;
+    else if (text == "coarse")  encoding = SharerEncoding::COARSE_VECTOR;
+    else return false;
+    return true;
+}
+
+Directory::Directory(const DirectoryConfig& config) : config_(config) {
+    if (config_.pointers == 0 || config_.pointers > MAX_POINTERS) {
+        throw std::invalid_argument("Directory: pointers debe estar entre 1 y " + std::to_string(MAX_POINTERS));
+    }
+    if (config_.group_size == 0) {
+        throw std::invalid_argument("Directory: group_size debe ser > 0");
+    }
+}
+
+void Directory::registerCache(ICache* cache) {
+    if (cache == nullptr) {
+        return;
+    }
+    int pe_id = cache->getPEId();
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= MAX_CACHES) {
+        throw std::out_of_range("Directory: PE id fuera de rango (máximo " + std::to_string(MAX_CACHES) + " cachés)");
+    }
+    if (registeredCaches() == 0) {
+        block_size_ = cache->getGeometry().block_size;
+    }
+    if (static_cast<size_t>(pe_id) >= caches_.size()) {
+        caches_.resize(pe_id + 1, nullptr);
+    }
+    caches_[pe_id] = cache;
+}
+
+size_t Directory::registeredCaches() const {
+    size_t count = 0;
+    for (ICache* cache : caches_) {
+        if (cache != nullptr) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ============================================================
+// CONJUNTO DE SHARERS
+// ============================================================
+
+void Directory::addSharer(Entry& entry, int pe_id) {
+    switch (config_.encoding) {
+        case SharerEncoding::FULL_VECTOR:
+            entry.bits.set(pe_id);
+            break;
+        case SharerEncoding::COARSE_VECTOR:
+            entry.bits.set(pe_id / config_.group_size);
+            break;
+        case SharerEncoding::LIMITED_POINTERS:
+            if (entry.overflow) {
+                break;
+            }
+            for (size_t i = 0; i < entry.pointer_count; i++) {
+                if (entry.pointers[i] == pe_id) {
+                    return;
+                }
+            }
+            if (entry.pointer_count < config_.pointers) {
+                entry.pointers[entry.pointer_count++] = static_cast<int16_t>(pe_id);
+            } else {
+                entry.overflow = true;
+            }
+            break;
+    }
+}
+
+void Directory::removeSharer(Entry& entry, int pe_id) {
+    switch (config_.encoding) {
+        case SharerEncoding::FULL_VECTOR:
+            entry.bits.reset(pe_id);
+            break;
+        case SharerEncoding::COARSE_VECTOR:
+            // El bit es de todo el grupo: sólo se limpia al invalidar el bloque
+            break;
+        case SharerEncoding::LIMITED_POINTERS:
+            for (size_t i = 0; i < entry.pointer_count; i++) {
+                if (entry.pointers[i] == pe_id) {
+                    entry.pointers[i] = entry.pointers[--entry.pointer_count];
+                    break;
+                }
+            }
+            break;
+    }
+}
+
+bool Directory::hasSharers(const Entry& entry) const {
+    return entry.bits.any() || entry.pointer_count != 0 || entry.overflow;
+}
+
+void Directory::collectTargets(const Entry& entry, int exclude, std::vector<int>& targets) const {
+    targets.clear();
+    auto add = [&](size_t pe_id) {
+        if (pe_id < caches_.size() && caches_[pe_id] != nullptr && static_cast<int>(pe_id) != exclude) {
+            targets.push_back(static_cast<int>(pe_id));
+        }
+    };
+    
+    if (config_.encoding == SharerEncoding::LIMITED_POINTERS && entry.overflow) {
+        for (size_t pe_id = 0; pe_id < caches_.size(); pe_id++) {
+            add(pe_id);
+        }
+        return;
+    }
+    switch (config_.encoding) {
+        case SharerEncoding::FULL_VECTOR:
+            for (size_t pe_id = 0; pe_id < caches_.size(); pe_id++) {
+                if (entry.bits.test(pe_id)) {
+                    add(pe_id);
+                }
+            }
+            break;
+        case SharerEncoding::COARSE_VECTOR:
+            for (size_t group = 0; group * config_.group_size < caches_.size(); group++) {
+                if (entry.bits.test(group)) {
+                    for (size_t k = 0; k < config_.group_size; k++) {
+                        add(group * config_.group_size + k);
+                    }
+                }
+            }
+            break;
+        case SharerEncoding::LIMITED_POINTERS:
+            for (size_t i = 0; i < entry.pointer_count; i++) {
+                add(static_cast<size_t>(entry.pointers[i]));
+            }
+            break;
+    }
+}
+
+void Directory::resetTo(Entry& entry, int pe_id) {
+    entry = Entry();
+    entry.owner = pe_id;
+    addSharer(entry, pe_id);
+}
+
+// ============================================================
+// SOLICITUDES
+// ============================================================
+
+SnoopResponse Directory::request(const BusMessage& msg, uint8_t* block) {
+    uint64_t block_number = msg.address / block_size_;
+    int requester = msg.sender_pe_id;
+    Entry& entry = entries_[block_number];
+    SnoopResponse response;
+    std::vector<int> targets;
+    DirectoryRequestStats* stats = nullptr;
+    
+    switch (msg.event) {
+        case BusEvent::BUS_READ: {
+            stats = &read_stats_;
+            stats->messages++;  // Solicitud al home node
+            
+            // Forward al dueño: entrega el bloque y baja de estado
+            int previous_owner = entry.owner;
+            bool supplied_by_owner = false;
+            if (entry.owner >= 0 && entry.owner != requester) {
+                stats->forwards++;
+                stats->messages++;
+                SnoopResponse reply = caches_[entry.owner]->handleBusRead(msg.address, block);
+                supplied_by_owner = reply.data_supplied;
+                if (!reply.present) {
+                    removeSharer(entry, entry.owner);
+                }
+                if (!supplied_by_owner) {
+                    entry.owner = -1;  // Pista obsoleta: ya no puede entregar el dato
+                }
+            }
+            stats->messages++;  // Dato desde el dueño o desde memoria
+            response.data_supplied = supplied_by_owner;
+            
+            collectTargets(entry, requester, targets);
+            response.shared = !targets.empty();
+            
+            // Nuevo dueño según el estado en que queda cada copia
+            if (!response.shared) {
+                entry.owner = requester;                       // E
+            } else if (config_.protocol == CoherenceProtocol::MESIF) {
+                entry.owner = requester;                       // El último lector toma F
+            } else if (config_.protocol == CoherenceProtocol::MOESI && supplied_by_owner) {
+                entry.owner = previous_owner;                  // M -> O sigue entregando
+            } else {
+                entry.owner = -1;                              // Todas las copias en S
+            }
+            addSharer(entry, requester);
+            break;
+        }
+            
+        case BusEvent::BUS_READX:
+        case BusEvent::BUS_UPGRADE: {
+            bool readx = msg.event == BusEvent::BUS_READX;
+            stats = readx ? &readx_stats_ : &upgrade_stats_;
+            stats->messages++;  // Solicitud al home node
+            
+            // BusRdX: el dueño entrega el bloque y se invalida
+            int supplier = -1;
+            if (readx && entry.owner >= 0 && entry.owner != requester) {
+                stats->forwards++;
+                stats->messages++;
+                supplier = entry.owner;
+                SnoopResponse reply = caches_[supplier]->handleBusReadX(msg.address, block);
+                response.data_supplied = reply.data_supplied;
+            }
+            
+            // Invalidaciones punto a punto (cada una con su ack)
+            collectTargets(entry, requester, targets);
+            for (int target : targets) {
+                if (target == supplier) {
+                    continue;
+                }
+                if (readx) {
+                    caches_[target]->handleBusReadX(msg.address, nullptr);
+                } else {
+                    caches_[target]->invalidateLine(msg.address);
+                }
+                stats->invalidations++;
+                stats->messages += 2;
+            }
+            stats->messages++;  // Dato (BusRdX) o permiso (BusUpgr) al solicitante
+            
+            resetTo(entry, requester);
+            break;
+        }
+            
+        default:
+            return response;
+    }
+    
+    stats->requests++;
+    stats->broadcast_equivalent += registeredCaches() - 1;
+    
+    TRACE(INTERCONNECT, DETAIL, "[Directory] " << CoherenceController::getEventName(msg.event) 
+          << " from PE" << requester << " block=" << block_number 
+          << " owner=" << entry.owner << (response.data_supplied ? " (forwarded)" : ""));
+    return response;
+}
+
+void Directory::noteEviction(uint64_t address, int pe_id) {
+    auto it = entries_.find(address / block_size_);
+    if (it == entries_.end()) {
+        return;
+    }
+    Entry& entry = it->second;
+    removeSharer(entry, pe_id);
+    if (entry.owner == pe_id) {
+        entry.owner = -1;
+    }
+    if (entry.owner < 0 && !hasSharers(entry)) {
+        entries_.erase(it);
+    }
+}
+
+const DirectoryRequestStats& Directory::getStats(BusEvent event) const {
+    switch (event) {
+        case BusEvent::BUS_READ:    return read_stats_;
+        case BusEvent::BUS_READX:   return readx_stats_;
+        case BusEvent::BUS_UPGRADE: return upgrade_stats_;
+        default:
+            throw std::invalid_argument("Directory: sólo BusRd, BusRdX y BusUpgr son solicitudes");
+    }
+}
+
+void Directory::printStats() const {
+    std::cout << "\n=== Directory Statistics (" << sharerEncodingName(config_.encoding);
+    if (config_.encoding == SharerEncoding::LIMITED_POINTERS) {
+        std::cout << ", " << config_.pointers << " punteros";
+    } else if (config_.encoding == SharerEncoding::COARSE_VECTOR) {
+        std::cout << ", grupos de " << config_.group_size;
+    }
+    std::cout << ") ===" << std::endl;
+    std::cout << "Entradas activas: " << entries_.size() << std::endl;
+    
+    const std::pair<const char*, const DirectoryRequestStats*> rows[] = {
+        {"BusRd", &read_stats_}, {"BusRdX", &readx_stats_}, {"BusUpgr", &upgrade_stats_}
+    };
+    for (const auto& row : rows) {
+        const DirectoryRequestStats& s = *row.second;
+        if (s.requests == 0) {
+            continue;
+        }
+        std::cout << std::setw(8) << row.first << ": requests=" << s.requests
+                  << " messages=" << s.messages
+                  << " (" << std::fixed << std::setprecision(2)
+                  << static_cast<double>(s.messages) / s.requests << "/req)"
+                  << " forwards=" << s.forwards
+                  << " invalidations=" << s.invalidations
+                  << " broadcast snoops=" << s.broadcast_equivalent << std::endl;
+    }
+}
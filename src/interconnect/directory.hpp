@@ -0,0 +1,91 @@
+#ifndef DIRECTORY_HPP
+#define DIRECTORY_HPP
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../cache/cache.hpp"
+
+// Codificación del conjunto de sharers de cada entrada
+enum class SharerEncoding {
+    FULL_VECTOR,       // Un bit por caché (exacto)
+    LIMITED_POINTERS,  // Hasta N punteros; al desbordar pasa a broadcast
+    COARSE_VECTOR      // Un bit por grupo de G cachés
+};
+
+const char* sharerEncodingName(SharerEncoding encoding);
+// Acepta "full", "limited", "coarse"
+bool parseSharerEncoding(const std::string& text, SharerEncoding& encoding);
+
+struct DirectoryConfig {
+    SharerEncoding encoding = SharerEncoding::FULL_VECTOR;
+    size_t pointers = 4;       // LIMITED_POINTERS (máximo MAX_POINTERS)
+    size_t group_size = 4;     // COARSE_VECTOR
+    CoherenceProtocol protocol = CoherenceProtocol::MESI;  // Protocolo de las cachés
+};
+
+// Mensajes por tipo de solicitud
+struct DirectoryRequestStats {
+    uint64_t requests = 0;
+    uint64_t messages = 0;     // Solicitud + forwards + invalidaciones + acks + respuesta
+    uint64_t forwards = 0;     // Solicitudes reenviadas al dueño
+    uint64_t invalidations = 0;
+    uint64_t broadcast_equivalent = 0;  // Snoops que habría costado un bus
+};
+
+// ------------------------------------------------------------
+// Directorio en el home node: por bloque guarda los sharers y el dueño
+// (la caché que puede entregar el dato: E/M/O/F). Atiende los mismos
+// BusRd/BusRdX/BusUpgr que el Interconnect, pero con mensajes punto a
+// punto. El conjunto de sharers nunca subestima: las codificaciones
+// imprecisas sólo envían invalidaciones de más.
+// ------------------------------------------------------------
+class Directory {
+public:
+    static constexpr size_t MAX_POINTERS = 8;
+    static constexpr size_t MAX_CACHES = 256;
+
+    explicit Directory(const DirectoryConfig& config = DirectoryConfig());
+
+    // Las cachés se identifican por su PE id (0..MAX_CACHES-1)
+    void registerCache(ICache* cache);
+
+    // Atiende un mensaje de una caché. Un dueño en M/E/O/F deja el bloque en `block`.
+    SnoopResponse request(const BusMessage& msg, uint8_t* block);
+    // Aviso de desalojo de una línea válida
+    void noteEviction(uint64_t address, int pe_id);
+
+    const DirectoryConfig& getConfig() const { return config_; }
+    const DirectoryRequestStats& getStats(BusEvent event) const;
+    size_t getEntryCount() const { return entries_.size(); }
+    void printStats() const;
+
+private:
+    struct Entry {
+        int owner = -1;                 // -1: ninguna caché entrega el bloque
+        std::bitset<MAX_CACHES> bits;   // FULL_VECTOR: bit por caché; COARSE_VECTOR: bit por grupo
+        std::array<int16_t, MAX_POINTERS> pointers{};
+        uint8_t pointer_count = 0;
+        bool overflow = false;          // LIMITED_POINTERS desbordado: broadcast
+    };
+
+    DirectoryConfig config_;
+    std::vector<ICache*> caches_;       // Indexado por PE id
+    size_t block_size_ = sizeof(uint64_t);
+    std::unordered_map<uint64_t, Entry> entries_;
+    DirectoryRequestStats read_stats_, readx_stats_, upgrade_stats_;
+
+    void addSharer(Entry& entry, int pe_id);
+    void removeSharer(Entry& entry, int pe_id);
+    bool hasSharers(const Entry& entry) const;
+    // Cachés que pueden tener el bloque (sin `exclude`), según la codificación
+    void collectTargets(const Entry& entry, int exclude, std::vector<int>& targets) const;
+    void resetTo(Entry& entry, int pe_id);
+    size_t registeredCaches() const;
+};
+
+#endif // DIRECTORY_HPP
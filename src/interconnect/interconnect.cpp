@@ -1,157 +1,621 @@
 #include "interconnect.hpp"
+#include "../Trace/Trace.hpp"
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
-Interconnect::Interconnect(std::shared_ptr<RAM> ram, bool verbose)
+Interconnect::Interconnect(std::shared_ptr<RAM> ram, bool verbose, size_t num_pes,
+                           size_t ring_entries)
     : ram_(ram)
-    , pe_queues_(4)  // Support for 4 Processing Elements
-    , current_pe_(0)
+    , num_pes_(num_pes)
+    , ring_entries_(ring_entries)
+    , occupied_words_((num_pes + 63) / 64)
+    , arbiter_(std::make_unique<RoundRobinArbiter>(num_pes))
+    , wait_stats_(num_pes)
     , verbose_(verbose) {
+    if (num_pes == 0 || num_pes > MAX_PES) {
+        throw std::invalid_argument("Interconnect: número de PEs fuera de rango (1.." 
+                                    + std::to_string(MAX_PES) + ")");
+    }
+    if (ring_entries == 0) {
+        throw std::invalid_argument("Interconnect: el ring de solicitudes necesita al menos una entrada");
+    }
+    initClass(classes_[DEMAND]);
+}
+
+void Interconnect::initClass(RequestClass& request_class) {
+    for (size_t i = 0; i < num_pes_; i++) {
+        request_class.rings.push_back(std::make_unique<SpscRing<BusTransaction>>(ring_entries_));
+    }
+    request_class.occupied.reset(new std::atomic<uint64_t>[occupied_words_]);
+    for (size_t word = 0; word < occupied_words_; word++) {
+        request_class.occupied[word].store(0, std::memory_order_relaxed);
+    }
 }
 
-void Interconnect::registerCache(Cache* cache) {
+void Interconnect::setArbitration(const ArbitrationConfig& config) {
+    arbiter_ = createArbiter(config, num_pes_);
+    arbitration_ = config;
+    if (config.separate_writebacks && classes_[WRITEBACK].rings.empty()) {
+        initClass(classes_[WRITEBACK]);
+    }
+}
+
+void Interconnect::registerCache(ICache* cache) {
     if (cache) {
+        if (cache->getPEId() < 0 || static_cast<size_t>(cache->getPEId()) >= num_pes_) {
+            throw std::out_of_range("Interconnect: caché de un PE fuera de rango");
+        }
+        if (caches_.empty()) {
+            block_size_ = cache->getGeometry().block_size;
+        }
         caches_.push_back(cache);
         if (verbose_) {
-            std::cout << "[Interconnect] Registered new cache, total: " 
-                      << caches_.size() << std::endl;
+            TRACE(INTERCONNECT, DETAIL, "[Interconnect] Registered new cache, total: " 
+                  << caches_.size());
         }
     }
 }
 
-void Interconnect::addRequest(const BusTransaction& transaction) {
-    if (transaction.pe_id >= pe_queues_.size()) {
+bool Interconnect::addRequest(const BusTransaction& transaction) {
+    if (transaction.pe_id >= num_pes_) {
         throw std::runtime_error("Invalid PE ID");
     }
-    pe_queues_[transaction.pe_id].push(transaction);
+    RequestClass& request_class = 
+        arbitration_.separate_writebacks && transaction.type == BusTransactionType::BusWB
+            ? classes_[WRITEBACK] : classes_[DEMAND];
+    BusTransaction stamped = transaction;
+    stamped.arrival_cycle = bus_cycle_.load(std::memory_order_relaxed);
+    if (!request_class.rings[transaction.pe_id]->tryPush(stamped)) {
+        return false;
+    }
+    // Después del push: el árbitro nunca ve el bit sin la entrada
+    request_class.occupied[transaction.pe_id / 64].fetch_or(1ull << (transaction.pe_id % 64),
+                                               std::memory_order_release);
     
     if (verbose_) {
-        std::cout << "[Interconnect] Broadcasting message from PE" 
-                  << transaction.pe_id << " for addr=0x" 
-                  << std::hex << transaction.address << std::dec << std::endl;
-    }
-    
-    // Notificar a todas las cachés excepto al emisor
-    for (Cache* cache : caches_) {
-        if (cache) {
-            // transaction.type es BusTransactionType
-            switch (transaction.type) {
-                case BusTransactionType::BusRd:
-                    // transaction.address es un índice de palabra/bloque; convertir a bytes
-                    cache->handleBusRead(static_cast<uint64_t>(transaction.address) * sizeof(uint64_t));
-                    break;
-                case BusTransactionType::BusRdX:
-                    cache->handleBusReadX(static_cast<uint64_t>(transaction.address) * sizeof(uint64_t));
-                    break;
-                case BusTransactionType::BusUpgr:
-                    cache->invalidateLine(static_cast<uint64_t>(transaction.address) * sizeof(uint64_t));
-                    break;
-                default:
-                    // BusWB y otros no requieren notificación de invalidación/lectura
-                    break;
+        TRACE(INTERCONNECT, BASIC, "[Interconnect] Queued request from PE" 
+              << transaction.pe_id << " for addr=0x" 
+              << std::hex << transaction.address << std::dec);
+    }
+    return true;
+}
+
+bool Interconnect::classPending(const RequestClass& request_class) const {
+    if (request_class.rings.empty()) {
+        return false;
+    }
+    for (size_t word = 0; word < occupied_words_; word++) {
+        if (request_class.occupied[word].load(std::memory_order_acquire) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Candidatos en orden creciente de PE, recorriendo sólo los bits encendidos
+void Interconnect::collectCandidates(RequestClass& request_class) {
+    candidates_.clear();
+    for (size_t word = 0; word < occupied_words_; word++) {
+        uint64_t bits = request_class.occupied[word].load(std::memory_order_acquire);
+        while (bits != 0) {
+            size_t pe = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            const BusTransaction* head = request_class.rings[pe]->front();
+            if (head) {
+                candidates_.push_back({pe, head});
             }
         }
     }
 }
 
-size_t Interconnect::getNextPE() {
-    size_t start_pe = current_pe_;
-    do {
-        if (!pe_queues_[current_pe_].empty()) {
-            return current_pe_;
+// Saca la solicitud que elige el árbitro y mantiene el bitmask. Los
+// writebacks sólo pasan si no hay lecturas de demanda o si alguno ya
+// esperó writeback_max_wait.
+bool Interconnect::popNextRequest(BusTransaction& transaction) {
+    uint64_t now = bus_cycle_.load(std::memory_order_relaxed);
+    RequestClass* request_class = &classes_[DEMAND];
+    if (classPending(classes_[WRITEBACK])) {
+        collectCandidates(classes_[WRITEBACK]);
+        bool overdue = false;
+        for (const ArbiterRequest& candidate : candidates_) {
+            uint64_t waited = now - std::min(now, candidate.head->arrival_cycle);
+            overdue = overdue || waited >= arbitration_.writeback_max_wait;
+        }
+        bool demand_pending = classPending(classes_[DEMAND]);
+        if (overdue || !demand_pending) {
+            request_class = &classes_[WRITEBACK];
+            if (demand_pending) {
+                writebacks_promoted_++;
+            }
         }
-        current_pe_ = (current_pe_ + 1) % pe_queues_.size();
-    } while (current_pe_ != start_pe);
+    }
+    if (request_class == &classes_[DEMAND]) {
+        collectCandidates(classes_[DEMAND]);
+    }
+    if (candidates_.empty()) {
+        return false;
+    }
     
-    return pe_queues_.size();  // Invalid PE if none found
+    size_t pe = candidates_[arbiter_->choose(candidates_)].pe;
+    if (!takeFrom(*request_class, pe, transaction)) {
+        return false;
+    }
+    arbiter_->granted(pe);
+    return true;
 }
 
-bool Interconnect::processNextTransaction() {
-    size_t next_pe = getNextPE();
-    if (next_pe >= pe_queues_.size()) {
-        return false;  // No transactions to process
+// Saca la primera solicitud del PE (sin arbitraje entre PEs); la clase se
+// elige con la misma regla que popNextRequest
+bool Interconnect::popFromPE(size_t pe, BusTransaction& transaction) {
+    uint64_t now = bus_cycle_.load(std::memory_order_relaxed);
+    const BusTransaction* demand = classes_[DEMAND].rings[pe]->front();
+    if (!classes_[WRITEBACK].rings.empty()) {
+        const BusTransaction* writeback = classes_[WRITEBACK].rings[pe]->front();
+        if (writeback && (!demand ||
+                          now - std::min(now, writeback->arrival_cycle) >= arbitration_.writeback_max_wait)) {
+            if (demand) {
+                writebacks_promoted_++;
+            }
+            return takeFrom(classes_[WRITEBACK], pe, transaction);
+        }
+    }
+    return demand && takeFrom(classes_[DEMAND], pe, transaction);
+}
+
+// Saca la primera solicitud del ring del PE y mantiene el bitmask
+bool Interconnect::takeFrom(RequestClass& request_class, size_t pe, BusTransaction& transaction) {
+    SpscRing<BusTransaction>& ring = *request_class.rings[pe];
+    if (!ring.tryPop(transaction)) {
+        return false;  // El bit se enciende después del push: no debería ocurrir
+    }
+    if (ring.empty()) {
+        // Si el productor empujó entre la comprobación y el borrado, su
+        // fetch_or pudo perderse: se vuelve a mirar y se restaura el bit
+        uint64_t bit = 1ull << (pe % 64);
+        request_class.occupied[pe / 64].fetch_and(~bit, std::memory_order_acq_rel);
+        if (!ring.empty()) {
+            request_class.occupied[pe / 64].fetch_or(bit, std::memory_order_release);
+        }
+    }
+    uint64_t now = bus_cycle_.load(std::memory_order_relaxed);
+    wait_stats_[pe].record(now - std::min(now, transaction.arrival_cycle));
+    transaction.id = ++next_id_;
+    return true;
+}
+
+// ============================================================
+// FUSIÓN DE SOLICITUDES
+// ============================================================
+
+uint64_t Interconnect::blockOf(const BusTransaction& transaction) const {
+    return static_cast<uint64_t>(transaction.address) * sizeof(uint64_t) / block_size_;
+}
+
+bool Interconnect::canCoalesce(const BusTransaction& transaction) const {
+    if (!coalescing_enabled_) {
+        return false;
+    }
+    auto it = coalescing_.find(blockOf(transaction));
+    if (it == coalescing_.end() || !it->second.open) {
+        return false;
+    }
+    BusTransactionType in_flight = it->second.type;
+    return (transaction.type == BusTransactionType::BusRd && in_flight == BusTransactionType::BusRd) ||
+           (transaction.type == BusTransactionType::BusUpgr && 
+            (in_flight == BusTransactionType::BusRdX || in_flight == BusTransactionType::BusUpgr));
+}
+
+bool Interconnect::tryCoalesce(const BusTransaction& transaction) {
+    if (!canCoalesce(transaction)) {
+        return false;
+    }
+    coalescing_[blockOf(transaction)].merged.push_back(transaction);
+    if (transaction.type == BusTransactionType::BusUpgr) {
+        folded_upgrades_++;
     }
-    
-    BusTransaction& transaction = pe_queues_[next_pe].front();
-    
     if (verbose_) {
-        std::cout << "Processing transaction: " << transaction.toString() << std::endl;
+        TRACE(INTERCONNECT, BASIC, "Coalesced: " << transaction.toString());
+    }
+    return true;
+}
+
+// Las primeras solicitudes de cada PE que se pueden unir a una transacción
+// en curso salen de la cola sin usar el bus
+void Interconnect::absorbPendingHeads() {
+    if (coalescing_.empty()) {
+        return;
+    }
+    RequestClass& demand = classes_[DEMAND];
+    for (size_t word = 0; word < occupied_words_; word++) {
+        uint64_t bits = demand.occupied[word].load(std::memory_order_acquire);
+        while (bits != 0) {
+            size_t pe = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            BusTransaction transaction;
+            for (const BusTransaction* head = demand.rings[pe]->front();
+                 head && canCoalesce(*head) && takeFrom(demand, pe, transaction);
+                 head = demand.rings[pe]->front()) {
+                tryCoalesce(transaction);
+            }
+        }
     }
+}
+
+// Una transacción que sí usa el bus abre una fusión para su bloque, o
+// cierra la que estaba abierta si no se pudo unir a ella
+void Interconnect::trackIssued(const BusTransaction& transaction) {
+    if (!coalescing_enabled_) {
+        return;
+    }
+    uint64_t block = blockOf(transaction);
+    auto it = coalescing_.find(block);
+    if (it != coalescing_.end()) {
+        it->second.open = false;
+    } else if (transaction.type != BusTransactionType::BusWB) {
+        coalescing_[block] = {transaction.id, transaction.type, true, {}};
+    }
+}
+
+// La transacción principal completa también a las fusionadas con ella
+void Interconnect::completeTransaction(BusTransaction& transaction) {
+    uint64_t block = blockOf(transaction);
+    auto it = coalescing_.find(block);
+    bool primary = it != coalescing_.end() && it->second.primary_id == transaction.id;
     
-    // Handle transaction y notificar a las cachés cuando sea necesario
+    // Sólo se fusionan BusRd en un BusRd: cada solicitante toma su palabra
+    // del mismo bloque del registro
+    if (primary && transaction.type == BusTransactionType::BusRd && !it->second.merged.empty()) {
+        uint32_t base = static_cast<uint32_t>(block * block_size_ / sizeof(uint64_t));
+        block_buffer_.resize(block_size_ / sizeof(uint64_t));
+        ram_->readBlock(base, reinterpret_cast<uint8_t*>(block_buffer_.data()), block_size_);
+        transaction.data = block_buffer_[transaction.address - base];
+        for (BusTransaction& merged : it->second.merged) {
+            merged.data = block_buffer_[merged.address - base];
+            coalesced_reads_++;
+        }
+    } else {
+        performMemoryAccess(transaction);
+    }
+    recordProcessed(transaction);
+    deliver(transaction);
+    
+    if (!primary) {
+        return;
+    }
+    for (const BusTransaction& merged : it->second.merged) {
+        recordProcessed(merged);
+        deliver(merged);
+    }
+    coalescing_.erase(it);
+}
+
+// El solicitante que espera la respuesta puede completar su miss
+void Interconnect::deliver(const BusTransaction& transaction) {
+    if (transaction.delivered != nullptr) {
+        transaction.delivered->store(true, std::memory_order_release);
+    }
+}
+
+// Cada transacción se estampa con el reloj del modelo de tiempo activo
+void Interconnect::recordProcessed(const BusTransaction& transaction) {
+    uint64_t cycle = bus_ ? bus_->getCycle()
+                   : noc_ ? noc_->getCycle()
+                   : bus_cycle_.load(std::memory_order_relaxed);
+    TraceRecord record{cycle, transaction};
+    trace_.push(record);
+    if (trace_writer_) {
+        trace_writer_->append(record);
+    }
+}
+
+void Interconnect::setTraceCapacity(size_t entries) {
+    trace_ = TraceRing(entries);
+}
+
+void Interconnect::openTraceFile(const std::string& path) {
+    closeTraceFile();
+    trace_writer_ = std::make_unique<TraceWriter>(path);
+}
+
+void Interconnect::closeTraceFile() {
+    if (trace_writer_) {
+        trace_writer_->close();
+    }
+}
+
+// Acceso a RAM. El snoop a las cachés ya ocurrió al emitir el mensaje
+// (snoop()); el bus sólo arbitra el acceso a memoria.
+void Interconnect::performMemoryAccess(BusTransaction& transaction) {
     switch (transaction.type) {
         case BusTransactionType::BusRd:
-            transaction.data = ram_->read(transaction.address);
-            // Notificar BUS_READ a otras cachés
-            notifyCaches(transaction.address * sizeof(uint64_t), 
-                        transaction.pe_id, BusEvent::BUS_READ);
-            break;
-            
         case BusTransactionType::BusRdX:
             transaction.data = ram_->read(transaction.address);
-            // Notificar BUS_READX a otras cachés
-            notifyCaches(transaction.address * sizeof(uint64_t), 
-                        transaction.pe_id, BusEvent::BUS_READX);
             break;
             
         case BusTransactionType::BusWB:
-            ram_->write(transaction.address, transaction.data);
+            // El de una caché ya escribió su bloque; repetirlo aquí pisaría
+            // lo que otro PE haya escrito después
+            if (!transaction.posted) {
+                ram_->write(transaction.address, transaction.data);
+            }
             break;
             
         case BusTransactionType::BusUpgr:
-            // Notificar BUS_UPGRADE a otras cachés
-            notifyCaches(transaction.address * sizeof(uint64_t), 
-                        transaction.pe_id, BusEvent::BUS_UPGRADE);
             break;
     }
+}
+
+bool Interconnect::processNextTransaction() {
+    BusTransaction transaction;
+    if (!popNextRequest(transaction)) {
+        return false;  // No transactions to process
+    }
     
-    processed_transactions_.push_back(transaction);
-    pe_queues_[next_pe].pop();
-    current_pe_ = (next_pe + 1) % pe_queues_.size();
+    if (verbose_) {
+        TRACE(INTERCONNECT, BASIC, "Processing transaction: " << transaction.toString());
+    }
     
+    // Las solicitudes al mismo bloque que esperan en cabeza de cola se
+    // atienden con este mismo acceso
+    trackIssued(transaction);
+    absorbPendingHeads();
+    completeTransaction(transaction);
+    // Sin modelo de tiempo el reloj cuenta turnos de arbitraje
+    bus_cycle_.store(bus_cycle_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
     return true;
 }
 
-void Interconnect::notifyCaches(uint64_t address, int sender_pe_id, BusEvent event) {
-    BusMessage msg{address, event, sender_pe_id};
-    broadcastBusMessage(msg);
+void Interconnect::setBusTiming(const BusTimingConfig& config) {
+    noc_.reset();
+    bus_ = std::make_unique<SplitTransactionBus>(config, num_pes_);
+}
+
+void Interconnect::setNetwork(const NoCConfig& config) {
+    bus_.reset();
+    noc_ = std::make_unique<NetworkOnChip>(config, num_pes_);
+}
+
+bool Interconnect::tick() {
+    if (noc_) {
+        return tickNetwork();
+    }
+    if (!bus_) {
+        return processNextTransaction();
+    }
+    bool pending = hasPendingTransactions();
+    if (!pending && bus_->idle()) {
+        return false;
+    }
+    
+    // A lo sumo una solicitud nueva por ciclo; las que se fusionan con una
+    // transacción en curso no usan el bus
+    absorbPendingHeads();
+    if (hasPendingTransactions()) {
+        BusTransaction transaction;
+        if (bus_->canIssue() && popNextRequest(transaction)) {
+            if (!tryCoalesce(transaction)) {
+                if (verbose_) {
+                    TRACE(INTERCONNECT, BASIC, "Bus request phase: " << transaction.toString());
+                }
+                bus_->issue(transaction, block_size_);
+                trackIssued(transaction);
+            }
+        } else {
+            bus_->noteBlockedRequest();
+        }
+    }
+    
+    // La memoria se accede cuando la transacción termina su fase de datos
+    completed_.clear();
+    bus_->tick(completed_);
+    for (BusTransaction& transaction : completed_) {
+        completeTransaction(transaction);
+    }
+    bus_cycle_.store(bus_->getCycle(), std::memory_order_relaxed);
+    return true;
 }
 
 void Interconnect::broadcastBusMessage(const BusMessage& msg) {
+    snoop(msg);
+}
+
+SnoopResponse Interconnect::snoop(const BusMessage& msg, uint8_t* block) {
     if (verbose_) {
-        std::cout << "[Interconnect] Broadcasting message from PE" 
-                  << msg.sender_pe_id << " for addr=0x" 
-                  << std::hex << msg.address << std::dec << std::endl;
-    }
-    
-    // Notificar a todas las cachés excepto al emisor
-    for (Cache* cache : caches_) {
-        if (cache) {
-            switch (msg.event) {
-                case BusEvent::BUS_READ:
-                    cache->handleBusRead(msg.address);
-                    break;
-                case BusEvent::BUS_READX:
-                    cache->handleBusReadX(msg.address);
-                    break;
-                case BusEvent::BUS_UPGRADE:
-                    cache->invalidateLine(msg.address);
-                    break;
-                default:
-                    break;
+        TRACE(INTERCONNECT, BASIC, "[Interconnect] Snooping message from PE" 
+              << msg.sender_pe_id << " for addr=0x" 
+              << std::hex << msg.address << std::dec);
+    }
+    
+    SnoopResponse response;
+    uint64_t block_number = msg.address / block_size_;
+    bool invalidating = msg.event == BusEvent::BUS_READX || msg.event == BusEvent::BUS_UPGRADE;
+    
+    for (ICache* cache : caches_) {
+        if (cache == nullptr || cache->getPEId() == msg.sender_pe_id) {
+            continue;
+        }
+        if (snoop_filter_ && !snoop_filter_->mayHold(block_number, cache->getPEId())) {
+            snoops_filtered_++;
+            continue;
+        }
+        snoops_delivered_++;
+        
+        // Sólo la primera caché en M/E entrega el bloque
+        uint8_t* supply = response.data_supplied ? nullptr : block;
+        SnoopResponse reply;
+        switch (msg.event) {
+            case BusEvent::BUS_READ:
+                reply = cache->handleBusRead(msg.address, supply);
+                break;
+            case BusEvent::BUS_READX:
+                reply = cache->handleBusReadX(msg.address, supply);
+                break;
+            case BusEvent::BUS_UPGRADE:
+                reply.present = cache->invalidateLine(msg.address);
+                break;
+            default:
+                break;
+        }
+        
+        // La línea invalidada deja de estar en esa caché
+        if (snoop_filter_ && invalidating && reply.present) {
+            snoop_filter_->remove(block_number, cache->getPEId());
+        }
+        
+        if (reply.data_supplied) {
+            response.data_supplied = true;
+            c2c_transfers_++;
+            memory_reads_saved_ += cache->getGeometry().block_size / sizeof(uint64_t);
+            TRACE(INTERCONNECT, DETAIL, "[Interconnect] Cache-to-cache transfer PE" 
+                  << cache->getPEId() << " -> PE" << msg.sender_pe_id 
+                  << " for addr=0x" << std::hex << msg.address << std::dec);
+        }
+        response.shared = response.shared || reply.shared;
+    }
+    
+    if (response.shared) {
+        shared_responses_++;
+    }
+    
+    // El solicitante va a instalar el bloque
+    if (snoop_filter_ && (msg.event == BusEvent::BUS_READ || msg.event == BusEvent::BUS_READX)) {
+        snoop_filter_->insert(block_number, msg.sender_pe_id);
+    }
+    return response;
+}
+
+void Interconnect::setSnoopFilter(SnoopFilterKind kind, size_t bloom_counters) {
+    snoop_filter_ = createSnoopFilter(kind, bloom_counters, num_pes_);
+}
+
+void Interconnect::noteEviction(uint64_t address, int pe_id) {
+    if (snoop_filter_) {
+        snoop_filter_->remove(address / block_size_, pe_id);
+    }
+}
+
+void Interconnect::printStats() const {
+    std::cout << "\n=== Interconnect Snoop Statistics ===" << std::endl;
+    std::cout << "Cache-to-cache transfers: " << c2c_transfers_ << std::endl;
+    std::cout << "Memory reads saved: " << memory_reads_saved_ << " words" << std::endl;
+    std::cout << "Shared responses: " << shared_responses_ << std::endl;
+    std::cout << "Bus requests: processed=" << trace_.total()
+              << " ring full=" << getRingFullCount() << " (ring de "
+              << getRingCapacity() << " entradas por PE)" << std::endl;
+    std::cout << "Historial: últimas " << trace_.size() << " de " << trace_.total()
+              << " transacciones en memoria";
+    if (trace_writer_) {
+        // Los contadores son finales después de closeTraceFile()
+        std::cout << " | traza binaria: " << trace_writer_->getRecords() << " registros, "
+                  << trace_writer_->getBytes() << " bytes";
+    }
+    std::cout << std::endl;
+    if (coalescing_enabled_) {
+        std::cout << "Coalescing: BusRd fusionados=" << coalesced_reads_
+                  << " BusUpgr absorbidos=" << folded_upgrades_
+                  << " (turnos de bus; las lecturas de RAM no cambian)" << std::endl;
+    }
+    
+    uint64_t total_snoops = snoops_delivered_ + snoops_filtered_;
+    std::cout << "Snoop filter (" << snoopFilterKindName(snoop_filter_ ? snoop_filter_->kind() : SnoopFilterKind::NONE)
+              << "): delivered=" << snoops_delivered_ << " filtered=" << snoops_filtered_;
+    if (total_snoops > 0) {
+        std::cout << " (" << std::fixed << std::setprecision(2) 
+                  << 100.0 * snoops_filtered_ / total_snoops << "% filtered)";
+    }
+    if (snoop_filter_) {
+        std::cout << " footprint=" << snoop_filter_->footprintBytes() << " bytes";
+    }
+    std::cout << std::endl;
+    if (bus_) {
+        bus_->printStats();
+    }
+    if (noc_) {
+        noc_->printStats();
+    }
+    
+    std::cout << "\n=== Bus Arbitration (" << arbitrationPolicyName(arbiter_->policy()) << ") ===" << std::endl;
+    if (arbitration_.separate_writebacks) {
+        std::cout << "Writebacks en clase aparte: promovidos por espera=" << writebacks_promoted_
+                  << " (umbral " << arbitration_.writeback_max_wait << ")" << std::endl;
+    }
+    std::cout << "Espera hasta el grant (" << (bus_ || noc_ ? "ciclos" : "turnos")
+              << "); el miss del PE sigue esperando hasta la respuesta" << std::endl;
+    for (size_t pe = 0; pe < num_pes_; pe++) {
+        const PEWaitStats& s = wait_stats_[pe];
+        if (s.grants == 0) {
+            continue;
+        }
+        std::cout << "  PE" << pe << ": grants=" << s.grants << " espera media="
+                  << std::fixed << std::setprecision(2) << static_cast<double>(s.total_wait) / s.grants
+                  << std::defaultfloat << " máx=" << s.max_wait << " |";
+        for (size_t b = 0; b < PEWaitStats::BUCKETS; b++) {
+            if (s.histogram[b] != 0) {
+                std::cout << " " << PEWaitStats::bucketLabel(b) << ":" << s.histogram[b];
             }
         }
+        std::cout << std::endl;
     }
 }
 
+// Un ciclo de la red: cada PE con solicitudes inyecta en su router
+bool Interconnect::tickNetwork() {
+    bool pending = hasPendingTransactions();
+    if (!pending && noc_->idle()) {
+        return false;
+    }
+    
+    absorbPendingHeads();
+    for (size_t word = 0; pending && word < occupied_words_; word++) {
+        uint64_t bits = classes_[DEMAND].occupied[word].load(std::memory_order_acquire);
+        if (!classes_[WRITEBACK].rings.empty()) {
+            bits |= classes_[WRITEBACK].occupied[word].load(std::memory_order_acquire);
+        }
+        while (bits != 0) {
+            size_t pe = word * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+            bits &= bits - 1;
+            BusTransaction transaction;
+            if (noc_->canInject(pe) && popFromPE(pe, transaction) && !tryCoalesce(transaction)) {
+                if (verbose_) {
+                    TRACE(INTERCONNECT, BASIC, "NoC inject: " << transaction.toString());
+                }
+                noc_->inject(transaction, block_size_);
+                trackIssued(transaction);
+            }
+        }
+    }
+    
+    completed_.clear();
+    noc_->tick(completed_);
+    for (BusTransaction& transaction : completed_) {
+        completeTransaction(transaction);
+    }
+    bus_cycle_.store(noc_->getCycle(), std::memory_order_relaxed);
+    return true;
+}
+
 bool Interconnect::hasPendingTransactions() const {
-    for (const auto& queue : pe_queues_) {
-        if (!queue.empty()) {
-            return true;
+    return classPending(classes_[DEMAND]) || classPending(classes_[WRITEBACK]);
+}
+
+uint64_t Interconnect::getRingFullCount() const {
+    uint64_t total = 0;
+    for (const RequestClass& request_class : classes_) {
+        for (const auto& ring : request_class.rings) {
+            total += ring->getFullCount();
         }
     }
-    return false;
+    return total;
 }
 
-const std::vector<BusTransaction>& Interconnect::getProcessedTransactions() const {
-    return processed_transactions_;
+std::vector<BusTransaction> Interconnect::getProcessedTransactions() const {
+    std::vector<BusTransaction> recent;
+    recent.reserve(trace_.size());
+    for (size_t i = 0; i < trace_.size(); i++) {
+        recent.push_back(trace_[i].transaction);
+    }
+    return recent;
 }
\ No newline at end of file
@@ -1,45 +1,183 @@
 #ifndef INTERCONNECT_HPP
 #define INTERCONNECT_HPP
 
-#include <queue>
+#include <atomic>
+#include <unordered_map>
 #include <vector>
 #include <memory>
+#include <string>
 #include "../bus/bus.hpp"
 #include "../ram/ram.hpp"
 #include "../cache/cache.hpp"  // Nuevo: incluir Cache
 #include "../cache/mesi_controller.hpp"  // Nuevo: para BusEvent
+#include "snoop_filter.hpp"
+#include "spsc_ring.hpp"
+#include "split_bus.hpp"
+#include "arbiter.hpp"
+#include "noc.hpp"
+#include "transaction_trace.hpp"
 
-class Cache;  // Forward declaration
+class ICache;  // Forward declaration
 
 class Interconnect {
 public:
-    Interconnect(std::shared_ptr<RAM> ram, bool verbose = false);
+    static constexpr size_t DEFAULT_PES = 4;
+    static constexpr size_t MAX_PES = 256;
+    static constexpr size_t DEFAULT_RING_ENTRIES = 64;
+    static constexpr size_t DEFAULT_TRACE_ENTRIES = 4096;
     
-    // Funciones existentes
-    void addRequest(const BusTransaction& transaction);
+    // Colas y arbitraje se dimensionan para num_pes (1..MAX_PES). Cada PE
+    // tiene un ring SPSC de ring_entries (se redondea a potencia de dos).
+    Interconnect(std::shared_ptr<RAM> ram, bool verbose = false, size_t num_pes = DEFAULT_PES,
+                 size_t ring_entries = DEFAULT_RING_ENTRIES);
+    
+    // Productor: sólo el hilo del PE transaction.pe_id. Sin locks; devuelve
+    // false si el ring del PE está lleno (el PE reintenta).
+    bool addRequest(const BusTransaction& transaction);
+    // Consumidor (árbitro): un único hilo a la vez. processNextTransaction
+    // atiende una transacción completa sin noción de tiempo; tick() avanza
+    // un ciclo del bus de transacción partida (si se configuró) y devuelve
+    // false sin mover el reloj cuando no hay nada en vuelo ni en cola.
     bool processNextTransaction();
-    const std::vector<BusTransaction>& getProcessedTransactions() const;
+    bool tick();
+    // Las últimas getTraceCapacity() atendidas, de la más antigua a la más
+    // nueva; getProcessedCount() cuenta todas
+    std::vector<BusTransaction> getProcessedTransactions() const;
+    uint64_t getProcessedCount() const { return trace_.total(); }
     bool hasPendingTransactions() const;
+    size_t getRingCapacity() const { return classes_[DEMAND].rings.front()->capacity(); }
+    uint64_t getRingFullCount() const;  // Pushes rechazados por ring lleno
+    
+    // Modelo de tiempo: bus de transacción partida o red en chip (uno u
+    // otro). Debe configurarse antes del primer acceso. La coherencia no
+    // cambia: las cachés siguen haciendo snoop por el mismo IBusInterface.
+    // Una transacción con `delivered` se marca al completar (en el modelo de
+    // tiempo activo, o al atenderla sin él); el miss que la espera no
+    // completa antes.
+    void setBusTiming(const BusTimingConfig& config);
+    void setNetwork(const NoCConfig& config);
+    const SplitTransactionBus* getBus() const { return bus_.get(); }
+    const NetworkOnChip* getNetwork() const { return noc_.get(); }
+    
+    // Política de arbitraje (round-robin por defecto); debe configurarse
+    // antes del primer acceso
+    void setArbitration(const ArbitrationConfig& config);
+    ArbitrationPolicy getArbitrationPolicy() const { return arbiter_->policy(); }
+    const PEWaitStats& getWaitStats(size_t pe_id) const { return wait_stats_[pe_id]; }
+    uint64_t getWritebacksPromoted() const { return writebacks_promoted_; }
+    
+    // Fusión de solicitudes al mismo bloque (activa por defecto): un BusRd
+    // pendiente se une a un BusRd en curso y comparte su turno de bus; un
+    // BusUpgr se absorbe en un BusRdX/BusUpgr en curso. Una transacción
+    // incompatible al bloque cierra la fusión para no reordenar. Sólo ahorra
+    // ocupación del bus: cada caché ya llenó su bloque con readFromMemory,
+    // así que no hay menos lecturas de RAM.
+    void setCoalescing(bool enabled) { coalescing_enabled_ = enabled; }
+    uint64_t getCoalescedReads() const { return coalesced_reads_; }  // BusRd que no usaron el bus
+    uint64_t getFoldedUpgrades() const { return folded_upgrades_; }
+    
+    // Historial en memoria acotado a `entries` (descarta el actual). Para
+    // conservarlo completo se vuelca a una traza binaria en segundo plano;
+    // openTraceFile lanza std::runtime_error si no puede crear el archivo.
+    void setTraceCapacity(size_t entries);
+    size_t getTraceCapacity() const { return trace_.capacity(); }
+    void openTraceFile(const std::string& path);
+    void closeTraceFile();
     
     // Nuevas funciones para coherencia
-    void registerCache(Cache* cache);
+    void registerCache(ICache* cache);
     void broadcastBusMessage(const BusMessage& msg);
     size_t getRegisteredCacheCount() const { return caches_.size(); }
+    size_t getNumPEs() const { return num_pes_; }
+
+    // Snoop de un mensaje en todas las cachés registradas excepto la emisora.
+    // Agrega la señal shared; la primera caché en M/E copia el bloque en
+    // `block` y el solicitante se ahorra la lectura a memoria.
+    SnoopResponse snoop(const BusMessage& msg, uint8_t* block = nullptr);
+
+    // Snoop filter opcional: los snoops sólo llegan a las cachés que pueden
+    // tener el bloque. Debe configurarse antes del primer acceso.
+    void setSnoopFilter(SnoopFilterKind kind, size_t bloom_counters = 1024);
+    // Aviso de desalojo de una línea válida (mantiene el filtro)
+    void noteEviction(uint64_t address, int pe_id);
+
+    // Estadísticas de snoop
+    uint64_t getCacheToCacheTransfers() const { return c2c_transfers_; }
+    uint64_t getMemoryReadsSaved() const { return memory_reads_saved_; }  // Palabras de RAM
+    uint64_t getSharedResponses() const { return shared_responses_; }
+    uint64_t getSnoopsDelivered() const { return snoops_delivered_; }
+    uint64_t getSnoopsFiltered() const { return snoops_filtered_; }
+    void printStats() const;
 
 private:
+    // Un ring por PE y clase de prioridad. Bit por PE con ring no vacío:
+    // el productor lo enciende tras el push y el árbitro lo apaga al vaciarlo.
+    struct RequestClass {
+        std::vector<std::unique_ptr<SpscRing<BusTransaction>>> rings;
+        std::unique_ptr<std::atomic<uint64_t>[]> occupied;
+    };
+    static constexpr size_t DEMAND = 0;
+    static constexpr size_t WRITEBACK = 1;  // Sólo con separate_writebacks
+    
     std::shared_ptr<RAM> ram_;
-    std::vector<std::queue<BusTransaction>> pe_queues_;
-    std::vector<BusTransaction> processed_transactions_;
-    size_t current_pe_;
+    size_t num_pes_;
+    size_t ring_entries_;
+    size_t occupied_words_;
+    RequestClass classes_[2];
+    // Estado del árbitro (sólo el consumidor)
+    TraceRing trace_{DEFAULT_TRACE_ENTRIES};
+    std::unique_ptr<TraceWriter> trace_writer_;
+    ArbitrationConfig arbitration_;
+    std::unique_ptr<Arbiter> arbiter_;
+    std::vector<ArbiterRequest> candidates_;
+    std::vector<PEWaitStats> wait_stats_;
+    uint64_t writebacks_promoted_ = 0;
+    uint64_t next_id_ = 0;
+    
+    // Transacción en curso por bloque y las que se le unieron
+    struct Coalesced {
+        uint64_t primary_id;
+        BusTransactionType type;
+        bool open;
+        std::vector<BusTransaction> merged;
+    };
+    bool coalescing_enabled_ = true;
+    std::unordered_map<uint64_t, Coalesced> coalescing_;
+    uint64_t coalesced_reads_ = 0;     // BusRd unidos a otro en curso
+    std::vector<uint64_t> block_buffer_;
+    uint64_t folded_upgrades_ = 0;
+    std::unique_ptr<SplitTransactionBus> bus_;
+    std::unique_ptr<NetworkOnChip> noc_;
+    std::vector<BusTransaction> completed_;         // Salida de cada tick del bus
+    std::atomic<uint64_t> bus_cycle_{0};            // Reloj del bus visible para los productores
     bool verbose_;
     
     // Nuevo: vector de caches para coherencia
-    std::vector<Cache*> caches_;
-    
-    size_t getNextPE();
+    std::vector<ICache*> caches_;
+    uint64_t c2c_transfers_ = 0;
+    uint64_t memory_reads_saved_ = 0;
+    uint64_t shared_responses_ = 0;
+    std::unique_ptr<SnoopFilter> snoop_filter_;
+    size_t block_size_ = sizeof(uint64_t);  // Tamaño de bloque de las cachés registradas
+    uint64_t snoops_delivered_ = 0;
+    uint64_t snoops_filtered_ = 0;
     
-    // Nuevo: helper para broadcast según tipo de evento
-    void notifyCaches(uint64_t address, int sender_pe_id, BusEvent event);
+    void initClass(RequestClass& request_class);
+    bool classPending(const RequestClass& request_class) const;
+    void collectCandidates(RequestClass& request_class);
+    bool popNextRequest(BusTransaction& transaction);
+    bool popFromPE(size_t pe, BusTransaction& transaction);
+    bool takeFrom(RequestClass& request_class, size_t pe, BusTransaction& transaction);
+    bool tickNetwork();
+    uint64_t blockOf(const BusTransaction& transaction) const;
+    bool canCoalesce(const BusTransaction& transaction) const;
+    bool tryCoalesce(const BusTransaction& transaction);
+    void absorbPendingHeads();
+    void trackIssued(const BusTransaction& transaction);
+    void completeTransaction(BusTransaction& transaction);
+    void recordProcessed(const BusTransaction& transaction);
+    void deliver(const BusTransaction& transaction);
+    void performMemoryAccess(BusTransaction& transaction);
 };
 
 #endif // INTERCONNECT_HPP
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "noc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+const char* nocTopologyName(NoCTopology topology) {
+    switch (topology) {
+        case NoCTopology::MESH: return "mesh";
+        case NoCTopology::RING: return "ring";
+        default: return "?";
+    }
+}
+
+bool parseNoCTopology(const std::string& text, NoCTopology& topology) {
+    if (text == "mesh")      topology = NoCTopology::MESH;
+    else if (text == "ring") topology = NoCTopology::RING;
+    else return false;
+    return true;
+}
+
+NetworkOnChip::NetworkOnChip(const NoCConfig& config, size_t num_pes)
+    : config_(config)
+    , num_pes_(num_pes)
+    , outstanding_(num_pes, 0) {
+    if (config.router_stages == 0 || config.link_bits == 0 || config.virtual_channels == 0 ||
+        config.memory_controllers == 0 || config.max_outstanding == 0 || num_pes == 0) {
+        throw std::invalid_argument("NetworkOnChip: etapas, ancho de enlace, VCs, controladores y "
+                                    "max_outstanding deben ser mayores que cero");
+    }
+
+    if (config.topology == NoCTopology::MESH) {
+        cols_ = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(num_pes))));
+        rows_ = (num_pes + cols_ - 1) / cols_;
+    } else {
+        cols_ = num_pes;
+        rows_ = 1;
+    }
+    nodes_ = rows_ * cols_;
+    if (config.memory_controllers > nodes_) {
+        throw std::invalid_argument("NetworkOnChip: más controladores de RAM que nodos");
+    }
+
+    // Controladores: primero las esquinas de la malla, luego equiespaciados
+    auto place = [this](size_t node) {
+        if (memory_nodes_.size() < config_.memory_controllers &&
+            std::find(memory_nodes_.begin(), memory_nodes_.end(), node) == memory_nodes_.end()) {
+            memory_nodes_.push_back(node);
+        }
+    };
+    if (config.topology == NoCTopology::MESH) {
+        place(0);
+        place(nodes_ - 1);
+        place(cols_ - 1);
+        place(nodes_ - cols_);
+    }
+    for (size_t i = 0; i < config.memory_controllers; i++) {
+        place(i * nodes_ / config.memory_controllers);
+    }
+    for (size_t node = 0; node < nodes_; node++) {
+        place(node);
+    }
+
+    links_.resize(nodes_ * DIRECTIONS);
+    for (Link& link : links_) {
+        link.vc_free.assign(config.virtual_channels, 0);
+    }
+}
+
+size_t NetworkOnChip::getHomeNode(uint32_t word_address, size_t block_bytes) const {
+    uint64_t block = static_cast<uint64_t>(word_address) * sizeof(uint64_t) / block_bytes;
+    return memory_nodes_[block % memory_nodes_.size()];
+}
+
+// Malla: primero X y luego Y. Anillo: el sentido más corto (empate: horario).
+NetworkOnChip::Direction NetworkOnChip::route(size_t node, size_t dst) const {
+    if (config_.topology == NoCTopology::RING) {
+        size_t clockwise = (dst + nodes_ - node) % nodes_;
+        return clockwise <= nodes_ - clockwise ? EAST : WEST;
+    }
+    size_t x = node % cols_, y = node / cols_;
+    size_t dx = dst % cols_, dy = dst / cols_;
+    if (dx != x) {
+        return dx > x ? EAST : WEST;
+    }
+    return dy < y ? NORTH : SOUTH;
+}
+
+size_t NetworkOnChip::neighbor(size_t node, Direction direction) const {
+    if (config_.topology == NoCTopology::RING) {
+        return direction == EAST ? (node + 1) % nodes_ : (node + nodes_ - 1) % nodes_;
+    }
+    switch (direction) {
+        case EAST:  return node + 1;
+        case WEST:  return node - 1;
+        case NORTH: return node - cols_;
+        default:    return node + cols_;
+    }
+}
+
+size_t NetworkOnChip::hops(size_t src, size_t dst) const {
+    size_t count = 0;
+    for (size_t node = src; node != dst; node = neighbor(node, route(node, dst))) {
+        count++;
+    }
+    return count;
+}
+
+uint64_t NetworkOnChip::send(size_t src, size_t dst, size_t flits, uint64_t start) {
+    packets_++;
+    flits_ += flits;
+    uint64_t head = start;
+    for (size_t node = src; node != dst; ) {
+        Direction direction = route(node, dst);
+        Link& link = links_[node * DIRECTIONS + direction];
+
+        uint64_t ready = head + config_.router_stages;
+        auto vc = std::min_element(link.vc_free.begin(), link.vc_free.end());
+        uint64_t depart = std::max({ready, link.free_at, *vc});
+        contention_cycles_ += depart - ready;
+
+        link.free_at = depart + flits;
+        *vc = depart + flits + config_.router_stages;
+        link.busy_cycles += flits;
+        hop_count_++;
+
+        head = depart + 1;
+        node = neighbor(node, direction);
+    }
+    // Pipeline del router destino y el resto de los flits
+    return head + config_.router_stages + flits - 1;
+}
+
+uint64_t NetworkOnChip::invalidateOthers(size_t home, size_t requester, uint64_t start) {
+    uint64_t last_ack = start;
+    for (size_t pe = 0; pe < num_pes_; pe++) {
+        if (pe != requester) {
+            uint64_t delivered = send(home, pe, 1, start);
+            last_ack = std::max(last_ack, send(pe, home, 1, delivered));
+        }
+    }
+    return last_ack;
+}
+
+bool NetworkOnChip::canInject(size_t pe_id) const {
+    return outstanding_[pe_id] < config_.max_outstanding;
+}
+
+void NetworkOnChip::inject(const BusTransaction& transaction, size_t block_bytes) {
+    size_t pe = transaction.pe_id;
+    size_t home = getHomeNode(transaction.address, block_bytes);
+    size_t data_flits = 1 + (block_bytes * 8 + config_.link_bits - 1) / config_.link_bits;
+    uint64_t at_home;
+    uint64_t done = 0;
+
+    switch (transaction.type) {
+        case BusTransactionType::BusRd:
+            at_home = send(pe, home, 1, cycle_);
+            done = send(home, pe, data_flits, at_home + config_.memory_latency);
+            break;
+        case BusTransactionType::BusRdX: {
+            at_home = send(pe, home, 1, cycle_);
+            uint64_t acks = invalidateOthers(home, pe, at_home);
+            done = send(home, pe, data_flits, std::max(at_home + config_.memory_latency, acks));
+            break;
+        }
+        case BusTransactionType::BusUpgr:
+            at_home = send(pe, home, 1, cycle_);
+            done = send(home, pe, 1, invalidateOthers(home, pe, at_home));
+            break;
+        case BusTransactionType::BusWB:
+            done = send(pe, home, data_flits, cycle_) + config_.memory_latency;
+            break;
+    }
+
+    outstanding_[pe]++;
+    in_flight_.push({done, transaction});
+}
+
+void NetworkOnChip::tick(std::vector<BusTransaction>& completed) {
+    cycle_++;
+    while (!in_flight_.empty() && in_flight_.top().done <= cycle_) {
+        const BusTransaction& transaction = in_flight_.top().transaction;
+        outstanding_[transaction.pe_id]--;
+        total_latency_ += cycle_ - std::min(cycle_, transaction.arrival_cycle);
+        completed_++;
+        completed.push_back(transaction);
+        in_flight_.pop();
+    }
+}
+
+void NetworkOnChip::printStats() const {
+    std::cout << "\n=== Network-on-Chip (" << nocTopologyName(config_.topology);
+    if (config_.topology == NoCTopology::MESH) {
+        std::cout << " " << cols_ << "x" << rows_;
+    } else {
+        std::cout << " de " << nodes_ << " nodos";
+    }
+    std::cout << ") ===" << std::endl;
+    std::cout << "Router: " << config_.router_stages << " etapas | enlace: " << config_.link_bits
+              << " bits | VCs: " << config_.virtual_channels << " | controladores de RAM en nodos:";
+    for (size_t node : memory_nodes_) {
+        std::cout << " " << node;
+    }
+    std::cout << std::endl;
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Ciclos: " << cycle_ << " | transacciones: " << completed_;
+    if (cycle_ > 0) {
+        std::cout << " | throughput: " << static_cast<double>(completed_) / cycle_ << " trans/ciclo";
+    }
+    std::cout << std::endl;
+    if (completed_ > 0) {
+        std::cout << "Latencia media: " << static_cast<double>(total_latency_) / completed_
+                  << " ciclos (un miss del PE no completa antes de su respuesta)" << std::endl;
+    }
+    if (packets_ > 0) {
+        std::cout << "Paquetes: " << packets_ << " (" << flits_ << " flits) | saltos/paquete: "
+                  << static_cast<double>(hop_count_) / packets_ << " | contención/paquete: "
+                  << static_cast<double>(contention_cycles_) / packets_ << " ciclos" << std::endl;
+    }
+
+    uint64_t busiest = 0;
+    uint64_t busy_total = 0;
+    size_t used_links = 0;
+    for (const Link& link : links_) {
+        if (link.busy_cycles > 0) {
+            busiest = std::max(busiest, link.busy_cycles);
+            busy_total += link.busy_cycles;
+            used_links++;
+        }
+    }
+    if (cycle_ > 0 && used_links > 0) {
+        std::cout << "Utilización de enlaces: media=" << 100.0 * busy_total / used_links / cycle_
+                  << "% (" << used_links << " enlaces usados) máx=" << 100.0 * busiest / cycle_ << "%" << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
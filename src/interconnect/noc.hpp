@@ -0,0 +1,115 @@
+#ifndef NOC_HPP
+#define NOC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <queue>
+#include <string>
+#include <vector>
+#include "../bus/bus.hpp"
+
+enum class NoCTopology {
+    MESH,  // Malla 2D con ruteo XY
+    RING   // Anillo bidireccional, por el sentido más corto
+};
+
+const char* nocTopologyName(NoCTopology topology);
+// Acepta "mesh", "ring"
+bool parseNoCTopology(const std::string& text, NoCTopology& topology);
+
+struct NoCConfig {
+    NoCTopology topology = NoCTopology::MESH;
+    size_t router_stages = 2;      // Etapas del pipeline de cada router
+    size_t link_bits = 64;         // Ancho de enlace = tamaño de flit
+    size_t virtual_channels = 2;   // Por enlace
+    size_t memory_controllers = 1; // Nodos con controlador de RAM
+    size_t memory_latency = 4;     // Acceso a RAM en el controlador
+    size_t max_outstanding = 4;    // Transacciones en vuelo por PE
+};
+
+// ------------------------------------------------------------
+// Red en chip como modelo de tiempo alternativo al bus compartido. El PE i
+// está en el nodo i; los controladores de RAM se reparten (esquinas de la
+// malla, equiespaciados en el anillo) y los bloques se entrelazan entre
+// ellos. Cada transacción es una secuencia de paquetes:
+//   BusRd:   solicitud PE -> home, memoria, datos home -> PE
+//   BusRdX:  igual, y además invalidación + ack a cada otro PE
+//   BusUpgr: solicitud, invalidaciones + acks, ack home -> PE
+//   BusWB:   datos PE -> home
+// Un paquete de control es un flit; uno de datos, cabecera + bloque. En
+// cada salto el paquete atraviesa el router (router_stages ciclos), espera
+// un VC libre y el enlace físico, y lo ocupa un ciclo por flit. El VC queda
+// tomado hasta que la cola sale del router siguiente. Las reservas se
+// hacen en orden de inyección. La transacción termina con el último
+// paquete; entonces el Interconnect entrega la respuesta y el miss del PE
+// puede completar, así que saltos, contención y memoria retrasan al PE.
+// ------------------------------------------------------------
+class NetworkOnChip {
+public:
+    // Lanza std::invalid_argument con etapas, ancho, VCs, controladores o
+    // max_outstanding en cero, o con más controladores que nodos
+    NetworkOnChip(const NoCConfig& config, size_t num_pes);
+
+    // Cada PE inyecta en su propio router: hasta max_outstanding en vuelo
+    bool canInject(size_t pe_id) const;
+    // Inyecta en el ciclo actual; la llegada a la cola es transaction.arrival_cycle
+    void inject(const BusTransaction& transaction, size_t block_bytes);
+    // Avanza un ciclo; las transacciones terminadas quedan en `completed`
+    void tick(std::vector<BusTransaction>& completed);
+
+    bool idle() const { return in_flight_.empty(); }
+    uint64_t getCycle() const { return cycle_; }
+    size_t getNodeCount() const { return nodes_; }
+    size_t getHomeNode(uint32_t word_address, size_t block_bytes) const;
+    const std::vector<size_t>& getMemoryNodes() const { return memory_nodes_; }
+    // Saltos entre dos nodos con el ruteo configurado
+    size_t hops(size_t src, size_t dst) const;
+
+    uint64_t getCompleted() const { return completed_; }
+    uint64_t getPackets() const { return packets_; }
+    uint64_t getTotalLatency() const { return total_latency_; }
+    uint64_t getContentionCycles() const { return contention_cycles_; }
+    void printStats() const;
+
+private:
+    enum Direction { EAST, WEST, NORTH, SOUTH, DIRECTIONS };
+
+    struct Link {
+        uint64_t free_at = 0;           // Enlace físico libre
+        std::vector<uint64_t> vc_free;  // Cada VC libre
+        uint64_t busy_cycles = 0;
+    };
+
+    struct Pending {
+        uint64_t done;
+        BusTransaction transaction;
+        bool operator>(const Pending& other) const { return done > other.done; }
+    };
+
+    NoCConfig config_;
+    size_t num_pes_;
+    size_t nodes_;
+    size_t cols_;
+    size_t rows_;
+    std::vector<size_t> memory_nodes_;
+    std::vector<Link> links_;  // nodo * DIRECTIONS + dirección de salida
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> in_flight_;
+    std::vector<size_t> outstanding_;
+    uint64_t cycle_ = 0;
+
+    uint64_t completed_ = 0;
+    uint64_t packets_ = 0;
+    uint64_t flits_ = 0;
+    uint64_t hop_count_ = 0;
+    uint64_t total_latency_ = 0;
+    uint64_t contention_cycles_ = 0;  // Espera por VC o enlace ocupado
+
+    Direction route(size_t node, size_t dst) const;
+    size_t neighbor(size_t node, Direction direction) const;
+    // Devuelve el ciclo en que la cola del paquete llega a dst
+    uint64_t send(size_t src, size_t dst, size_t flits, uint64_t start);
+    // Invalidación a cada otro PE y ack de vuelta al home; ciclo del último ack
+    uint64_t invalidateOthers(size_t home, size_t requester, uint64_t start);
+};
+
+#endif // NOC_HPP
@@ -0,0 +1,147 @@
+#include "snoop_filter.hpp"
+#include <stdexcept>
+
+const char* snoopFilterKindName(SnoopFilterKind kind) {
+    switch (kind) {
+        case SnoopFilterKind::NONE:     return "none";
+        case SnoopFilterKind::PRESENCE: return "presence";
+        case SnoopFilterKind::BLOOM:    return "bloom";
+        default: return "?";
+    }
+}
+
+bool parseSnoopFilterKind(const std::string& text, SnoopFilterKind& kind) {
+    if (text == "none")          kind = SnoopFilterKind::NONE;
+    else if (text == "presence") kind = SnoopFilterKind::PRESENCE;
+    else if (text == "bloom")    kind = SnoopFilterKind::BLOOM;
+    else return false;
+    return true;
+}
+
+// ============================================================
+// VECTOR DE PRESENCIA
+// ============================================================
+
+PresenceSnoopFilter::PresenceSnoopFilter(size_t num_pes)
+    : num_pes_(num_pes), words_((num_pes + 63) / 64) {
+    if (num_pes == 0) {
+        throw std::invalid_argument("PresenceSnoopFilter: se necesita al menos una caché");
+    }
+}
+
+void PresenceSnoopFilter::insert(uint64_t block, int pe_id) {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= num_pes_) {
+        throw std::out_of_range("PresenceSnoopFilter: PE fuera de rango");
+    }
+    presence_[key(block, pe_id)] |= 1ull << (pe_id % 64);
+}
+
+void PresenceSnoopFilter::remove(uint64_t block, int pe_id) {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= num_pes_) {
+        return;
+    }
+    auto it = presence_.find(key(block, pe_id));
+    if (it == presence_.end()) {
+        return;
+    }
+    it->second &= ~(1ull << (pe_id % 64));
+    if (it->second == 0) {
+        presence_.erase(it);
+    }
+}
+
+bool PresenceSnoopFilter::mayHold(uint64_t block, int pe_id) const {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= num_pes_) {
+        return false;
+    }
+    auto it = presence_.find(key(block, pe_id));
+    return it != presence_.end() && (it->second & (1ull << (pe_id % 64))) != 0;
+}
+
+size_t PresenceSnoopFilter::footprintBytes() const {
+    return presence_.size() * (sizeof(uint64_t) + sizeof(uint64_t));
+}
+
+// ============================================================
+// COUNTING BLOOM
+// ============================================================
+
+BloomSnoopFilter::BloomSnoopFilter(size_t counters) : counters_(counters) {
+    if (counters_ == 0) {
+        throw std::invalid_argument("BloomSnoopFilter: se necesita al menos un contador");
+    }
+}
+
+size_t BloomSnoopFilter::slot(uint64_t block, size_t hash) const {
+    // Mezcla de splitmix64 con una semilla distinta por función
+    uint64_t x = block + 0x9E3779B97F4A7C15ull * (hash + 1);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return static_cast<size_t>(x % counters_);
+}
+
+void BloomSnoopFilter::insert(uint64_t block, int pe_id) {
+    if (pe_id < 0) {
+        throw std::out_of_range("BloomSnoopFilter: PE inválido");
+    }
+    if (static_cast<size_t>(pe_id) >= filters_.size()) {
+        filters_.resize(pe_id + 1);
+    }
+    std::vector<uint8_t>& filter = filters_[pe_id];
+    if (filter.empty()) {
+        filter.assign(counters_, 0);
+    }
+    for (size_t h = 0; h < HASHES; h++) {
+        uint8_t& counter = filter[slot(block, h)];
+        if (counter != UINT8_MAX) {
+            counter++;
+        }
+    }
+}
+
+void BloomSnoopFilter::remove(uint64_t block, int pe_id) {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= filters_.size() || filters_[pe_id].empty()) {
+        return;
+    }
+    std::vector<uint8_t>& filter = filters_[pe_id];
+    for (size_t h = 0; h < HASHES; h++) {
+        uint8_t& counter = filter[slot(block, h)];
+        if (counter != 0 && counter != UINT8_MAX) {
+            counter--;
+        }
+    }
+}
+
+bool BloomSnoopFilter::mayHold(uint64_t block, int pe_id) const {
+    if (pe_id < 0 || static_cast<size_t>(pe_id) >= filters_.size() || filters_[pe_id].empty()) {
+        return false;
+    }
+    const std::vector<uint8_t>& filter = filters_[pe_id];
+    for (size_t h = 0; h < HASHES; h++) {
+        if (filter[slot(block, h)] == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t BloomSnoopFilter::footprintBytes() const {
+    size_t bytes = 0;
+    for (const std::vector<uint8_t>& filter : filters_) {
+        bytes += filter.size();
+    }
+    return bytes;
+}
+
+std::unique_ptr<SnoopFilter> createSnoopFilter(SnoopFilterKind kind, size_t bloom_counters, size_t num_pes) {
+    switch (kind) {
+        case SnoopFilterKind::PRESENCE:
+            return std::make_unique<PresenceSnoopFilter>(num_pes);
+        case SnoopFilterKind::BLOOM:
+            return std::make_unique<BloomSnoopFilter>(bloom_counters);
+        case SnoopFilterKind::NONE:
+        default:
+            return nullptr;
+    }
+}
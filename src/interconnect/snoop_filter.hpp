@@ -0,0 +1,85 @@
+#ifndef SNOOP_FILTER_HPP
+#define SNOOP_FILTER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Filtros disponibles junto al Interconnect
+enum class SnoopFilterKind {
+    NONE,       // Broadcast a todas las cachés
+    PRESENCE,   // Vector de presencia exacto por bloque
+    BLOOM       // Counting Bloom filter por caché (memoria fija, falsos positivos)
+};
+
+const char* snoopFilterKindName(SnoopFilterKind kind);
+// Acepta "none", "presence", "bloom"
+bool parseSnoopFilterKind(const std::string& text, SnoopFilterKind& kind);
+
+// ------------------------------------------------------------
+// Registra qué cachés pueden tener cada bloque. Las direcciones son
+// números de bloque. mayHold nunca debe dar un falso negativo: insert se
+// llama en cada fill (BusRd/BusRdX) y remove sólo cuando la línea sale de
+// una caché que la tenía, así que un remove siempre empareja un insert.
+// Las salidas que no se avisan (back-invalidations de la L2, bloques
+// descartados de un stream buffer) sólo dejan entradas de más.
+// ------------------------------------------------------------
+class SnoopFilter {
+public:
+    virtual ~SnoopFilter() = default;
+
+    virtual SnoopFilterKind kind() const = 0;
+    virtual void insert(uint64_t block, int pe_id) = 0;
+    virtual void remove(uint64_t block, int pe_id) = 0;
+    virtual bool mayHold(uint64_t block, int pe_id) const = 0;
+    // Memoria ocupada por el estado del filtro
+    virtual size_t footprintBytes() const = 0;
+};
+
+// Vector de presencia exacto: un bit por caché y bloque, en palabras de 64
+// cachés (sólo se guardan las palabras con algún bit)
+class PresenceSnoopFilter : public SnoopFilter {
+public:
+    explicit PresenceSnoopFilter(size_t num_pes = 64);
+
+    SnoopFilterKind kind() const override { return SnoopFilterKind::PRESENCE; }
+    void insert(uint64_t block, int pe_id) override;
+    void remove(uint64_t block, int pe_id) override;
+    bool mayHold(uint64_t block, int pe_id) const override;
+    size_t footprintBytes() const override;
+
+private:
+    size_t num_pes_;
+    size_t words_;                                   // Palabras de 64 bits por bloque
+    std::unordered_map<uint64_t, uint64_t> presence_;  // (bloque, palabra) -> bits
+
+    uint64_t key(uint64_t block, int pe_id) const { return block * words_ + pe_id / 64; }
+};
+
+// Un counting Bloom filter por caché: HASHES contadores de 8 bits por
+// bloque. Un contador saturado queda fijo (nunca se decrementa).
+class BloomSnoopFilter : public SnoopFilter {
+public:
+    static constexpr size_t HASHES = 2;
+
+    explicit BloomSnoopFilter(size_t counters);
+
+    SnoopFilterKind kind() const override { return SnoopFilterKind::BLOOM; }
+    void insert(uint64_t block, int pe_id) override;
+    void remove(uint64_t block, int pe_id) override;
+    bool mayHold(uint64_t block, int pe_id) const override;
+    size_t footprintBytes() const override;
+
+private:
+    size_t counters_;
+    std::vector<std::vector<uint8_t>> filters_;  // Uno por caché, creado al primer insert
+
+    size_t slot(uint64_t block, size_t hash) const;
+};
+
+std::unique_ptr<SnoopFilter> createSnoopFilter(SnoopFilterKind kind, size_t bloom_counters, size_t num_pes = 64);
+
+#endif // SNOOP_FILTER_HPP
@@ -0,0 +1,153 @@
+#include "split_bus.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+size_t beats(size_t bits, size_t width) {
+    return (bits + width - 1) / width;
+}
+
+double percent(uint64_t part, uint64_t total) {
+    return total == 0 ? 0.0 : 100.0 * part / total;
+}
+
+}
+
+SplitTransactionBus::SplitTransactionBus(const BusTimingConfig& config, size_t num_pes)
+    : config_(config)
+    , request_cycles_(0)
+    , pe_stats_(num_pes) {
+    if (config.request_latency == 0 || config.address_bus_bits == 0 ||
+        config.data_bus_bits == 0 || config.max_outstanding == 0) {
+        throw std::invalid_argument("SplitTransactionBus: latencia de solicitud, anchos y "
+                                    "max_outstanding deben ser mayores que cero");
+    }
+    request_cycles_ = config.request_latency * beats(REQUEST_BITS, config.address_bus_bits);
+}
+
+bool SplitTransactionBus::canIssue() const {
+    return cycle_ >= address_busy_until_ && in_flight_.size() < config_.max_outstanding;
+}
+
+void SplitTransactionBus::issue(const BusTransaction& transaction, size_t block_bytes) {
+    InFlight entry;
+    entry.transaction = transaction;
+    entry.phase = Phase::REQUEST;
+    entry.phase_end = cycle_ + request_cycles_;
+    entry.data_beats = transaction.type == BusTransactionType::BusUpgr
+                           ? 0 : beats(block_bytes * 8, config_.data_bus_bits);
+    in_flight_.push_back(entry);
+
+    address_busy_until_ = entry.phase_end;
+    address_busy_cycles_ += request_cycles_;
+    peak_outstanding_ = std::max(peak_outstanding_, in_flight_.size());
+
+    BusPEStats& stats = pe_stats_[transaction.pe_id];
+    uint64_t queued = cycle_ - std::min(cycle_, transaction.arrival_cycle);
+    stats.queue_cycles += queued;
+    stats.max_queue_cycles = std::max(stats.max_queue_cycles, queued);
+}
+
+void SplitTransactionBus::noteBlockedRequest() {
+    if (in_flight_.size() >= config_.max_outstanding) {
+        outstanding_stalls_++;
+    }
+}
+
+// Pasa a la fase siguiente todas las fases vencidas (las de latencia cero
+// se atraviesan en el mismo ciclo). La fase de datos la asigna tick().
+void SplitTransactionBus::advance(InFlight& entry) {
+    while (cycle_ >= entry.phase_end) {
+        switch (entry.phase) {
+            case Phase::REQUEST:
+                entry.phase = Phase::SNOOP;
+                entry.phase_end = cycle_ + config_.snoop_latency;
+                break;
+            case Phase::SNOOP:
+                if (entry.data_beats == 0) {
+                    entry.phase = Phase::DONE;
+                    return;
+                }
+                entry.phase = Phase::MEMORY;
+                entry.phase_end = cycle_ + (entry.transaction.type == BusTransactionType::BusWB
+                                                ? 0 : config_.data_latency);
+                break;
+            case Phase::MEMORY:
+                entry.phase = Phase::WAIT_DATA;
+                return;
+            case Phase::DATA:
+                entry.phase = Phase::DONE;
+                return;
+            case Phase::WAIT_DATA:
+            case Phase::DONE:
+                return;
+        }
+    }
+}
+
+void SplitTransactionBus::tick(std::vector<BusTransaction>& completed) {
+    cycle_++;
+
+    for (InFlight& entry : in_flight_) {
+        advance(entry);
+    }
+
+    // El bus de datos atiende a la más antigua que tenga el dato listo
+    if (cycle_ >= data_busy_until_) {
+        for (InFlight& entry : in_flight_) {
+            if (entry.phase == Phase::WAIT_DATA) {
+                entry.phase = Phase::DATA;
+                entry.phase_end = cycle_ + entry.data_beats;
+                data_busy_until_ = entry.phase_end;
+                data_busy_cycles_ += entry.data_beats;
+                break;
+            }
+        }
+    }
+
+    auto done = [](const InFlight& entry) { return entry.phase == Phase::DONE; };
+    for (const InFlight& entry : in_flight_) {
+        if (done(entry)) {
+            BusPEStats& stats = pe_stats_[entry.transaction.pe_id];
+            stats.transactions++;
+            stats.latency_cycles += cycle_ - std::min(cycle_, entry.transaction.arrival_cycle);
+            completed_++;
+            completed.push_back(entry.transaction);
+        }
+    }
+    in_flight_.erase(std::remove_if(in_flight_.begin(), in_flight_.end(), done), in_flight_.end());
+}
+
+void SplitTransactionBus::printStats() const {
+    std::cout << "\n=== Split-Transaction Bus ===" << std::endl;
+    std::cout << "Latencias: request=" << config_.request_latency << " snoop=" << config_.snoop_latency
+              << " data=" << config_.data_latency << " | anchos: address=" << config_.address_bus_bits
+              << " data=" << config_.data_bus_bits << " bits | max outstanding="
+              << config_.max_outstanding << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Ciclos: " << cycle_ << " | transacciones: " << completed_;
+    if (cycle_ > 0) {
+        std::cout << " | throughput: " << static_cast<double>(completed_) / cycle_ << " trans/ciclo";
+    }
+    std::cout << std::endl;
+    std::cout << "Utilización: address=" << percent(address_busy_cycles_, cycle_) << "% data="
+              << percent(data_busy_cycles_, cycle_) << "%" << std::endl;
+    std::cout << "Outstanding: pico=" << peak_outstanding_ << " ciclos bloqueados por el tope="
+              << outstanding_stalls_ << std::endl;
+
+    for (size_t pe = 0; pe < pe_stats_.size(); pe++) {
+        const BusPEStats& s = pe_stats_[pe];
+        if (s.transactions == 0) {
+            continue;
+        }
+        std::cout << "  PE" << pe << ": transacciones=" << s.transactions
+                  << " cola media=" << static_cast<double>(s.queue_cycles) / s.transactions
+                  << " (máx " << s.max_queue_cycles << ")"
+                  << " latencia media hasta la respuesta=" << static_cast<double>(s.latency_cycles) / s.transactions
+                  << std::endl;
+    }
+    std::cout << std::defaultfloat;
+}
@@ -0,0 +1,94 @@
+#ifndef SPLIT_BUS_HPP
+#define SPLIT_BUS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "../bus/bus.hpp"
+
+struct BusTimingConfig {
+    size_t request_latency = 1;    // Ciclos por beat en el bus de direcciones
+    size_t snoop_latency = 2;      // Respuesta de las cachés (no ocupa el bus)
+    size_t data_latency = 4;       // Acceso a memoria antes de la fase de datos
+    size_t address_bus_bits = 32;
+    size_t data_bus_bits = 64;
+    size_t max_outstanding = 4;    // Transacciones entre la solicitud y el último beat de datos
+};
+
+// Por PE solicitante
+struct BusPEStats {
+    uint64_t transactions = 0;
+    uint64_t queue_cycles = 0;     // Desde la llegada al ring hasta ganar el bus de direcciones
+    uint64_t latency_cycles = 0;   // Desde la llegada hasta el último beat de datos (el miss espera)
+    uint64_t max_queue_cycles = 0;
+};
+
+// ------------------------------------------------------------
+// Bus de transacción partida: cada transacción pasa por
+//   solicitud (bus de direcciones) -> snoop -> [memoria] -> datos (bus de datos)
+// y suelta el bus de direcciones al terminar la solicitud, así que varias
+// transacciones pueden estar en vuelo hasta max_outstanding. Los datos
+// salen en orden de solicitud. BusUpgr no tiene fase de datos y BusWB no
+// espera a la memoria. El reloj lo avanza quien llama a tick().
+// Al terminar, el Interconnect entrega la respuesta (BusTransaction::
+// delivered) y recién entonces el MSHR del PE solicitante puede completar:
+// la cola y las fases del bus retrasan al PE.
+// ------------------------------------------------------------
+class SplitTransactionBus {
+public:
+    static constexpr size_t REQUEST_BITS = 32;  // Dirección + comando de una solicitud
+
+    // Lanza std::invalid_argument con latencia de solicitud, anchos o
+    // max_outstanding en cero
+    SplitTransactionBus(const BusTimingConfig& config, size_t num_pes);
+
+    // Bus de direcciones libre y hueco para otra transacción en vuelo
+    bool canIssue() const;
+    // Empieza la fase de solicitud en el ciclo actual. La llegada es
+    // transaction.arrival_cycle; los datos ocupan block_bytes.
+    void issue(const BusTransaction& transaction, size_t block_bytes);
+    // Hay una solicitud esperando y no pudo emitirse en este ciclo
+    void noteBlockedRequest();
+    // Avanza un ciclo; las transacciones terminadas quedan en `completed`
+    void tick(std::vector<BusTransaction>& completed);
+
+    bool idle() const { return in_flight_.empty(); }
+    uint64_t getCycle() const { return cycle_; }
+    size_t getOutstanding() const { return in_flight_.size(); }
+    const BusTimingConfig& getConfig() const { return config_; }
+    const BusPEStats& getPEStats(size_t pe_id) const { return pe_stats_[pe_id]; }
+    uint64_t getCompleted() const { return completed_; }
+    uint64_t getAddressBusyCycles() const { return address_busy_cycles_; }
+    uint64_t getDataBusyCycles() const { return data_busy_cycles_; }
+    uint64_t getOutstandingStalls() const { return outstanding_stalls_; }
+    size_t getPeakOutstanding() const { return peak_outstanding_; }
+    void printStats() const;
+
+private:
+    enum class Phase { REQUEST, SNOOP, MEMORY, WAIT_DATA, DATA, DONE };
+
+    struct InFlight {
+        BusTransaction transaction;
+        Phase phase;
+        uint64_t phase_end;   // Ciclo en que termina la fase actual
+        size_t data_beats;    // 0: sin fase de datos
+    };
+
+    BusTimingConfig config_;
+    size_t request_cycles_;
+    uint64_t cycle_ = 0;
+    uint64_t address_busy_until_ = 0;
+    uint64_t data_busy_until_ = 0;
+    std::vector<InFlight> in_flight_;  // En orden de solicitud
+
+    std::vector<BusPEStats> pe_stats_;
+    uint64_t completed_ = 0;
+    uint64_t address_busy_cycles_ = 0;
+    uint64_t data_busy_cycles_ = 0;
+    uint64_t outstanding_stalls_ = 0;  // Ciclos con solicitud esperando por el tope
+    size_t peak_outstanding_ = 0;
+
+    void advance(InFlight& entry);
+};
+
+#endif // SPLIT_BUS_HPP
@@ -0,0 +1,102 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Ring acotado de un productor y un consumidor, sin locks. El productor sólo
+// escribe tail_ y el consumidor sólo head_; cada índice vive en su propia
+// línea de caché junto con la copia local del índice del otro lado, así que
+// en régimen normal ninguno de los dos invalida la línea del otro.
+template <typename T>
+class SpscRing {
+public:
+    static constexpr size_t CACHE_LINE = 64;
+
+    // La capacidad se redondea a la siguiente potencia de dos
+    explicit SpscRing(size_t capacity)
+        : mask_(roundUp(capacity) - 1)
+        , slots_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Sólo el productor. false si el ring está lleno.
+    bool tryPush(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                full_count_.store(full_count_.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Sólo el consumidor. false si el ring está vacío.
+    bool tryPop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        item = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Sólo el consumidor: primera entrada sin sacarla (nullptr si está vacío)
+    const T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // Desde cualquier hilo; es sólo una foto del estado
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask_ + 1; }
+    // Intentos de push rechazados por ring lleno
+    uint64_t getFullCount() const { return full_count_.load(std::memory_order_relaxed); }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    // Lado del consumidor
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // Lado del productor
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    std::atomic<uint64_t> full_count_{0};
+
+    // Sólo lectura tras la construcción
+    alignas(CACHE_LINE) const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+};
+
+#endif // SPSC_RING_HPP
@@ -0,0 +1,184 @@
+#include "transaction_trace.hpp"
+#include <stdexcept>
+
+namespace {
+
+void putVarint(uint64_t value, std::vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}
+
+// ============================================================
+// HISTORIAL ACOTADO
+// ============================================================
+
+TraceRing::TraceRing(size_t capacity) : slots_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("TraceRing: la capacidad debe ser mayor que cero");
+    }
+}
+
+void TraceRing::push(const TraceRecord& record) {
+    slots_[total_ % slots_.size()] = record;
+    total_++;
+}
+
+const TraceRecord& TraceRing::operator[](size_t i) const {
+    return slots_[(total_ - size() + i) % slots_.size()];
+}
+
+// ============================================================
+// ESCRITOR
+// ============================================================
+
+TraceWriter::TraceWriter(const std::string& path)
+    : out_(path, std::ios::binary | std::ios::trunc) {
+    if (!out_) {
+        throw std::runtime_error("TraceWriter: no se pudo crear " + path);
+    }
+    out_.write(trace_format::MAGIC, sizeof(trace_format::MAGIC));
+    out_.put(static_cast<char>(trace_format::VERSION));
+    bytes_ = sizeof(trace_format::MAGIC) + 1;
+    filling_.reserve(BATCH);
+    handoff_.reserve(BATCH);
+    thread_ = std::thread(&TraceWriter::run, this);
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+void TraceWriter::append(const TraceRecord& record) {
+    filling_.push_back(record);
+    if (filling_.size() >= BATCH) {
+        handOff();
+    }
+}
+
+// Entrega el lote lleno; espera si el escritor todavía no tomó el anterior
+void TraceWriter::handOff() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] { return handoff_.empty(); });
+    handoff_.swap(filling_);
+    ready_.notify_one();
+}
+
+void TraceWriter::close() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    if (!filling_.empty()) {
+        handOff();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    ready_.notify_one();
+    thread_.join();
+    out_.close();
+}
+
+void TraceWriter::run() {
+    std::vector<TraceRecord> batch;
+    batch.reserve(BATCH);
+    std::vector<uint8_t> bytes;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return !handoff_.empty() || closing_; });
+            if (handoff_.empty()) {
+                break;
+            }
+            batch.swap(handoff_);
+        }
+        drained_.notify_one();
+
+        bytes.clear();
+        for (const TraceRecord& record : batch) {
+            encode(record, bytes);
+        }
+        out_.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        records_ += batch.size();
+        bytes_ += bytes.size();
+        batch.clear();
+    }
+    out_.flush();
+}
+
+void TraceWriter::encode(const TraceRecord& record, std::vector<uint8_t>& out) {
+    const BusTransaction& t = record.transaction;
+    out.push_back(static_cast<uint8_t>(t.type));
+    putVarint(t.pe_id, out);
+    putVarint(zigzag(static_cast<int64_t>(t.address) - static_cast<int64_t>(last_address_)), out);
+    putVarint(zigzag(static_cast<int64_t>(record.cycle - last_cycle_)), out);
+    putVarint(record.cycle - std::min(record.cycle, t.arrival_cycle), out);
+    putVarint(t.data, out);
+    last_address_ = t.address;
+    last_cycle_ = record.cycle;
+}
+
+// ============================================================
+// LECTOR
+// ============================================================
+
+TraceReader::TraceReader(const std::string& path) : in_(path, std::ios::binary) {
+    if (!in_) {
+        throw std::runtime_error("TraceReader: no se pudo abrir " + path);
+    }
+    char header[sizeof(trace_format::MAGIC) + 1];
+    if (!in_.read(header, sizeof(header)) ||
+        !std::equal(header, header + sizeof(trace_format::MAGIC), trace_format::MAGIC) ||
+        static_cast<uint8_t>(header[sizeof(trace_format::MAGIC)]) != trace_format::VERSION) {
+        throw std::runtime_error("TraceReader: " + path + " no es una traza de bus válida");
+    }
+}
+
+bool TraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        int byte = in_.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    int type = in_.get();
+    if (type == std::char_traits<char>::eof()) {
+        return false;
+    }
+    uint64_t pe, address_delta, cycle_delta, wait, data;
+    if (type > static_cast<int>(BusTransactionType::BusWB) ||
+        !readVarint(pe) || !readVarint(address_delta) || !readVarint(cycle_delta) ||
+        !readVarint(wait) || !readVarint(data)) {
+        throw std::runtime_error("TraceReader: registro truncado o corrupto");
+    }
+    last_address_ = static_cast<uint32_t>(last_address_ + unzigzag(address_delta));
+    last_cycle_ += static_cast<uint64_t>(unzigzag(cycle_delta));
+
+    record.cycle = last_cycle_;
+    record.transaction = BusTransaction{static_cast<BusTransactionType>(type), last_address_,
+                                        static_cast<uint32_t>(pe), data};
+    record.transaction.arrival_cycle = last_cycle_ - std::min(last_cycle_, wait);
+    return true;
+}
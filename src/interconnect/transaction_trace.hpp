@@ -0,0 +1,117 @@
+#ifndef TRANSACTION_TRACE_HPP
+#define TRANSACTION_TRACE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../bus/bus.hpp"
+
+// Transacción terminada y el ciclo del bus en que terminó
+struct TraceRecord {
+    uint64_t cycle = 0;
+    BusTransaction transaction{};
+};
+
+// ------------------------------------------------------------
+// Historial acotado: conserva las últimas `capacity` transacciones y
+// sobrescribe las más viejas, así que la memoria no crece con la corrida.
+// Sólo lo usa el hilo consumidor del Interconnect.
+// ------------------------------------------------------------
+class TraceRing {
+public:
+    // Lanza std::invalid_argument con capacidad cero
+    explicit TraceRing(size_t capacity);
+
+    void push(const TraceRecord& record);
+    // i = 0 es la más antigua que se conserva
+    const TraceRecord& operator[](size_t i) const;
+    size_t size() const { return static_cast<size_t>(std::min<uint64_t>(total_, slots_.size())); }
+    size_t capacity() const { return slots_.size(); }
+    // Todas las que pasaron, incluidas las ya sobrescritas
+    uint64_t total() const { return total_; }
+
+private:
+    std::vector<TraceRecord> slots_;
+    uint64_t total_ = 0;
+};
+
+// ------------------------------------------------------------
+// Traza binaria compacta. Enteros en LEB128; los deltas con signo, en
+// zigzag, así que en una ráfaga sobre el mismo bloque cada transacción
+// ocupa ~5 bytes más los del dato:
+//   cabecera: "BTRC" + versión (1 byte)
+//   registro: tipo (1 byte), pe, Δdirección, Δciclo, espera, dato
+// La espera es ciclo - arrival_cycle; el id no se guarda.
+// ------------------------------------------------------------
+namespace trace_format {
+constexpr char MAGIC[4] = {'B', 'T', 'R', 'C'};
+constexpr uint8_t VERSION = 1;
+}
+
+// Escritor en segundo plano con doble buffer: el consumidor llena un lote
+// sin locks y lo entrega entero; el hilo escritor lo codifica y lo vuelca.
+// Si el disco no da abasto el consumidor espera, la memoria no crece.
+class TraceWriter {
+public:
+    static constexpr size_t BATCH = 4096;
+
+    // Lanza std::runtime_error si no puede crear el archivo
+    explicit TraceWriter(const std::string& path);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Sólo el hilo consumidor
+    void append(const TraceRecord& record);
+    // Vuelca lo pendiente y termina el hilo escritor (idempotente)
+    void close();
+
+    // Válidos tras close()
+    uint64_t getRecords() const { return records_; }
+    uint64_t getBytes() const { return bytes_; }
+
+private:
+    void run();
+    void encode(const TraceRecord& record, std::vector<uint8_t>& out);
+    void handOff();
+
+    std::ofstream out_;
+    std::vector<TraceRecord> filling_;  // Sólo el consumidor
+    std::vector<TraceRecord> handoff_;  // Protegido por mutex_
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable drained_;
+    bool closing_ = false;
+    std::thread thread_;
+
+    // Estado del codificador (sólo el hilo escritor)
+    uint32_t last_address_ = 0;
+    uint64_t last_cycle_ = 0;
+    uint64_t records_ = 0;
+    uint64_t bytes_ = 0;
+};
+
+class TraceReader {
+public:
+    // Lanza std::runtime_error si no puede abrirlo o la cabecera no es válida
+    explicit TraceReader(const std::string& path);
+
+    // false al final del archivo; lanza std::runtime_error si está truncado
+    bool next(TraceRecord& record);
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::ifstream in_;
+    uint32_t last_address_ = 0;
+    uint64_t last_cycle_ = 0;
+};
+
+#endif // TRANSACTION_TRACE_HPP
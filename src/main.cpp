@@ -1,17 +1,26 @@
 #include "Loader/Loader.hpp"
 #include "PE/PE.hpp"
 #include "cache/cache.hpp"
+#include "cache/l2_cache.hpp"
 #include "bus/bus.hpp"
 #include "ram/ram.hpp"
 #include "interconnect/interconnect.hpp"
+#include "interconnect/directory.hpp"
 #include "bus/bus_controller.hpp"
+#include "Trace/Trace.hpp"
 #include <iostream>
 #include <cstring>
 #include <fstream>
 #include <vector>
+#include <deque>
+#include <atomic>
 #include <iomanip>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <cmath>
+#include <algorithm>
+#include <sstream>
 
 // ============================================================
 // ADAPTER: Convierte entre estructuras de Cache y Interconnect
@@ -38,7 +47,14 @@ class InterconnectBusInterface : public IBusInterface {
     std::shared_ptr<Interconnect> interconnect;
     std::shared_ptr<RAM> ram;
     std::shared_ptr<BusController> bus_controller;
+    std::shared_ptr<SharedL2Cache> l2;  // nullptr: las L1 van directo a RAM
+    std::shared_ptr<Directory> directory;  // nullptr: coherencia por snooping
     int pe_id;
+    std::vector<BusTransaction> outbox;  // Emitidas bajo los locks de coherencia, aún no en el ring
+    // Avisos de entrega de los misses en vuelo (ticket = índice + 1). El
+    // deque no mueve sus elementos al crecer: el árbitro escribe por puntero.
+    std::deque<std::atomic<bool>> responses;
+    std::vector<size_t> free_responses;
     
 public:
     InterconnectBusInterface(std::shared_ptr<Interconnect> ic, 
@@ -47,80 +63,180 @@ public:
                             int id)
         : interconnect(ic), ram(r), bus_controller(bc), pe_id(id) {}
     
+    void attachL2(std::shared_ptr<SharedL2Cache> shared_l2) { l2 = shared_l2; }
+    void attachDirectory(std::shared_ptr<Directory> dir) { directory = dir; }
+    
     void readFromMemory(uint64_t address, uint8_t* data, size_t size) override {
-        uint64_t block_address = (address / 32) * 32;
+        uint64_t block_address = (address / size) * size;
+        if (l2) {
+            l2->readBlock(pe_id, block_address, data, size);
+            return;
+        }
         size_t num_words = size / sizeof(uint64_t);
-        uint64_t word_addr = block_address / sizeof(uint64_t);
+        uint32_t ram_addr = static_cast<uint32_t>(block_address / sizeof(uint64_t));
         
-        std::cout << "[PE" << pe_id << " BusInterface] Reading from RAM: "
-                  << "byte_addr=0x" << std::hex << block_address 
-                  << " word_addr=" << std::dec << word_addr 
-                  << " (" << num_words << " words)" << std::endl;
+        TRACE(BUS, BASIC, "[PE" << pe_id << " BusInterface] Reading from RAM: "
+              << "byte_addr=0x" << std::hex << block_address 
+              << " word_addr=" << std::dec << ram_addr 
+              << " (" << num_words << " words)");
         
-        for (size_t i = 0; i < num_words; i++) {
-            uint32_t ram_addr = static_cast<uint32_t>(word_addr + i);
-            
-            if (ram_addr > RAM::MAX_ADDRESS) {
-                std::cerr << "Warning: RAM address 0x" << std::hex << ram_addr 
-                         << " exceeds MAX_ADDRESS, wrapping around" << std::endl;
-                ram_addr = ram_addr & RAM::MAX_ADDRESS;
-            }
-            
-            uint64_t word = ram->read(ram_addr);
-            std::memcpy(&data[i * sizeof(uint64_t)], &word, sizeof(uint64_t));
+        // Los bloques están alineados: basta con envolver la dirección inicial
+        if (ram_addr > RAM::MAX_ADDRESS) {
+            std::cerr << "Warning: RAM address 0x" << std::hex << ram_addr 
+                     << " exceeds MAX_ADDRESS, wrapping around" << std::dec << std::endl;
+            ram_addr = ram_addr & RAM::MAX_ADDRESS;
         }
+        
+        ram->readBlock(ram_addr, data, size);
     }
     
     void writeToMemory(uint64_t address, const uint8_t* data, size_t size) override {
-        uint64_t block_address = (address / 32) * 32;
+        uint64_t block_address = (address / size) * size;
+        if (l2) {
+            l2->writeBlock(pe_id, block_address, data, size);
+            return;
+        }
         size_t num_words = size / sizeof(uint64_t);
-        uint64_t word_addr = block_address / sizeof(uint64_t);
+        uint32_t ram_addr = static_cast<uint32_t>(block_address / sizeof(uint64_t));
         
-        std::cout << "[PE" << pe_id << " BusInterface] Writing to RAM: "
-                  << "byte_addr=0x" << std::hex << block_address 
-                  << " word_addr=" << std::dec << word_addr 
-                  << " (" << num_words << " words)" << std::endl;
+        TRACE(BUS, BASIC, "[PE" << pe_id << " BusInterface] Writing to RAM: "
+              << "byte_addr=0x" << std::hex << block_address 
+              << " word_addr=" << std::dec << ram_addr 
+              << " (" << num_words << " words)");
         
-        for (size_t i = 0; i < num_words; i++) {
-            uint32_t ram_addr = static_cast<uint32_t>(word_addr + i);
-            
-            if (ram_addr > RAM::MAX_ADDRESS) {
-                std::cerr << "Warning: RAM address 0x" << std::hex << ram_addr 
-                         << " exceeds MAX_ADDRESS, wrapping around" << std::endl;
-                ram_addr = ram_addr & RAM::MAX_ADDRESS;
-            }
-            
-            uint64_t word;
-            std::memcpy(&word, &data[i * sizeof(uint64_t)], sizeof(uint64_t));
-            ram->write(ram_addr, word);
+        // Los bloques están alineados: basta con envolver la dirección inicial
+        if (ram_addr > RAM::MAX_ADDRESS) {
+            std::cerr << "Warning: RAM address 0x" << std::hex << ram_addr 
+                     << " exceeds MAX_ADDRESS, wrapping around" << std::dec << std::endl;
+            ram_addr = ram_addr & RAM::MAX_ADDRESS;
         }
+        
+        ram->writeBlock(ram_addr, data, size);
     }
     
-    void sendMessage(const BusMessage& msg) override {
+    SnoopResponse sendMessage(const BusMessage& msg, uint8_t* block) override {
         BusTransaction transaction;
         transaction.type = busEventToTransactionType(msg.event);
-        transaction.address = static_cast<uint32_t>(msg.address / sizeof(uint64_t));
+        transaction.address = static_cast<uint32_t>(msg.address / sizeof(uint64_t)) & RAM::MAX_ADDRESS;
         transaction.pe_id = static_cast<uint32_t>(msg.sender_pe_id);
         transaction.data = 0;
         
-        std::cout << "[PE" << pe_id << "] Sending bus message: " 
-                  << transaction.toString() << std::endl;
+        TRACE(BUS, DETAIL, "[PE" << pe_id << "] Sending bus message: " 
+              << transaction.toString());
         
-        // Agregar transacción al Interconnect
-        interconnect->addRequest(transaction);
+        // La transacción va al ring del PE en flushRequests(), ya fuera de
+        // los locks de coherencia: con el ring lleno no se frena a los demás PEs
+        outbox.push_back(transaction);
         
-        // Enviar mensaje de broadcast directamente
-        interconnect->broadcastBusMessage(msg);
+        // Snoop en las demás cachés; una en M/E deja el bloque en `block`.
+        // Con directorio sólo se contacta al dueño y a los sharers registrados.
+        SnoopResponse response = directory ? directory->request(msg, block)
+                                           : interconnect->snoop(msg, block);
         
         // Notificar al bus controller
         bus_controller->notifyTransaction(msg.address, msg.sender_pe_id);
+        return response;
+    }
+    
+    void notifyEviction(uint64_t address, const uint8_t* data, size_t size, bool written_back) override {
+        if (directory) {
+            directory->noteEviction(address, pe_id);
+        } else {
+            interconnect->noteEviction(address, pe_id);
+        }
+        if (l2) {
+            l2->handleL1Eviction(pe_id, address, data, size, written_back);
+        }
+        if (written_back) {
+            // El bloque ya bajó con writeToMemory; el BusWB compite por el bus
+            // (en su propia clase con --wb-class) sin volver a escribirlo
+            BusTransaction transaction{BusTransactionType::BusWB,
+                                       static_cast<uint32_t>(address / sizeof(uint64_t)) & RAM::MAX_ADDRESS,
+                                       static_cast<uint32_t>(pe_id), 0};
+            transaction.posted = true;
+            outbox.push_back(transaction);
+        }
     }
     
-    void supplyData(uint64_t address, const uint8_t* data) override {
-        std::cout << "[PE" << pe_id << "] Supplying data for addr=0x" 
-                  << std::hex << address << std::dec 
-                  << " (cache-to-cache transfer)" << std::endl;
-        (void)data;
+    // El miss recién emitido es el último BusRd/BusRdX del outbox
+    uint64_t awaitResponse() override {
+        if (outbox.empty() || (outbox.back().type != BusTransactionType::BusRd &&
+                               outbox.back().type != BusTransactionType::BusRdX)) {
+            return 0;
+        }
+        size_t slot;
+        if (free_responses.empty()) {
+            slot = responses.size();
+            responses.emplace_back(false);
+        } else {
+            slot = free_responses.back();
+            free_responses.pop_back();
+        }
+        outbox.back().delivered = &responses[slot];
+        return slot + 1;
+    }
+    
+    bool responseArrived(uint64_t ticket) override {
+        std::atomic<bool>& flag = responses[ticket - 1];
+        if (!flag.load(std::memory_order_acquire)) {
+            return false;
+        }
+        flag.store(false, std::memory_order_relaxed);
+        free_responses.push_back(ticket - 1);
+        return true;
+    }
+    
+    // Corre en el hilo del PE que provocó el desalojo en L2: sólo se
+    // actualiza el registro de sharers, sin tocar el outbox de este PE
+    void notifyBackInvalidation(uint64_t address) override {
+        if (directory) {
+            directory->noteEviction(address, pe_id);
+        } else {
+            interconnect->noteEviction(address, pe_id);
+        }
+    }
+    
+    // Pasa al ring las solicitudes del último acceso. Sólo desde el hilo del
+    // PE dueño y sin locks de coherencia; si el ring está lleno se espera al árbitro.
+    void flushRequests() {
+        for (const BusTransaction& transaction : outbox) {
+            while (!interconnect->addRequest(transaction)) {
+                std::this_thread::yield();
+            }
+        }
+        outbox.clear();
+    }
+};
+
+// ============================================================
+// LOCKS DE COHERENCIA
+// ============================================================
+
+// Cada L1 tiene su lock y hay uno del bus. Un hit local (ICache::hitsLocally)
+// sólo toma el de su caché. Lo que sale al bus (misses, upgrades, fills de
+// MSHR) hace snoops en las demás cachés, así que toma el del bus y después
+// los de todas las L1 en orden de PE. Quien tiene sólo su lock nunca espera
+// otro, por lo que no hay ciclos.
+class CoherenceLocks {
+    std::mutex bus;
+    std::vector<std::mutex> caches;
+public:
+    explicit CoherenceLocks(size_t num_caches) : caches(num_caches) {}
+    
+    std::mutex& local(int pe_id) { return caches[static_cast<size_t>(pe_id)]; }
+    
+    // BasicLockable: std::lock_guard<CoherenceLocks> toma el bus y todas las L1
+    void lock() {
+        bus.lock();
+        for (std::mutex& cache : caches) {
+            cache.lock();
+        }
+    }
+    void unlock() {
+        for (auto it = caches.rbegin(); it != caches.rend(); ++it) {
+            it->unlock();
+        }
+        bus.unlock();
     }
 };
 
@@ -129,25 +245,121 @@ public:
 // ============================================================
 
 class CacheMemPort : public IMemPort {
-    Cache& cache;
+    ICache& cache;
+    InterconnectBusInterface& bus;
+    // Los hits locales corren en paralelo con los demás PEs; el resto se
+    // serializa con los snoops. El push al ring del Interconnect y la espera
+    // de sus respuestas se hacen sin locks.
+    CoherenceLocks& locks;
+    int pe_id;
+    size_t pending_stores = 0;
+    
+    // Emite `access` con el lock de esta L1 si es un hit local, o con todos
+    // los de la coherencia si puede ir al bus
+    template <typename Access>
+    AccessStatus run(uint64_t byte_addr, bool is_write, Access access) {
+        {
+            std::lock_guard<std::mutex> guard(locks.local(pe_id));
+            if (cache.hitsLocally(byte_addr, is_write)) {
+                return access();
+            }
+        }
+        AccessStatus status;
+        {
+            std::lock_guard<CoherenceLocks> guard(locks);
+            status = access();
+        }
+        bus.flushRequests();
+        return status;
+    }
+    
 public:
-    CacheMemPort(Cache& c) : cache(c) {}
+    CacheMemPort(ICache& c, InterconnectBusInterface& b, CoherenceLocks& l, int id)
+        : cache(c), bus(b), locks(l), pe_id(id) {}
     
+    // El PE es bloqueante: emite el acceso por los MSHRs y avanza la
+    // caché hasta recibir el callback
     uint64_t load(uint64_t addr) override {
         uint64_t data = 0;
-        cache.read(addr * sizeof(uint64_t), data);
+        bool done = false;
+        auto on_complete = [&](uint64_t, uint64_t value) { data = value; done = true; };
+        while (run(addr * sizeof(uint64_t), false, [&] {
+                   return cache.readAsync(addr * sizeof(uint64_t), on_complete);
+               }) == AccessStatus::STALLED) {
+            tick();
+        }
+        while (!done) {
+            tick();
+        }
         return data;
     }
     
     void store(uint64_t addr, uint64_t value) override {
-        cache.write(addr * sizeof(uint64_t), value);
+        bool done = false;
+        auto on_complete = [&](uint64_t, uint64_t) { done = true; };
+        while (run(addr * sizeof(uint64_t), true, [&] {
+                   return cache.writeAsync(addr * sizeof(uint64_t), value, on_complete);
+               }) == AccessStatus::STALLED) {
+            tick();
+        }
+        while (!done) {
+            tick();
+        }
     }
+    
+    // Store buffer del PE: la escritura queda en un MSHR y se completa en tick()
+    bool tryStore(uint64_t addr, uint64_t value) override {
+        pending_stores++;
+        auto on_complete = [this](uint64_t, uint64_t) { pending_stores--; };
+        if (run(addr * sizeof(uint64_t), true, [&] {
+                return cache.writeAsync(addr * sizeof(uint64_t), value, on_complete);
+            }) == AccessStatus::STALLED) {
+            pending_stores--;
+            return false;
+        }
+        return true;
+    }
+    
+    // Un ciclo de la caché. La latencia y las respuestas del interconnect se
+    // cuentan con el lock propio (sólo este hilo asigna o libera MSHRs); sólo
+    // instalar un miss listo necesita los de todas las L1. Mientras se espera
+    // al árbitro se le cede el procesador.
+    void tick() override {
+        bool ready;
+        {
+            std::lock_guard<std::mutex> guard(locks.local(pe_id));
+            if (cache.outstandingMisses() == 0) {
+                return;
+            }
+            ready = cache.advanceMisses();
+        }
+        if (!ready) {
+            std::this_thread::yield();
+            return;
+        }
+        {
+            std::lock_guard<CoherenceLocks> guard(locks);
+            cache.completeMisses();
+        }
+        bus.flushRequests();
+    }
+    size_t pendingStores() const override { return pending_stores; }
 };
 
 // ============================================================
 // UTILIDADES
 // ============================================================
 
+// Programa del PE `pe_id`: Programs/program<pe_id+1>.txt si existe; si
+// no, los PEs extra repiten cíclicamente los programas de los 4 originales
+std::string programFileForPE(int pe_id) {
+    std::string own = "Programs/program" + std::to_string(pe_id + 1) + ".txt";
+    if (std::ifstream(own).good()) {
+        return own;
+    }
+    return "Programs/program" + std::to_string(pe_id % Interconnect::DEFAULT_PES + 1) + ".txt";
+}
+
 std::vector<std::string> loadProgramFromFile(const std::string& path) {
     std::vector<std::string> lines;
     std::ifstream file(path);
@@ -169,6 +381,90 @@ void printSeparator(const std::string& title) {
     std::cout << "========================================\n" << std::endl;
 }
 
+// Interpreta "<sets>x<ways>" o "<sets>x<ways>x<block>" (p.ej. "64x4", "64x4x64")
+bool parseCacheGeometry(const std::string& text, CacheGeometry& geometry) {
+    size_t values[3] = {0, 0, CACHE_BLOCK_SIZE};
+    size_t count = 0;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, 'x')) {
+        if (count == 3 || item.empty() ||
+            item.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        values[count++] = std::stoul(item);
+    }
+    if (count < 2) {
+        return false;
+    }
+    geometry = {values[0], values[1], values[2]};
+    return true;
+}
+
+// Entero sin signo en decimal (p.ej. "--store-buffer 0")
+bool parseUnsigned(const std::string& text, size_t& value) {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    value = std::stoul(text);
+    return true;
+}
+
+// Entero positivo en decimal (p.ej. "--l2-banks 4")
+bool parsePositive(const std::string& text, size_t& value) {
+    return parseUnsigned(text, value) && value > 0;
+}
+
+// Exactamente `count` enteros sin signo separados por comas (p.ej. "1,2,4")
+bool parseUnsignedList(const std::string& text, size_t* values, size_t count) {
+    std::stringstream ss(text);
+    std::string item;
+    size_t parsed = 0;
+    while (std::getline(ss, item, ',')) {
+        if (parsed == count || !parseUnsigned(item, values[parsed])) {
+            return false;
+        }
+        parsed++;
+    }
+    return parsed == count;
+}
+
+// Lista no vacía de enteros sin signo separados por comas (p.ej. "4,1,1,1")
+bool parseUnsignedVector(const std::string& text, std::vector<size_t>& values) {
+    std::stringstream ss(text);
+    std::string item;
+    values.clear();
+    while (std::getline(ss, item, ',')) {
+        size_t value = 0;
+        if (!parseUnsigned(item, value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+// --decode-trace: una transacción por línea, en el orden del bus
+int decodeTrace(const std::string& path) {
+    try {
+        TraceReader reader(path);
+        TraceRecord record;
+        uint64_t count = 0;
+        std::cout << "ciclo espera transacción dato" << std::endl;
+        while (reader.next(record)) {
+            const BusTransaction& t = record.transaction;
+            std::cout << record.cycle << " " << record.cycle - t.arrival_cycle << " "
+                      << t.toString() << " 0x" << std::hex << t.data << std::dec << std::endl;
+            count++;
+        }
+        std::cout << count << " transacciones" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
 void waitForEnter(bool stepping_mode, const std::string& message = "") {
     if (stepping_mode) {
         if (!message.empty()) {
@@ -206,19 +502,296 @@ void clockControlThread(bool stepping_mode) {
 
 int main(int argc, char* argv[]) {
     bool stepping_mode = false;
+    CacheGeometry cache_geometry{CACHE_SETS, CACHE_WAYS, CACHE_BLOCK_SIZE};
+    ReplacementKind replacement = ReplacementKind::LRU;
+    bool use_l2 = false;
+    L2Config l2_config;
+    PrefetcherKind prefetch_kind = PrefetcherKind::NONE;
+    size_t prefetch_degree = 2;
+    MSHRConfig mshr_config;
+    size_t store_buffer_entries = 8;
+    CoherenceProtocol protocol = CoherenceProtocol::MESI;
+    bool print_transition_matrix = false;
+    bool sharing_report = false;
+    bool classify_misses = false;
+    bool reuse_profile = false;
+    size_t sharing_top = 10;
+    SnoopFilterKind snoop_filter = SnoopFilterKind::NONE;
+    size_t bloom_counters = 1024;
+    bool use_directory = false;
+    size_t num_pes = Interconnect::DEFAULT_PES;
+    size_t ring_entries = Interconnect::DEFAULT_RING_ENTRIES;
+    bool use_bus_timing = false;
+    ArbitrationConfig arbitration;
+    bool use_noc = false;
+    bool coalescing = true;
+    size_t trace_entries = Interconnect::DEFAULT_TRACE_ENTRIES;
+    std::string trace_file;
+    NoCConfig noc_config;
+    BusTimingConfig bus_timing;
+    DirectoryConfig directory_config;
     
     // Procesar argumentos de línea de comandos
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "--step" || arg == "-s") {
             stepping_mode = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            if (!parseCacheGeometry(argv[++i], cache_geometry)) {
+                std::cerr << "Geometría inválida: " << argv[i] 
+                          << " (formato: <sets>x<ways>[x<block>])" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--quiet" || arg == "-q") {
+            // Silencia en ejecución todas las trazas del camino caliente
+            Trace::setMask(0);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            uint32_t categories = 0;
+            if (!Trace::parseMask(argv[++i], categories)) {
+                std::cerr << "Categorías de traza inválidas: " << argv[i] 
+                          << " (cache,mesi,pe,bus,interconnect,ram,all)" << std::endl;
+                return 1;
+            }
+            Trace::setMask(categories);
+        } else if (arg == "--replacement" && i + 1 < argc) {
+            if (!parseReplacementKind(argv[++i], replacement)) {
+                std::cerr << "Política inválida: " << argv[i] 
+                          << " (lru|plru|srrip|brrip|random)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--protocol" && i + 1 < argc) {
+            if (!parseCoherenceProtocol(argv[++i], protocol)) {
+                std::cerr << "Protocolo inválido: " << argv[i] 
+                          << " (mesi|moesi|mesif)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--snoop-filter" && i + 1 < argc) {
+            if (!parseSnoopFilterKind(argv[++i], snoop_filter)) {
+                std::cerr << "Snoop filter inválido: " << argv[i] 
+                          << " (none|presence|bloom)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--pes" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], num_pes) || num_pes > Interconnect::MAX_PES) {
+                std::cerr << "Número de PEs inválido: " << argv[i] 
+                          << " (1.." << Interconnect::MAX_PES << ")" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--bus-timing" && i + 1 < argc) {
+            size_t latencies[3];
+            if (!parseUnsignedList(argv[++i], latencies, 3) || latencies[0] == 0) {
+                std::cerr << "Latencias de bus inválidas: " << argv[i] 
+                          << " (request,snoop,data; request > 0)" << std::endl;
+                return 1;
+            }
+            bus_timing.request_latency = latencies[0];
+            bus_timing.snoop_latency = latencies[1];
+            bus_timing.data_latency = latencies[2];
+            use_bus_timing = true;
+        } else if (arg == "--bus-width" && i + 1 < argc) {
+            size_t widths[2];
+            if (!parseUnsignedList(argv[++i], widths, 2) || widths[0] == 0 || widths[1] == 0) {
+                std::cerr << "Anchos de bus inválidos: " << argv[i] 
+                          << " (address,data en bits)" << std::endl;
+                return 1;
+            }
+            bus_timing.address_bus_bits = widths[0];
+            bus_timing.data_bus_bits = widths[1];
+            use_bus_timing = true;
+        } else if (arg == "--bus-outstanding" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], bus_timing.max_outstanding)) {
+                std::cerr << "Máximo de transacciones en vuelo inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+            use_bus_timing = true;
+        } else if (arg == "--noc" && i + 1 < argc) {
+            if (!parseNoCTopology(argv[++i], noc_config.topology)) {
+                std::cerr << "Topología de red inválida: " << argv[i] 
+                          << " (mesh|ring)" << std::endl;
+                return 1;
+            }
+            use_noc = true;
+        } else if ((arg == "--noc-stages" || arg == "--noc-link" || arg == "--noc-vcs" ||
+                    arg == "--noc-mcs" || arg == "--noc-mem-latency" || arg == "--noc-outstanding") &&
+                   i + 1 < argc) {
+            size_t value = 0;
+            if (!parsePositive(argv[++i], value)) {
+                std::cerr << "Valor inválido para " << arg << ": " << argv[i] << std::endl;
+                return 1;
+            }
+            if (arg == "--noc-stages") {
+                noc_config.router_stages = value;
+            } else if (arg == "--noc-link") {
+                noc_config.link_bits = value;
+            } else if (arg == "--noc-vcs") {
+                noc_config.virtual_channels = value;
+            } else if (arg == "--noc-mcs") {
+                noc_config.memory_controllers = value;
+            } else if (arg == "--noc-outstanding") {
+                noc_config.max_outstanding = value;
+            } else {
+                noc_config.memory_latency = value;
+            }
+            use_noc = true;
+        } else if (arg == "--trace-entries" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], trace_entries)) {
+                std::cerr << "Tamaño de historial inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--trace-file" && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else if (arg == "--decode-trace" && i + 1 < argc) {
+            return decodeTrace(argv[++i]);
+        } else if (arg == "--no-coalesce") {
+            coalescing = false;
+        } else if (arg == "--arbiter" && i + 1 < argc) {
+            if (!parseArbitrationPolicy(argv[++i], arbitration.policy)) {
+                std::cerr << "Política de arbitraje inválida: " << argv[i] 
+                          << " (rr|fixed|oldest|wfq|lottery)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--arb-weights" && i + 1 < argc) {
+            if (!parseUnsignedVector(argv[++i], arbitration.weights)) {
+                std::cerr << "Pesos de arbitraje inválidos: " << argv[i] 
+                          << " (lista por PE, p.ej. 4,1,1,1)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--wb-class") {
+            arbitration.separate_writebacks = true;
+        } else if (arg == "--wb-max-wait" && i + 1 < argc) {
+            size_t max_wait = 0;
+            if (!parsePositive(argv[++i], max_wait)) {
+                std::cerr << "Espera máxima de writebacks inválida: " << argv[i] << std::endl;
+                return 1;
+            }
+            arbitration.writeback_max_wait = max_wait;
+            arbitration.separate_writebacks = true;
+        } else if (arg == "--ring-entries" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], ring_entries)) {
+                std::cerr << "Tamaño de ring inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--directory" && i + 1 < argc) {
+            if (!parseSharerEncoding(argv[++i], directory_config.encoding)) {
+                std::cerr << "Codificación de directorio inválida: " << argv[i] 
+                          << " (full|limited|coarse)" << std::endl;
+                return 1;
+            }
+            use_directory = true;
+        } else if ((arg == "--dir-pointers" || arg == "--dir-group") && i + 1 < argc) {
+            size_t value = 0;
+            if (!parsePositive(argv[++i], value)) {
+                std::cerr << "Valor inválido para " << arg << ": " << argv[i] << std::endl;
+                return 1;
+            }
+            if (arg == "--dir-pointers") {
+                directory_config.pointers = value;
+            } else {
+                directory_config.group_size = value;
+            }
+        } else if (arg == "--bloom-counters" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], bloom_counters)) {
+                std::cerr << "Número de contadores inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--transition-matrix") {
+            print_transition_matrix = true;
+        } else if (arg == "--classify-misses") {
+            classify_misses = true;
+        } else if (arg == "--reuse-profile") {
+            reuse_profile = true;
+        } else if (arg == "--sharing-report") {
+            sharing_report = true;
+        } else if (arg == "--sharing-top" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], sharing_top)) {
+                std::cerr << "Número de bloques inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+            sharing_report = true;
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            if (!parsePrefetcherKind(argv[++i], prefetch_kind)) {
+                std::cerr << "Prefetcher inválido: " << argv[i] 
+                          << " (none|nextline|stride|stream)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--prefetch-degree" && i + 1 < argc) {
+            if (!parsePositive(argv[++i], prefetch_degree)) {
+                std::cerr << "Grado de prefetch inválido: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if ((arg == "--mshrs" || arg == "--mshr-targets" || arg == "--mshr-latency") &&
+                   i + 1 < argc) {
+            size_t value = 0;
+            if (!parsePositive(argv[++i], value)) {
+                std::cerr << "Valor inválido para " << arg << ": " << argv[i] << std::endl;
+                return 1;
+            }
+            if (arg == "--mshrs") {
+                mshr_config.entries = value;
+            } else if (arg == "--mshr-targets") {
+                mshr_config.targets_per_entry = value;
+            } else {
+                mshr_config.miss_latency = static_cast<uint32_t>(value);
+            }
+        } else if (arg == "--store-buffer" && i + 1 < argc) {
+            if (!parseUnsigned(argv[++i], store_buffer_entries)) {
+                std::cerr << "Tamaño de store buffer inválido: " << argv[i] 
+                          << " (0 lo desactiva)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--l2" && i + 1 < argc) {
+            CacheGeometry l2_geometry;
+            if (!parseCacheGeometry(argv[++i], l2_geometry)) {
+                std::cerr << "Geometría de L2 inválida: " << argv[i] 
+                          << " (formato: <sets>x<ways>[x<block>])" << std::endl;
+                return 1;
+            }
+            use_l2 = true;
+            l2_config.sets = l2_geometry.sets;
+            l2_config.ways = l2_geometry.ways;
+            l2_config.block_size = l2_geometry.block_size;
+        } else if (arg == "--l2-mode" && i + 1 < argc) {
+            if (!parseInclusionPolicy(argv[++i], l2_config.inclusion)) {
+                std::cerr << "Modo de L2 inválido: " << argv[i] 
+                          << " (inclusive|noninclusive|exclusive)" << std::endl;
+                return 1;
+            }
+            use_l2 = true;
+        } else if ((arg == "--l2-banks" || arg == "--l2-latency") && i + 1 < argc) {
+            size_t value = 0;
+            if (!parsePositive(argv[++i], value)) {
+                std::cerr << "Valor inválido para " << arg << ": " << argv[i] << std::endl;
+                return 1;
+            }
+            if (arg == "--l2-banks") {
+                l2_config.banks = value;
+            } else {
+                l2_config.hit_latency = static_cast<uint32_t>(value);
+            }
+            use_l2 = true;
         }
     }
     
+    if (use_noc && use_bus_timing) {
+        std::cerr << "--noc y --bus-timing/--bus-width/--bus-outstanding son excluyentes" << std::endl;
+        return 1;
+    }
+    if (use_l2 && l2_config.block_size != cache_geometry.block_size) {
+        std::cerr << "La L2 debe usar el bloque de las L1: " << l2_config.block_size 
+                  << " bytes en L2 frente a " << cache_geometry.block_size 
+                  << " en L1 (formato de --l2: <sets>x<ways>[x<block>])" << std::endl;
+        return 1;
+    }
+    if (sharing_report && num_pes > SharingProfiler::MAX_PES) {
+        std::cerr << "El perfil de compartición soporta hasta " << SharingProfiler::MAX_PES 
+                  << " PEs" << std::endl;
+        return 1;
+    }
+    
     try {
         Clock::getInstance().setSteppingMode(stepping_mode);
         
-        printSeparator("SISTEMA INTEGRADO: 4 PEs + Cache + Interconnect + RAM");
+        printSeparator("SISTEMA INTEGRADO: " + std::to_string(num_pes) + " PEs + Cache + Interconnect + RAM");
         if (stepping_mode) {
             std::cout << "Modo paso a paso por ciclos activado.\n" << std::endl;
         }
@@ -234,18 +807,59 @@ int main(int argc, char* argv[]) {
         // ========================================================
         
         std::cout << "Inicializando componentes del sistema...\n" << std::endl;
+        std::cout << "Geometría de caché: " << cache_geometry.sets << " sets x "
+                  << cache_geometry.ways << " ways x " << cache_geometry.block_size
+                  << " bytes (" << cache_geometry.capacity() << " bytes por PE), reemplazo "
+                  << replacementKindName(replacement) << "\n" << std::endl;
+        std::cout << "Protocolo de coherencia: " << coherenceProtocolName(protocol) << "\n" << std::endl;
+        if (prefetch_kind != PrefetcherKind::NONE) {
+            std::cout << "Prefetcher: " << prefetcherKindName(prefetch_kind)
+                      << " (grado " << prefetch_degree << ")\n" << std::endl;
+        }
         
         // RAM compartida (512 palabras de 64 bits = 4KB)
         auto shared_ram = std::make_shared<RAM>(true);
         
         // Interconnect (bus compartido)
-        auto interconnect = std::make_shared<Interconnect>(shared_ram, true);
+        auto interconnect = std::make_shared<Interconnect>(shared_ram, true, num_pes, ring_entries);
+        interconnect->setSnoopFilter(snoop_filter, bloom_counters);
+        if (use_bus_timing) {
+            interconnect->setBusTiming(bus_timing);
+        }
+        if (use_noc) {
+            interconnect->setNetwork(noc_config);
+        }
+        interconnect->setArbitration(arbitration);
+        interconnect->setCoalescing(coalescing);
+        interconnect->setTraceCapacity(trace_entries);
+        if (!trace_file.empty()) {
+            interconnect->openTraceFile(trace_file);
+        }
+        
+        // Directorio en el home node: reemplaza el broadcast de snoops
+        std::shared_ptr<Directory> directory;
+        if (use_directory) {
+            directory_config.protocol = protocol;
+            directory = std::make_shared<Directory>(directory_config);
+            std::cout << "Coherencia por directorio: " << sharerEncodingName(directory_config.encoding)
+                      << "\n" << std::endl;
+        }
         
         // Bus Controller para coherencia
         auto bus_controller = std::make_shared<BusController>(true);
         
         std::cout << "RAM, Interconnect y BusController inicializados\n" << std::endl;
         
+        // L2 compartida opcional entre las L1 y la RAM
+        std::shared_ptr<SharedL2Cache> shared_l2;
+        if (use_l2) {
+            shared_l2 = std::make_shared<SharedL2Cache>(l2_config, shared_ram);
+            std::cout << "L2 compartida: " << l2_config.sets << " sets x " << l2_config.ways
+                      << " ways x " << l2_config.block_size << " bytes, "
+                      << inclusionPolicyName(l2_config.inclusion) << ", " << l2_config.banks
+                      << " bancos, latencia " << l2_config.hit_latency << " ciclos\n" << std::endl;
+        }
+        
         // ========================================================
         // 2. CARGAR VECTORES DESDE ARCHIVOS
         // ========================================================
@@ -262,38 +876,80 @@ int main(int argc, char* argv[]) {
                       << e.what() << std::endl;
             throw;
         }
+        
+        // Producto esperado. El programa k suma su cuarto de los vectores y deja
+        // el resultado en mem[2N + 1 + k], la zona de resultados; con más PEs
+        // que programas los de sobra repiten un rango ya cubierto.
+        const size_t programs_run = std::min(num_pes, Interconnect::DEFAULT_PES);
+        const uint32_t n = static_cast<uint32_t>(shared_ram->read(0));
+        const uint32_t chunk = n / Interconnect::DEFAULT_PES;
+        double expected_dot = 0.0;
+        for (uint32_t j = 0; j < programs_run * chunk; j++) {
+            uint64_t a_raw = shared_ram->read(1 + j);
+            uint64_t b_raw = shared_ram->read(1 + n + j);
+            double a, b;
+            std::memcpy(&a, &a_raw, sizeof(double));
+            std::memcpy(&b, &b_raw, sizeof(double));
+            expected_dot += a * b;
+        }
 
         // ========================================================
-        // 3. CONFIGURAR LOS 4 PEs CON SUS CACHÉS
+        // 3. CONFIGURAR LOS PEs CON SUS CACHÉS
         // ========================================================
         
         // Crear loader
         Loader loader;
         
+        // Perfil de compartición por bloque, común a todas las L1
+        std::unique_ptr<SharingProfiler> sharing_profiler;
+        if (sharing_report) {
+            sharing_profiler = std::make_unique<SharingProfiler>(cache_geometry.block_size);
+        }
+        
         // Arrays para almacenar los componentes
-        std::vector<std::unique_ptr<Cache>> caches;
+        std::vector<std::unique_ptr<ICache>> caches;
         std::vector<std::shared_ptr<InterconnectBusInterface>> bus_interfaces;
         std::vector<std::unique_ptr<CacheMemPort>> cache_ports;
+        CoherenceLocks coherence_locks(num_pes);
         std::vector<std::unique_ptr<PE>> pes;
         
-        // Configurar los 4 PEs
-        for (int i = 0; i < 4; i++) {
+        // Configurar los PEs
+        const int pe_count = static_cast<int>(num_pes);
+        for (int i = 0; i < pe_count; i++) {
             printSeparator("Configurando PE" + std::to_string(i));
             
-            caches.push_back(std::make_unique<Cache>(i));
+            caches.push_back(createCache(i, cache_geometry, replacement));
             bus_interfaces.push_back(std::make_shared<InterconnectBusInterface>(
                 interconnect, shared_ram, bus_controller, i
             ));
             
             caches[i]->setBusInterface(bus_interfaces[i].get());
+            caches[i]->setPrefetcher(createPrefetcher(prefetch_kind, cache_geometry.block_size,
+                                                      prefetch_degree));
+            caches[i]->setMSHRConfig(mshr_config);
+            caches[i]->setCoherenceProtocol(protocol);
+            caches[i]->setSharingProfiler(sharing_profiler.get());
+            caches[i]->setMissClassification(classify_misses);
+            caches[i]->setReuseProfiling(reuse_profile);
             bus_controller->registerCache(caches[i].get());
+            interconnect->registerCache(caches[i].get());
+            if (directory) {
+                directory->registerCache(caches[i].get());
+                bus_interfaces[i]->attachDirectory(directory);
+            }
+            if (shared_l2) {
+                bus_interfaces[i]->attachL2(shared_l2);
+                shared_l2->registerL1(caches[i].get());
+            }
             
-            cache_ports.push_back(std::make_unique<CacheMemPort>(*caches[i]));
+            cache_ports.push_back(std::make_unique<CacheMemPort>(*caches[i], *bus_interfaces[i],
+                                                                 coherence_locks, i));
             
             pes.push_back(std::make_unique<PE>(i));
             pes[i]->attachMemory(cache_ports[i].get());
+            pes[i]->setStoreBufferSize(store_buffer_entries);
             
-            std::string program_file = "Programs/program" + std::to_string(i + 1) + ".txt";
+            std::string program_file = programFileForPE(i);
             auto pe_program = loader.parseProgram(loadProgramFromFile(program_file));
             pes[i]->loadProgram(pe_program);
             
@@ -301,18 +957,36 @@ int main(int argc, char* argv[]) {
         }
         
         // ========================================================
-        // 4. EJECUTAR LOS 4 PEs
+        // 4. EJECUTAR LOS PEs
         // ========================================================
         
-        printSeparator("EJECUTANDO LOS 4 PEs");
+        printSeparator("EJECUTANDO LOS " + std::to_string(num_pes) + " PEs");
+        
+        // Árbitro del bus: único consumidor de los rings de solicitudes. Con
+        // --bus-timing cada vuelta es un ciclo del bus; el reloj se detiene
+        // mientras no hay nada en vuelo ni en cola.
+        std::atomic<bool> pes_done{false};
+        std::thread arbiter([&interconnect, &pes_done] {
+            while (true) {
+                if (interconnect->tick()) {
+                    continue;
+                }
+                if (pes_done.load(std::memory_order_acquire) && !interconnect->hasPendingTransactions()) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        });
         
-        for (int i = 0; i < 4; i++) {
+        for (int i = 0; i < pe_count; i++) {
             pes[i]->start();
         }
         
-        for (int i = 0; i < 4; i++) {
+        for (int i = 0; i < pe_count; i++) {
             pes[i]->join();
         }
+        pes_done.store(true, std::memory_order_release);
+        arbiter.join();
         
         // ========================================================
         // 5. RESULTADOS
@@ -320,278 +994,82 @@ int main(int argc, char* argv[]) {
         
         printSeparator("RESULTADOS FINALES");
         
-        for (int i = 0; i < 4; i++) {
+        for (int i = 0; i < pe_count; i++) {
             std::cout << "\nPE" << i << " completado:" << std::endl;
             std::cout << "Instrucciones: " << pes[i]->getInstructionCount() << std::endl;
             std::cout << "Ciclos: " << pes[i]->getCycleCount() << std::endl;
+            if (pes[i]->getStoreBufferSize() > 0) {
+                std::cout << "Store buffer (" << pes[i]->getStoreBufferSize() << " entradas): forwards="
+                          << pes[i]->getStoreForwardCount() << " stalls="
+                          << pes[i]->getStoreBufferStallCount() << " fences="
+                          << pes[i]->getFenceCount() << std::endl;
+            }
             caches[i]->printStats();
+            if (print_transition_matrix) {
+                caches[i]->printTransitionMatrix();
+            }
         }
-
-        // Esperar y limpiar el thread del reloj
-        if (stepping_mode && clock_thread.joinable()) {
-            running = false;
-            clock_thread.join();
-        }
-
-        std::cout << "\nEjecución completada con éxito." << std::endl;
-        return 0;
         
-    } catch (const std::exception &ex) {
-        std::cerr << "\nError: " << ex.what() << "\n";
-        return 1;
-    }
-
-        
-        // ========================================================
-        // 1. CREAR INFRAESTRUCTURA COMPARTIDA
-        // ========================================================
-        
-        std::cout << "Inicializando componentes del sistema...\n" << std::endl;
-        
-        // RAM compartida (512 palabras de 64 bits = 4KB)
-        auto shared_ram = std::make_shared<RAM>(true);
-        
-        // Interconnect (bus compartido)
-        auto interconnect = std::make_shared<Interconnect>(shared_ram, true);
-        
-        // Bus Controller para coherencia
-        auto bus_controller = std::make_shared<BusController>(true);
-        
-        std::cout << "RAM, Interconnect y BusController inicializados\n" << std::endl;
-        
-        // ========================================================
-        // 2. CARGAR VECTORES DESDE ARCHIVOS
-        // ========================================================
-            
-        printSeparator("Cargando Vectores desde Archivos");
-        waitForEnter(stepping_mode, "Preparándose para cargar vectores...");
-            
-        try {
-            shared_ram->loadVectorsToMemory(
-                "vectores/vector_a.txt", 
-                "vectores/vector_b.txt"
-            );
-            
-            
-        } catch (const std::exception& e) {
-            std::cerr << "Error cargando vectores desde archivos: " 
-                      << e.what() << std::endl;
+        interconnect->closeTraceFile();
+        interconnect->printStats();
+        if (directory) {
+            directory->printStats();
         }
-
-        // ========================================================
-        // 3. CONFIGURAR LOS 4 PEs CON SUS CACHÉS
-        // ========================================================
-        
-        // Crear loader
-        Loader loader;
-        
-        // Arrays para almacenar los componentes
-        std::vector<std::unique_ptr<Cache>> caches;
-        std::vector<std::shared_ptr<InterconnectBusInterface>> bus_interfaces;
-        std::vector<std::unique_ptr<CacheMemPort>> cache_ports;
-        std::vector<std::unique_ptr<PE>> pes;
-        
-        // Configurar los 4 PEs
-        for (int i = 0; i < 4; i++) {
-            printSeparator("Configurando PE" + std::to_string(i));
-            
-            // Crear y configurar caché
-            caches.push_back(std::make_unique<Cache>(i));
-            
-            // Crear y configurar interfaz de bus
-            bus_interfaces.push_back(std::make_shared<InterconnectBusInterface>(
-                interconnect, shared_ram, bus_controller, i
-            ));
-            
-            // Conectar caché con interfaz de bus y registrar en controlador
-            caches[i]->setBusInterface(bus_interfaces[i].get());
-            bus_controller->registerCache(caches[i].get());
-            
-            // Crear y configurar puerto de memoria
-            cache_ports.push_back(std::make_unique<CacheMemPort>(*caches[i]));
-            
-            // Crear y configurar PE
-            pes.push_back(std::make_unique<PE>(i));
-            pes[i]->attachMemory(cache_ports[i].get());
-            
-            // Cargar programa específico para este PE
-            std::string program_file = "Programs/program" + std::to_string(i + 1) + ".txt";
-            try {
-                auto pe_program = loader.parseProgram(loadProgramFromFile(program_file));
-                std::cout << "Cargando programa para PE" << i << ": " << program_file 
-                         << " (" << pe_program.size() << " instrucciones)" << std::endl;
-                pes[i]->loadProgram(pe_program);
-            } catch (const std::exception& e) {
-                std::cerr << "Error cargando programa " << program_file << ": " 
-                         << e.what() << std::endl;
-                throw;
-            }
-            
-            std::cout << "PE" << i << " configurado correctamente" << std::endl;
+        if (sharing_profiler) {
+            sharing_profiler->printReport(sharing_top);
         }
         
-        std::cout << "\nTotal de cachés registradas: " << bus_controller->getCacheCount() << std::endl;
-        
-        // ========================================================
-        // 4. EJECUTAR LOS 4 PEs
-        // ========================================================
-                
-        printSeparator("EJECUTANDO LOS 4 PEs EN PARALELO");
-        waitForEnter(stepping_mode, "Preparándose para iniciar los PEs...");
-
-        // Iniciar todos los PEs al mismo tiempo
-        std::cout << "Iniciando los 4 PEs simultáneamente...\n" << std::endl;
-        for (int i = 0; i < 4; i++) {
-            pes[i]->start();
-            std::cout << "PE" << i << " iniciado" << std::endl;
+        // Tráfico hacia memoria de todas las L1, para comparar protocolos
+        uint64_t memory_fills = 0;
+        uint64_t writebacks = 0;
+        for (int i = 0; i < pe_count; i++) {
+            CacheStats cache_stats = caches[i]->getStats();
+            memory_fills += cache_stats.memory_fills;
+            writebacks += cache_stats.writebacks;
         }
-
-        std::cout << "\nTodos los PEs están corriendo en paralelo..." << std::endl;
-
-        // Esperar a que todos terminen
-        for (int i = 0; i < 4; i++) {
-            pes[i]->join();
-            std::cout << "PE" << i << " completado" << std::endl;
+        std::cout << "Tráfico de memoria (" << coherenceProtocolName(protocol) << "): lecturas="
+                  << memory_fills << " bloques, writebacks=" << writebacks << " bloques" << std::endl;
+        
+        if (shared_l2) {
+            // Bajar a RAM lo que quedó sucio en L2 antes de reportar tráfico
+            shared_l2->flush();
+            shared_l2->printStats();
         }
 
-        std::cout << "\nTodos los PEs han terminado su ejecución\n" << std::endl;
-        
         // ========================================================
-        // 5. RESULTADOS DE CADA PE
+        // 6. VALIDACIÓN DEL PRODUCTO PUNTO
         // ========================================================
-        
-        printSeparator("RESULTADOS DE LOS PEs");
-        waitForEnter(stepping_mode, "Preparándose para mostrar resultados...");
-        
-        for (int i = 0; i < 4; i++) {
-            std::cout << "\n=== PE" << i << " ===" << std::endl;
-            if (stepping_mode) {
-                waitForEnter(stepping_mode, "Mostrando resultados del PE" + std::to_string(i));
-            
-            // Leer suma parcial
-            uint64_t partial_sum_raw;
-            caches[i]->read((24 + i) * sizeof(uint64_t), partial_sum_raw);
-            double partial_sum;
-            std::memcpy(&partial_sum, &partial_sum_raw, sizeof(double));
-            
-            std::cout << "Suma parcial PE" << i << " (mem[" << (24 + i) << "]) = " 
-                      << std::fixed << std::setprecision(2) << partial_sum << std::endl;
-            std::cout << "Instrucciones (uint64): " << pes[i]->getInstructionCount() 
-                      << " | Instrucciones (int): " << pes[i]->getIntInstructionCount()
-                      << " | LOAD: " << pes[i]->getLoadCount()
-                      << " | STORE: " << pes[i]->getStoreCount()
-                      << " | Ciclos: " << pes[i]->getCycleCount() << std::endl;
-            
-            caches[i]->printStats();
-        }
 
-
-        // VALIDACIÓN DEL PRODUCTO PUNTO FINAL
         double total_sum = 0.0;
-        for (int i = 0; i < 4; i++) {
-            uint64_t partial_sum_raw;
-            caches[i]->read((24 + i) * sizeof(uint64_t), partial_sum_raw);
+        for (size_t k = 0; k < programs_run; k++) {
+            // Por la caché: la suma parcial puede seguir sucia en alguna L1
+            uint64_t partial_raw = 0;
+            caches[k]->read((2 * n + 1 + k) * sizeof(uint64_t), partial_raw);
             double partial_sum;
-            std::memcpy(&partial_sum, &partial_sum_raw, sizeof(double));
+            std::memcpy(&partial_sum, &partial_raw, sizeof(double));
             total_sum += partial_sum;
         }
 
-        // Leer N directamente como entero
-        uint32_t N = static_cast<uint32_t>(shared_ram->read(0));
-
-        // Calcular producto punto directo desde RAM
-        double expected_dot = 0.0;
-        for (uint32_t i = 0; i < N; ++i) {
-            uint64_t a_raw = shared_ram->read(1 + i);     // Vector A en mem[1..12]
-            double a;
-            std::memcpy(&a, &a_raw, sizeof(double));
-
-            uint64_t b_raw = shared_ram->read(13 + i);    // Vector B en mem[13..24]
-            double b;
-            std::memcpy(&b, &b_raw, sizeof(double));
-
-            expected_dot += a * b;
-        }
-
-        std::cout << "\n=== VALIDACIÓN DEL PRODUCTO PUNTO FINAL ===\n";
+        printSeparator("VALIDACIÓN DEL PRODUCTO PUNTO");
         std::cout << "  Suma de PEs     : " << std::fixed << std::setprecision(2) << total_sum << std::endl;
         std::cout << "  Producto directo: " << std::fixed << std::setprecision(2) << expected_dot << std::endl;
         if (std::fabs(total_sum - expected_dot) < 0.01) {
-            std::cout << "Valor correcto \n";
+            std::cout << "Valor correcto" << std::endl;
         } else {
             std::cout << "Valor incorrecto, diferencia: " << std::fabs(total_sum - expected_dot) << std::endl;
         }
-        
-        // ========================================================
-        // 6. PROCESAR TRANSACCIONES PENDIENTES
-        // ========================================================
-        
-        printSeparator("Procesando Transacciones del Interconnect");
-        
-        int transactions_processed = 0;
-        while (interconnect->hasPendingTransactions()) {
-            if (interconnect->processNextTransaction()) {
-                transactions_processed++;
-            }
-        }
-        
-        std::cout << "Transacciones procesadas: " << transactions_processed << std::endl;
-        
-        // ========================================================
-        // 7. ESTADO FINAL DE RAM
-        // ========================================================
-        
-        printSeparator("Estado Final de RAM");
-        
-        std::cout << "Contenido de RAM (primeras 10 posiciones):" << std::endl;
-        for (uint32_t i = 0; i < 10; i++) {
-            uint64_t value = shared_ram->read(i);
-            std::cout << "  mem[" << i << "] = 0x" << std::hex 
-                      << std::setw(16) << std::setfill('0') << value 
-                      << std::dec;
-            double d;
-            std::memcpy(&d, &value, sizeof(double));
-            std::cout << " (" << std::fixed << std::setprecision(2) << d << ")";
-            
-            std::cout << std::endl;
-        }
-        
-        // ========================================================
-        // 8. RESUMEN FINAL
-        // ========================================================
-        
-        printSeparator("RESUMEN FINAL DEL SISTEMA");
-        waitForEnter(stepping_mode, "Preparándose para mostrar el resumen final...");
-        
-        std::cout << "Sistema con 4 PEs:" << std::endl;
-        
-        double total_hit_rate = 0.0;
-        for (int i = 0; i < 4; i++) {
-            auto stats = caches[i]->getStats();
-            double hit_rate = (double)(stats.read_hits + stats.write_hits) / 
-                              (stats.read_hits + stats.read_misses + 
-                               stats.write_hits + stats.write_misses) * 100.0;
-            total_hit_rate += hit_rate;
-            
-            std::cout << "\nPE" << i << ":" << std::endl;
-            std::cout << "   Instrucciones ejecutadas (uint64): " << pes[i]->getInstructionCount() << std::endl;
-            std::cout << "   Instrucciones ejecutadas (int): " << pes[i]->getIntInstructionCount() << std::endl;
-            std::cout << "   Cache Hit Rate: " << std::fixed << std::setprecision(1) 
-                      << hit_rate << "%" << std::endl;
+
+        // Esperar y limpiar el thread del reloj
+        if (stepping_mode && clock_thread.joinable()) {
+            running = false;
+            clock_thread.join();
         }
-        
-        std::cout << "\nPromedio Hit Rate: " << std::fixed << std::setprecision(1) 
-                  << (total_hit_rate / 4.0) << "%" << std::endl;
-        
-        std::cout << "\nInterconnect:" << std::endl;
-        std::cout << "   Transacciones procesadas: " << transactions_processed << std::endl;
-        std::cout << "   Cachés registradas: " << bus_controller->getCacheCount() << std::endl;
-        std::cout << "   Coherencia MESI mantenida" << std::endl;
-        
-        std::cout << "\nSistema completo con 4 PEs funcionando correctamente" << std::endl;
-        
+
+        std::cout << "\nEjecución completada con éxito." << std::endl;
         return 0;
         
-        
+    } catch (const std::exception &ex) {
+        std::cerr << "\nError: " << ex.what() << "\n";
+        return 1;
+    }
 }
-}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ram.hpp"
+#include "../Trace/Trace.hpp"
 #include <stdexcept>
 #include <cstring>
 #include <fstream>
@@ -20,34 +21,85 @@ RAM::RAM(bool verbose) : verbose_(verbose) {
 
 uint64_t RAM::read(uint32_t address) const {
     validateAddress(address);
-    logOperation("READ", address, memory_[address]);
-    return memory_[address];
+    uint64_t data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data = memory_[address];
+    }
+    logOperation("READ", address, data);
+    return data;
 }
 
 void RAM::write(uint32_t address, uint64_t data) {
     validateAddress(address);
-    memory_[address] = data;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        memory_[address] = data;
+    }
     logOperation("WRITE", address, data);
 }
 
+void RAM::readBlock(uint32_t address, uint8_t* data, size_t bytes) const {
+    size_t words = validateBlock(address, bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::memcpy(data, &memory_[address], bytes);
+    }
+    if (verbose_) {
+        TRACE(RAM, BASIC, "READ_BLOCK @ 0x" << std::hex << std::uppercase << std::setfill('0') 
+              << std::setw(4) << address << std::dec << std::nouppercase << std::setfill(' ')
+              << " (" << words << " words)");
+    }
+}
+
+void RAM::writeBlock(uint32_t address, const uint8_t* data, size_t bytes) {
+    size_t words = validateBlock(address, bytes);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::memcpy(&memory_[address], data, bytes);
+    }
+    if (verbose_) {
+        TRACE(RAM, BASIC, "WRITE_BLOCK @ 0x" << std::hex << std::uppercase << std::setfill('0') 
+              << std::setw(4) << address << std::dec << std::nouppercase << std::setfill(' ')
+              << " (" << words << " words)");
+    }
+}
+
 bool RAM::isValidAddress(uint32_t address) const {
     return address <= MAX_ADDRESS;
 }
 
 void RAM::validateAddress(uint32_t address) const {
     if (!isValidAddress(address)) {
-        throw std::out_of_range("Invalid memory address: 0x" + 
-                               std::to_string(address) + 
-                               ". Valid range is 0x0000 to 0x" + 
-                               std::to_string(MAX_ADDRESS));
+        std::ostringstream msg;
+        msg << "Invalid memory address: 0x" << std::hex << std::uppercase << address
+            << ". Valid range is 0x0000 to 0x" << MAX_ADDRESS;
+        throw std::out_of_range(msg.str());
+    }
+}
+
+size_t RAM::validateBlock(uint32_t address, size_t bytes) const {
+    if (bytes == 0 || bytes % sizeof(uint64_t) != 0) {
+        throw std::invalid_argument("Invalid block size: " + std::to_string(bytes) + 
+                                    " bytes (must be a non-zero multiple of 8)");
+    }
+    size_t words = bytes / sizeof(uint64_t);
+    validateAddress(address);
+    if (words > RAM_SIZE - address) {
+        std::ostringstream msg;
+        msg << "Invalid memory block: 0x" << std::hex << std::uppercase << address
+            << " + " << std::dec << words << " words exceeds 0x"
+            << std::hex << std::uppercase << MAX_ADDRESS;
+        throw std::out_of_range(msg.str());
     }
+    return words;
 }
 
 void RAM::logOperation(const std::string& op, uint32_t address, uint64_t data) const {
     if (verbose_) {
-        std::cout << op << " @ 0x" << std::hex << std::uppercase << std::setfill('0') 
-                  << std::setw(4) << address << ": 0x" << std::setw(16) 
-                  << data << std::dec << std::endl;
+        TRACE(RAM, BASIC, op << " @ 0x" << std::hex << std::uppercase << std::setfill('0') 
+              << std::setw(4) << address << ": 0x" << std::setw(16) 
+              << data << std::dec << std::nouppercase << std::setfill(' '));
     }
 }
 
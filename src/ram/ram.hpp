@@ -5,6 +5,7 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 #include <string>
 
 class RAM {
@@ -19,10 +20,17 @@ public:
     // Constructor
     explicit RAM(bool verbose = false);
 
-    // Basic memory operations
+    // Basic memory operations. Cada operación (también las de bloque) es
+    // atómica respecto a las demás: el árbitro del interconnect accede a la
+    // RAM en paralelo con los PEs.
     uint64_t read(uint32_t address) const;
     void write(uint32_t address, uint64_t data);
     
+    // Block operations: `bytes` (múltiplo de 8) bytes consecutivos desde la
+    // palabra `address`. Se valida el rango una sola vez y se copia de golpe.
+    void readBlock(uint32_t address, uint8_t* data, size_t bytes) const;
+    void writeBlock(uint32_t address, const uint8_t* data, size_t bytes);
+    
     // Double precision operations
     double readAsDouble(uint32_t address) const;
     void writeAsDouble(uint32_t address, double value);
@@ -45,9 +53,11 @@ public:
 
 private:
     std::vector<uint64_t> memory_;
+    mutable std::mutex mutex_;
     bool verbose_;
 
     void validateAddress(uint32_t address) const;
+    size_t validateBlock(uint32_t address, size_t bytes) const;
     void logOperation(const std::string& op, uint32_t address, uint64_t data) const;
 };
 
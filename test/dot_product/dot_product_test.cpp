@@ -88,7 +88,7 @@ int main() {
         // Mostrar resultado final
         std::cout << "=== Resumen ===" << std::endl;
         for (size_t i = 0; i < partial_sums.size(); ++i) {
-            std::cout << "Suma parcial PE" << i << " (mem[" << (24 + i) 
+            std::cout << "Suma parcial PE" << i << " (mem[" << (2 * N + 1 + i) 
                      << "]) = " << std::fixed << std::setprecision(2) 
                      << partial_sums[i] << std::endl;
         }
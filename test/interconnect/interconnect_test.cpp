@@ -1,7 +1,15 @@
 #include "../../src/interconnect/interconnect.hpp"
+#include "../../src/interconnect/directory.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 void test_round_robin() {
     std::cout << "Testing round-robin arbitration..." << std::endl;
@@ -40,6 +48,538 @@ void test_round_robin() {
     std::cout << "Round-robin arbitration test passed!" << std::endl;
 }
 
+void test_many_pes() {
+    std::cout << "Testing round-robin with 200 PEs..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    Interconnect interconnect(ram, false, 200);
+    assert(interconnect.getNumPEs() == 200);
+    
+    // Colas en palabras distintas del bitmask de ocupación
+    interconnect.addRequest({BusTransactionType::BusRd, 0x0010, 199, 0});
+    interconnect.addRequest({BusTransactionType::BusRd, 0x0020, 3, 0});
+    interconnect.addRequest({BusTransactionType::BusRd, 0x0030, 150, 0});
+    interconnect.addRequest({BusTransactionType::BusRd, 0x0040, 150, 0});
+    
+    // Tras atender al PE 150 el turno sigue en 151: 199 va antes que el segundo de 150
+    while (interconnect.hasPendingTransactions()) {
+        interconnect.processNextTransaction();
+    }
+    const auto& processed = interconnect.getProcessedTransactions();
+    assert(processed.size() == 4);
+    assert(processed[0].pe_id == 3 && processed[1].pe_id == 150);
+    assert(processed[2].pe_id == 199 && processed[3].pe_id == 150);
+    assert(!interconnect.processNextTransaction());
+    
+    bool rejected = false;
+    try {
+        interconnect.addRequest({BusTransactionType::BusRd, 0x0010, 200, 0});
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    rejected = false;
+    try {
+        Interconnect too_many(ram, false, Interconnect::MAX_PES + 1);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    std::cout << "Many-PE round-robin test passed!" << std::endl;
+}
+
+void test_concurrent_requests() {
+    std::cout << "Testing lock-free request rings with concurrent PEs..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    
+    // Ring acotado: 3 entradas se redondean a 4 y el quinto push se rechaza
+    Interconnect small(ram, false, 1, 3);
+    assert(small.getRingCapacity() == 4);
+    for (uint64_t i = 0; i < 4; i++) {
+        assert(small.addRequest({BusTransactionType::BusUpgr, 0x0010, 0, i}));
+    }
+    assert(!small.addRequest({BusTransactionType::BusUpgr, 0x0010, 0, 4}));
+    assert(small.getRingFullCount() == 1);
+    assert(small.processNextTransaction());
+    assert(small.addRequest({BusTransactionType::BusUpgr, 0x0010, 0, 4}));
+    
+    // Un hilo productor por PE y el árbitro consumiendo a la vez
+    const size_t num_pes = 8;
+    const uint64_t per_pe = 20000;
+    Interconnect interconnect(ram, false, num_pes, 16);
+    size_t total = num_pes * per_pe;
+    interconnect.setTraceCapacity(total);  // Historial completo para verificar el orden
+    std::vector<std::thread> producers;
+    for (size_t pe = 0; pe < num_pes; pe++) {
+        producers.emplace_back([&interconnect, pe, per_pe] {
+            for (uint64_t seq = 0; seq < per_pe; seq++) {
+                BusTransaction t{BusTransactionType::BusUpgr, static_cast<uint32_t>(seq % RAM::RAM_SIZE),
+                                 static_cast<uint32_t>(pe), seq};
+                while (!interconnect.addRequest(t)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    while (interconnect.getProcessedCount() < total) {
+        if (!interconnect.processNextTransaction()) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    assert(!interconnect.hasPendingTransactions());
+    
+    // Nada se pierde ni se duplica y cada PE conserva su orden FIFO
+    std::vector<uint64_t> next(num_pes, 0);
+    for (const auto& t : interconnect.getProcessedTransactions()) {
+        assert(t.data == next[t.pe_id]);
+        next[t.pe_id]++;
+    }
+    for (size_t pe = 0; pe < num_pes; pe++) {
+        assert(next[pe] == per_pe);
+    }
+    
+    std::cout << "Concurrent request ring test passed!" << std::endl;
+}
+
+void test_split_bus() {
+    std::cout << "Testing split-transaction bus timing..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    ram->write(0x20, 77);
+    
+    // Sin cachés registradas el bloque es de 8 bytes: un beat de datos.
+    // BusRd: request 1 + snoop 2 + memoria 4 + datos 1 = 8 ciclos
+    BusTimingConfig config;
+    config.request_latency = 1;
+    config.snoop_latency = 2;
+    config.data_latency = 4;
+    config.max_outstanding = 1;
+    Interconnect serial(ram, false, 2);
+    serial.setBusTiming(config);
+    serial.addRequest({BusTransactionType::BusRd, 0x20, 0, 0});
+    serial.addRequest({BusTransactionType::BusUpgr, 0x30, 1, 0});
+    while (serial.tick()) {
+    }
+    
+    // Con un solo hueco el BusUpgr espera a que termine el BusRd (ciclo 8)
+    // y sólo pasa por solicitud y snoop
+    const SplitTransactionBus& bus = *serial.getBus();
+    assert(bus.getCycle() == 11 && bus.getCompleted() == 2);
+    assert(bus.getPEStats(0).latency_cycles == 8 && bus.getPEStats(0).queue_cycles == 0);
+    assert(bus.getPEStats(1).queue_cycles == 8 && bus.getPEStats(1).latency_cycles == 11);
+    assert(bus.getOutstandingStalls() == 7);
+    assert(bus.getAddressBusyCycles() == 2 && bus.getDataBusyCycles() == 1);
+    const auto& processed = serial.getProcessedTransactions();
+    assert(processed.size() == 2 && processed[0].data == 77 && processed[1].pe_id == 1);
+    
+    // Transacción partida: el segundo BusRd pide el bus en el ciclo 1 y
+    // sus datos salen justo detrás de los del primero
+    config.max_outstanding = 4;
+    Interconnect pipelined(ram, false, 2);
+    pipelined.setBusTiming(config);
+    pipelined.addRequest({BusTransactionType::BusRd, 0x20, 0, 0});
+    pipelined.addRequest({BusTransactionType::BusRd, 0x28, 1, 0});
+    while (pipelined.tick()) {
+    }
+    const SplitTransactionBus& piped = *pipelined.getBus();
+    assert(piped.getCycle() == 9 && piped.getPeakOutstanding() == 2);
+    assert(piped.getPEStats(1).queue_cycles == 1 && piped.getPEStats(1).latency_cycles == 9);
+    assert(piped.getOutstandingStalls() == 0);
+    
+    // Un bus de datos más angosto alarga la fase de datos
+    config.data_bus_bits = 16;
+    Interconnect narrow(ram, false, 1);
+    narrow.setBusTiming(config);
+    narrow.addRequest({BusTransactionType::BusRd, 0x20, 0, 0});
+    while (narrow.tick()) {
+    }
+    assert(narrow.getBus()->getCycle() == 11 && narrow.getBus()->getDataBusyCycles() == 4);
+    
+    // El miss que espera respuesta se entrega con el último beat de datos:
+    // hasta entonces su MSHR no puede completar
+    std::atomic<bool> delivered{false};
+    BusTransaction miss{BusTransactionType::BusRd, 0x20, 0, 0};
+    miss.delivered = &delivered;
+    Interconnect awaited(ram, false, 1);
+    awaited.setBusTiming(config);
+    awaited.addRequest(miss);
+    for (int cycle = 1; cycle < 11; cycle++) {
+        assert(awaited.tick() && !delivered.load());
+    }
+    assert(awaited.tick() && delivered.load());
+    
+    bool rejected = false;
+    try {
+        config.max_outstanding = 0;
+        SplitTransactionBus invalid(config, 1);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    std::cout << "Split-transaction bus test passed!" << std::endl;
+}
+
+// PEs atendidos, en orden, hasta vaciar las colas
+static std::vector<uint32_t> drainOrder(Interconnect& interconnect) {
+    while (interconnect.processNextTransaction()) {
+    }
+    std::vector<uint32_t> order;
+    for (const auto& t : interconnect.getProcessedTransactions()) {
+        order.push_back(t.pe_id);
+    }
+    return order;
+}
+
+void test_arbitration() {
+    std::cout << "Testing arbitration policies..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    using Order = std::vector<uint32_t>;
+    
+    // Todos los PEs leen los mismos bloques: sin fusión, para ver cada turno
+    // Prioridad fija: mayor valor gana
+    ArbitrationConfig config;
+    config.policy = ArbitrationPolicy::FIXED_PRIORITY;
+    config.weights = {1, 5, 3};
+    Interconnect fixed(ram, false, 3);
+    fixed.setArbitration(config);
+    fixed.setCoalescing(false);
+    for (uint32_t pe = 0; pe < 3; pe++) {
+        fixed.addRequest({BusTransactionType::BusRd, 0x10, pe, 0});
+        fixed.addRequest({BusTransactionType::BusRd, 0x18, pe, 0});
+    }
+    assert(drainOrder(fixed) == Order({1, 1, 2, 2, 0, 0}));
+    assert(fixed.getWaitStats(0).max_wait == 5 && fixed.getWaitStats(1).max_wait == 1);
+    
+    // El grant decide qué miss se entrega primero: el PE de baja prioridad
+    // sigue esperando su respuesta mientras el otro ya puede continuar
+    std::atomic<bool> low_done{false};
+    std::atomic<bool> high_done{false};
+    Interconnect gated(ram, false, 3);
+    gated.setArbitration(config);
+    gated.setCoalescing(false);
+    BusTransaction low{BusTransactionType::BusRd, 0x10, 0, 0};
+    BusTransaction high{BusTransactionType::BusRd, 0x18, 1, 0};
+    low.delivered = &low_done;
+    high.delivered = &high_done;
+    gated.addRequest(low);
+    gated.addRequest(high);
+    assert(gated.processNextTransaction() && high_done.load() && !low_done.load());
+    assert(gated.processNextTransaction() && low_done.load());
+    
+    // Oldest-first frente a round-robin: tras atender al PE 0 el turno es
+    // del PE 1, pero la solicitud del PE 3 es más antigua
+    for (ArbitrationPolicy policy : {ArbitrationPolicy::ROUND_ROBIN, ArbitrationPolicy::OLDEST_FIRST}) {
+        config = ArbitrationConfig();
+        config.policy = policy;
+        Interconnect interconnect(ram, false, 4);
+        interconnect.setArbitration(config);
+        interconnect.setCoalescing(false);
+        interconnect.addRequest({BusTransactionType::BusRd, 0x10, 0, 0});
+        interconnect.addRequest({BusTransactionType::BusRd, 0x18, 3, 0});
+        assert(interconnect.processNextTransaction());
+        interconnect.addRequest({BusTransactionType::BusRd, 0x20, 1, 0});
+        Order expected = policy == ArbitrationPolicy::OLDEST_FIRST ? Order({0, 3, 1}) : Order({0, 1, 3});
+        assert(drainOrder(interconnect) == expected);
+    }
+    
+    // WFQ 3:1 con ambos PEs siempre con solicitudes
+    config = ArbitrationConfig();
+    config.policy = ArbitrationPolicy::WEIGHTED_FAIR;
+    config.weights = {3, 1};
+    Interconnect wfq(ram, false, 2);
+    wfq.setArbitration(config);
+    wfq.setCoalescing(false);
+    for (uint64_t i = 0; i < 16; i++) {
+        wfq.addRequest({BusTransactionType::BusRd, 0x10, 0, i});
+        wfq.addRequest({BusTransactionType::BusRd, 0x18, 1, i});
+    }
+    Order order = drainOrder(wfq);
+    assert(std::count(order.begin(), order.begin() + 8, 0u) == 6);
+    
+    // Lotería 9:1: reproducible con la misma semilla
+    config.policy = ArbitrationPolicy::LOTTERY;
+    config.weights = {9, 1};
+    Order draws[2];
+    for (Order& draw : draws) {
+        Interconnect lottery(ram, false, 2, 512);
+        lottery.setArbitration(config);
+        lottery.setCoalescing(false);
+        for (uint64_t i = 0; i < 400; i++) {
+            lottery.addRequest({BusTransactionType::BusRd, 0x10, 0, i});
+            lottery.addRequest({BusTransactionType::BusRd, 0x18, 1, i});
+        }
+        draw = drainOrder(lottery);
+    }
+    assert(draws[0] == draws[1]);
+    long first_pe0 = std::count(draws[0].begin(), draws[0].begin() + 200, 0u);
+    assert(first_pe0 > 160 && first_pe0 < 200);
+    
+    config.weights = {0, 1};
+    bool rejected = false;
+    try {
+        createArbiter(config, 2);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    // Clase aparte para writebacks: la lectura del PE 0 no espera detrás de
+    // su propio BusWB, que pasa delante al cumplir 3 turnos de espera
+    config = ArbitrationConfig();
+    config.separate_writebacks = true;
+    config.writeback_max_wait = 3;
+    Interconnect classes(ram, false, 2);
+    classes.setArbitration(config);
+    classes.setCoalescing(false);
+    classes.addRequest({BusTransactionType::BusWB, 0x40, 0, 0xAB});
+    classes.addRequest({BusTransactionType::BusRd, 0x10, 0, 0});
+    for (int i = 0; i < 4; i++) {
+        classes.addRequest({BusTransactionType::BusRd, 0x18, 1, 0});
+    }
+    order = drainOrder(classes);
+    const auto& processed = classes.getProcessedTransactions();
+    assert(order == Order({0, 1, 1, 0, 1, 1}));
+    assert(processed[0].type == BusTransactionType::BusRd && processed[3].type == BusTransactionType::BusWB);
+    assert(classes.getWritebacksPromoted() == 1 && ram->read(0x40) == 0xAB);
+    assert(classes.getWaitStats(0).max_wait == 3);
+    assert(classes.getWaitStats(0).histogram[PEWaitStats::bucket(3)] == 1);
+    
+    // Sin clase aparte el BusWB bloquea a la lectura que viene detrás
+    Interconnect single(ram, false, 2);
+    single.addRequest({BusTransactionType::BusWB, 0x40, 0, 0xAB});
+    single.addRequest({BusTransactionType::BusRd, 0x10, 0, 0});
+    drainOrder(single);
+    assert(single.getProcessedTransactions()[0].type == BusTransactionType::BusWB);
+    
+    std::cout << "Arbitration policies test passed!" << std::endl;
+}
+
+void test_noc() {
+    std::cout << "Testing mesh and ring network-on-chip..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    ram->write(0x20, 55);
+    
+    // Malla 2x2 y anillo de 4: el controlador de RAM en el nodo 0
+    NoCConfig config;
+    config.router_stages = 2;
+    config.memory_latency = 4;
+    NetworkOnChip mesh(config, 4);
+    assert(mesh.getNodeCount() == 4 && mesh.hops(3, 0) == 2 && mesh.hops(1, 2) == 2);
+    config.topology = NoCTopology::RING;
+    NetworkOnChip ring(config, 4);
+    assert(ring.hops(0, 3) == 1 && ring.hops(1, 3) == 2 && ring.hops(3, 1) == 2);
+    
+    // BusRd del PE 3 en la malla (bloque de 8 bytes: datos = 2 flits).
+    // Solicitud: 2 saltos de 3 ciclos + router destino = 8; memoria 4;
+    // respuesta: 2 saltos + router + flit extra = 9. Total 21.
+    config.topology = NoCTopology::MESH;
+    Interconnect on_mesh(ram, false, 4);
+    on_mesh.setNetwork(config);
+    on_mesh.addRequest({BusTransactionType::BusRd, 0x20, 3, 0});
+    while (on_mesh.tick()) {
+    }
+    assert(on_mesh.getNetwork()->getCycle() == 21 && on_mesh.getNetwork()->getTotalLatency() == 21);
+    assert(on_mesh.getProcessedTransactions()[0].data == 55);
+    
+    // La respuesta llega al PE cuando el paquete de datos termina de
+    // atravesar la red: su miss espera los 21 ciclos
+    std::atomic<bool> delivered{false};
+    BusTransaction miss{BusTransactionType::BusRd, 0x20, 3, 0};
+    miss.delivered = &delivered;
+    Interconnect awaited(ram, false, 4);
+    awaited.setNetwork(config);
+    awaited.addRequest(miss);
+    for (int cycle = 1; cycle < 21; cycle++) {
+        assert(awaited.tick() && !delivered.load());
+    }
+    assert(awaited.tick() && delivered.load());
+    
+    // En el anillo el PE 1 está a un salto del controlador: 5 + 4 + 6
+    config.topology = NoCTopology::RING;
+    Interconnect on_ring(ram, false, 4);
+    on_ring.setNetwork(config);
+    on_ring.addRequest({BusTransactionType::BusRd, 0x20, 1, 0});
+    while (on_ring.tick()) {
+    }
+    assert(on_ring.getNetwork()->getCycle() == 15);
+    
+    // BusRdX: solicitud, invalidación + ack a los otros 3 PEs y datos
+    Interconnect invalidating(ram, false, 4);
+    invalidating.setNetwork(config);
+    invalidating.addRequest({BusTransactionType::BusRdX, 0x20, 1, 0});
+    while (invalidating.tick()) {
+    }
+    assert(invalidating.getNetwork()->getPackets() == 8);
+    
+    // Ráfaga de 16 PEs hacia un único controlador: hay contención, y con
+    // cuatro controladores en las esquinas los bloques se entrelazan
+    config.topology = NoCTopology::MESH;
+    for (size_t controllers : {1, 4}) {
+        config.memory_controllers = controllers;
+        Interconnect burst(ram, false, 16);
+        burst.setNetwork(config);
+        for (uint32_t pe = 0; pe < 16; pe++) {
+            burst.addRequest({BusTransactionType::BusRd, pe, pe, 0});
+        }
+        while (burst.tick()) {
+        }
+        assert(burst.getProcessedTransactions().size() == 16);
+        if (controllers == 1) {
+            assert(burst.getNetwork()->getContentionCycles() > 0);
+        } else {
+            assert(burst.getNetwork()->getMemoryNodes() == std::vector<size_t>({0, 15, 3, 12}));
+            assert(burst.getNetwork()->getHomeNode(0, 8) == 0 && burst.getNetwork()->getHomeNode(1, 8) == 15);
+        }
+    }
+    
+    bool rejected = false;
+    try {
+        config.memory_controllers = 5;
+        NetworkOnChip too_many(config, 4);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    std::cout << "Network-on-chip test passed!" << std::endl;
+}
+
+void test_coalescing() {
+    std::cout << "Testing request coalescing..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    ram->write(0x20, 55);
+    ram->write(0x21, 66);
+    
+    // Tres BusRd al mismo bloque: usan un solo turno de bus
+    Interconnect untimed(ram, false, 4);
+    for (uint32_t pe = 0; pe < 3; pe++) {
+        untimed.addRequest({BusTransactionType::BusRd, 0x20, pe, 0});
+    }
+    untimed.addRequest({BusTransactionType::BusRd, 0x21, 3, 0});
+    assert(untimed.processNextTransaction());
+    assert(untimed.getProcessedTransactions().size() == 3 && untimed.getCoalescedReads() == 2);
+    for (const BusTransaction& t : untimed.getProcessedTransactions()) {
+        assert(t.data == 55);
+    }
+    assert(untimed.processNextTransaction() && !untimed.processNextTransaction());
+    assert(untimed.getProcessedTransactions()[3].data == 66);
+    
+    // Con bloques de 32 bytes, palabras distintas del mismo bloque salen
+    // del mismo turno de bus
+    ram->write(0x23, 77);
+    auto block_cache = createCache(0);
+    Interconnect wide(ram, false, 4);
+    wide.registerCache(block_cache.get());
+    wide.addRequest({BusTransactionType::BusRd, 0x20, 0, 0});
+    wide.addRequest({BusTransactionType::BusRd, 0x21, 1, 0});
+    wide.addRequest({BusTransactionType::BusRd, 0x23, 2, 0});
+    assert(wide.processNextTransaction() && !wide.processNextTransaction());
+    std::vector<BusTransaction> filled = wide.getProcessedTransactions();
+    assert(filled.size() == 3 && wide.getCoalescedReads() == 2);
+    assert(filled[0].data == 55 && filled[1].data == 66 && filled[2].data == 77);
+    
+    // Desactivado, cada uno usa el bus
+    Interconnect plain(ram, false, 4);
+    plain.setCoalescing(false);
+    for (uint32_t pe = 0; pe < 3; pe++) {
+        plain.addRequest({BusTransactionType::BusRd, 0x20, pe, 0});
+    }
+    assert(plain.processNextTransaction() && plain.getProcessedTransactions().size() == 1);
+    
+    // Con el bus temporizado: el BusUpgr del PE 1 se absorbe en el BusRdX
+    // en curso del PE 0 y la transacción no ocupa el bus
+    Interconnect timed(ram, false, 4);
+    timed.setBusTiming(BusTimingConfig());
+    timed.addRequest({BusTransactionType::BusRdX, 0x20, 0, 0});
+    timed.addRequest({BusTransactionType::BusUpgr, 0x20, 1, 0});
+    while (timed.tick()) {
+    }
+    assert(timed.getFoldedUpgrades() == 1 && timed.getBus()->getCompleted() == 1);
+    assert(timed.getProcessedTransactions().size() == 2);
+    
+    // Un BusRdX de otro PE cierra la fusión: el BusRd que llega después
+    // no puede adelantarlo y sale por el bus
+    Interconnect ordered(ram, false, 4);
+    ordered.setBusTiming(BusTimingConfig());
+    ordered.addRequest({BusTransactionType::BusRd, 0x20, 0, 0});
+    ordered.addRequest({BusTransactionType::BusRdX, 0x20, 1, 0});
+    ordered.tick();
+    ordered.tick();
+    ordered.addRequest({BusTransactionType::BusRd, 0x20, 2, 0});
+    while (ordered.tick()) {
+    }
+    assert(ordered.getCoalescedReads() == 0 && ordered.getBus()->getCompleted() == 3);
+    
+    std::cout << "Request coalescing test passed!" << std::endl;
+}
+
+void test_transaction_trace() {
+    std::cout << "Testing bounded transaction trace..." << std::endl;
+    
+    auto ram = std::make_shared<RAM>();
+    const char* path = "bus_trace_test.bin";
+    
+    // Historial de 8 entradas: tras 20 transacciones quedan las 12..19, y
+    // la traza binaria conserva las 20 con direcciones que suben y bajan
+    const uint32_t addresses[] = {0x100, 0x10, 0x1E0, 0x0};
+    Interconnect interconnect(ram, false, 2);
+    interconnect.setTraceCapacity(8);
+    interconnect.openTraceFile(path);
+    for (uint64_t i = 0; i < 20; i++) {
+        uint32_t pe = static_cast<uint32_t>(i % 2);
+        BusTransactionType type = i % 3 == 0 ? BusTransactionType::BusWB : BusTransactionType::BusRdX;
+        interconnect.addRequest({type, addresses[i % 4] + static_cast<uint32_t>(i), pe, 1000 + i});
+        assert(interconnect.processNextTransaction());
+    }
+    interconnect.closeTraceFile();
+    
+    std::vector<BusTransaction> recent = interconnect.getProcessedTransactions();
+    assert(interconnect.getProcessedCount() == 20 && recent.size() == 8);
+    assert(recent.front().address == addresses[0] + 12 && recent.back().address == addresses[3] + 19);
+    
+    TraceReader reader(path);
+    TraceRecord record;
+    uint64_t count = 0;
+    while (reader.next(record)) {
+        const BusTransaction& t = record.transaction;
+        assert(t.address == addresses[count % 4] + count && t.pe_id == count % 2);
+        assert(t.type == (count % 3 == 0 ? BusTransactionType::BusWB : BusTransactionType::BusRdX));
+        // Sin modelo de tiempo el reloj cuenta turnos: la n-ésima termina en n
+        assert(record.cycle == count && t.arrival_cycle == count);
+        if (t.type == BusTransactionType::BusWB) {
+            assert(t.data == 1000 + count);
+        }
+        count++;
+    }
+    assert(count == 20);
+    
+    // Un archivo que no es una traza se rechaza
+    std::FILE* bogus = std::fopen(path, "wb");
+    std::fputs("not a trace", bogus);
+    std::fclose(bogus);
+    bool rejected = false;
+    try {
+        TraceReader invalid(path);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    std::remove(path);
+    
+    std::cout << "Bounded transaction trace test passed!" << std::endl;
+}
+
 void test_memory_operations() {
     std::cout << "Testing memory operations..." << std::endl;
     
@@ -60,5 +600,299 @@ void test_memory_operations() {
     assert(processed.size() == 2);
     assert(processed[1].data == 0xCAFEBABE);
     
+    // El BusWB de una caché llega con el bloque ya escrito: no toca RAM
+    BusTransaction posted{BusTransactionType::BusWB, 0x0100, 0, 0};
+    posted.posted = true;
+    interconnect.addRequest(posted);
+    interconnect.processNextTransaction();
+    assert(ram->read(0x0100) == 0xCAFEBABE);
+    
     std::cout << "Memory operations test passed!" << std::endl;
-}
\ No newline at end of file
+}
+
+// Bus de prueba: fills y writebacks directos a RAM, snoops por el Interconnect
+// (o por el directorio si se asigna uno)
+class SnoopTestPort : public IBusInterface {
+    Interconnect& interconnect_;
+    RAM& ram_;
+    int pe_id;
+public:
+    uint64_t memory_reads = 0;
+    Directory* directory = nullptr;
+
+    SnoopTestPort(Interconnect& interconnect, RAM& ram, int pe_id)
+        : interconnect_(interconnect), ram_(ram), pe_id(pe_id) {}
+
+    SnoopResponse sendMessage(const BusMessage& msg, uint8_t* block) override {
+        if (directory) {
+            return directory->request(msg, block);
+        }
+        return interconnect_.snoop(msg, block);
+    }
+    void readFromMemory(uint64_t address, uint8_t* data, size_t size) override {
+        ram_.readBlock(static_cast<uint32_t>(address / sizeof(uint64_t)), data, size);
+        memory_reads += size / sizeof(uint64_t);
+    }
+    void writeToMemory(uint64_t address, const uint8_t* data, size_t size) override {
+        ram_.writeBlock(static_cast<uint32_t>(address / sizeof(uint64_t)), data, size);
+    }
+    void notifyEviction(uint64_t address, const uint8_t*, size_t, bool) override {
+        if (directory) {
+            directory->noteEviction(address, pe_id);
+            return;
+        }
+        interconnect_.noteEviction(address, pe_id);
+    }
+};
+
+void test_cache_to_cache() {
+    std::cout << "Testing cache-to-cache transfers..." << std::endl;
+
+    auto ram = std::make_shared<RAM>();
+    Interconnect interconnect(ram);
+    Cache<> c0(0), c1(1), c2(2);
+    SnoopTestPort p0(interconnect, *ram, 0), p1(interconnect, *ram, 1), p2(interconnect, *ram, 2);
+    c0.setBusInterface(&p0);
+    c1.setBusInterface(&p1);
+    c2.setBusInterface(&p2);
+    interconnect.registerCache(&c0);
+    interconnect.registerCache(&c1);
+    interconnect.registerCache(&c2);
+
+    const uint64_t words_per_block = CACHE_BLOCK_SIZE / sizeof(uint64_t);
+    uint64_t data = 0;
+    ram->write(0x10, 42);
+
+    // Sin otras copias: E desde memoria
+    c0.read(0x80, data);
+    assert(data == 42 && p0.memory_reads == words_per_block);
+    assert(c0.getStats().shared_fills == 0);
+
+    // c0 en E entrega el bloque: c1 se instala en S sin leer memoria
+    c1.read(0x80, data);
+    assert(data == 42 && p1.memory_reads == 0);
+    assert(c1.getStats().c2c_received == 1 && c1.getStats().shared_fills == 1);
+    assert(interconnect.getCacheToCacheTransfers() == 1);
+    assert(interconnect.getMemoryReadsSaved() == words_per_block);
+
+    // Sólo copias en S: shared pero el dato viene de memoria
+    c2.read(0x80, data);
+    assert(data == 42 && p2.memory_reads == words_per_block);
+    assert(c2.getStats().shared_fills == 1 && interconnect.getCacheToCacheTransfers() == 1);
+
+    // BusUpgr de c0 invalida a c1 y c2 (y no a sí mismo)
+    c0.write(0x80, 7);
+    assert(c1.getStats().invalidations == 1 && c2.getStats().invalidations == 1);
+    assert(c0.getStats().invalidations == 0);
+
+    // c0 en M entrega el bloque y actualiza memoria (M -> S)
+    c1.read(0x80, data);
+    assert(data == 7 && p1.memory_reads == 0);
+    assert(ram->read(0x10) == 7);
+
+    // BusRdX sobre una copia M: el bloque sucio pasa al solicitante sin writeback
+    c1.write(0x88, 9);
+    c0.write(0x80, 11);
+    c0.read(0x88, data);
+    assert(data == 9 && p0.memory_reads == words_per_block);
+    assert(ram->read(0x11) == 0);
+    assert(c1.getStats().c2c_supplied == 1 && c0.getStats().c2c_supplied == 2);
+    assert(interconnect.getCacheToCacheTransfers() == 3);
+    assert(interconnect.getMemoryReadsSaved() == 3 * words_per_block);
+
+    std::cout << "Cache-to-cache transfer test passed!" << std::endl;
+}
+
+void test_protocol_variants() {
+    std::cout << "Testing MOESI and MESIF variants..." << std::endl;
+
+    const uint64_t words_per_block = CACHE_BLOCK_SIZE / sizeof(uint64_t);
+    uint64_t data = 0;
+
+    // MOESI: el dueño sucio comparte sin writeback y sigue respondiendo
+    {
+        auto ram = std::make_shared<RAM>();
+        Interconnect interconnect(ram);
+        Cache<> c0(0), c1(1), c2(2);
+        SnoopTestPort p0(interconnect, *ram, 0), p1(interconnect, *ram, 1), p2(interconnect, *ram, 2);
+        Cache<>* caches[] = {&c0, &c1, &c2};
+        SnoopTestPort* ports[] = {&p0, &p1, &p2};
+        for (int i = 0; i < 3; i++) {
+            caches[i]->setBusInterface(ports[i]);
+            caches[i]->setCoherenceProtocol(CoherenceProtocol::MOESI);
+            interconnect.registerCache(caches[i]);
+        }
+
+        c0.write(0x80, 5);
+        c1.read(0x80, data);
+        assert(data == 5 && ram->read(0x10) == 0);
+        c2.read(0x80, data);
+        assert(data == 5 && p2.memory_reads == 0);
+        assert(c0.getStats().c2c_supplied == 2 && c0.getStats().writebacks == 0);
+
+        // Un sharer escribe: el dueño se invalida sin writeback
+        c1.write(0x80, 6);
+        assert(c0.getStats().invalidations == 1 && c0.getStats().writebacks == 0);
+        c0.read(0x80, data);
+        assert(data == 6 && ram->read(0x10) == 0);
+
+        bool rejected = false;
+        try {
+            c0.setCoherenceProtocol(CoherenceProtocol::MESI);
+        } catch (const std::logic_error&) {
+            rejected = true;
+        }
+        assert(rejected && c0.getCoherenceProtocol() == CoherenceProtocol::MOESI);
+    }
+
+    // MESIF: sólo el sharer en F responde y el último lector hereda F
+    {
+        auto ram = std::make_shared<RAM>();
+        Interconnect interconnect(ram);
+        Cache<> c0(0), c1(1), c2(2);
+        SnoopTestPort p0(interconnect, *ram, 0), p1(interconnect, *ram, 1), p2(interconnect, *ram, 2);
+        Cache<>* caches[] = {&c0, &c1, &c2};
+        SnoopTestPort* ports[] = {&p0, &p1, &p2};
+        for (int i = 0; i < 3; i++) {
+            caches[i]->setBusInterface(ports[i]);
+            caches[i]->setCoherenceProtocol(CoherenceProtocol::MESIF);
+            interconnect.registerCache(caches[i]);
+        }
+
+        ram->write(0x10, 42);
+        c0.read(0x80, data);
+        c1.read(0x80, data);   // c0 (E) entrega; c1 queda en F
+        c2.read(0x80, data);   // c1 (F) entrega; c0 en S no responde
+        assert(data == 42);
+        assert(p0.memory_reads == words_per_block && p1.memory_reads == 0 && p2.memory_reads == 0);
+        assert(c0.getStats().c2c_supplied == 1 && c1.getStats().c2c_supplied == 1);
+        assert(c1.getStats().shared_fills == 1 && c2.getStats().shared_fills == 1);
+        assert(interconnect.getCacheToCacheTransfers() == 2);
+    }
+
+    std::cout << "Protocol variants test passed!" << std::endl;
+}
+
+void test_snoop_filter() {
+    std::cout << "Testing snoop filters..." << std::endl;
+
+    for (SnoopFilterKind kind : {SnoopFilterKind::PRESENCE, SnoopFilterKind::BLOOM}) {
+        auto ram = std::make_shared<RAM>();
+        Interconnect interconnect(ram);
+        interconnect.setSnoopFilter(kind, 256);
+        Cache<> c0(0), c1(1), c2(2);
+        SnoopTestPort p0(interconnect, *ram, 0), p1(interconnect, *ram, 1), p2(interconnect, *ram, 2);
+        Cache<>* caches[] = {&c0, &c1, &c2};
+        SnoopTestPort* ports[] = {&p0, &p1, &p2};
+        for (int i = 0; i < 3; i++) {
+            caches[i]->setBusInterface(ports[i]);
+            interconnect.registerCache(caches[i]);
+        }
+
+        uint64_t data = 0;
+        ram->write(0x10, 42);
+
+        // Nadie tiene el bloque: ambos snoops se filtran
+        c0.read(0x80, data);
+        assert(interconnect.getSnoopsFiltered() == 2 && interconnect.getSnoopsDelivered() == 0);
+
+        // Sólo c0 lo tiene: recibe el snoop y entrega el bloque
+        c1.read(0x80, data);
+        assert(data == 42 && interconnect.getCacheToCacheTransfers() == 1);
+        assert(interconnect.getSnoopsDelivered() == 1 && interconnect.getSnoopsFiltered() == 3);
+
+        // El BusUpgr invalida a c1, que sale del filtro
+        c0.write(0x80, 7);
+        assert(c1.getStats().invalidations == 1);
+        c2.read(0x80, data);
+        assert(data == 7 && interconnect.getSnoopsDelivered() == 3);
+
+        // Dos bloques del mismo set desalojan 0x80 de c0 (que lo escribe a memoria)
+        c0.read(0x180, data);
+        c0.read(0x280, data);
+        uint64_t delivered = interconnect.getSnoopsDelivered();
+        c1.read(0x80, data);
+        assert(data == 7 && c1.getStats().c2c_received == 1);
+        assert(interconnect.getSnoopsDelivered() == delivered + 1);  // Sólo c2
+    }
+
+    std::cout << "Snoop filter test passed!" << std::endl;
+}
+
+void test_directory() {
+    std::cout << "Testing directory coherence..." << std::endl;
+
+    const uint64_t words_per_block = CACHE_BLOCK_SIZE / sizeof(uint64_t);
+    using Outcome = std::pair<uint64_t, size_t>;
+
+    // Cuatro cachés; c0 y c1 comparten el bloque y c0 lo escribe. Se devuelven
+    // las invalidaciones que envió el directorio para el BusUpgr y las entradas
+    // que quedan tras desalojar el bloque.
+    auto run = [&](const DirectoryConfig& config) {
+        auto ram = std::make_shared<RAM>();
+        Interconnect interconnect(ram);
+        Directory directory(config);
+        Cache<> c0(0), c1(1), c2(2), c3(3);
+        SnoopTestPort p0(interconnect, *ram, 0), p1(interconnect, *ram, 1),
+                      p2(interconnect, *ram, 2), p3(interconnect, *ram, 3);
+        Cache<>* caches[] = {&c0, &c1, &c2, &c3};
+        SnoopTestPort* ports[] = {&p0, &p1, &p2, &p3};
+        for (int i = 0; i < 4; i++) {
+            ports[i]->directory = &directory;
+            caches[i]->setBusInterface(ports[i]);
+            directory.registerCache(caches[i]);
+        }
+
+        uint64_t data = 0;
+        ram->write(0x10, 42);
+
+        // Sin sharers: E desde memoria (solicitud + dato)
+        c0.read(0x80, data);
+        assert(data == 42 && p0.memory_reads == words_per_block);
+        assert(directory.getStats(BusEvent::BUS_READ).messages == 2);
+
+        // Forward al dueño en E: entrega el bloque sin leer memoria
+        c1.read(0x80, data);
+        assert(data == 42 && p1.memory_reads == 0 && c1.getStats().c2c_received == 1);
+        assert(c1.getStats().shared_fills == 1);
+        assert(directory.getStats(BusEvent::BUS_READ).forwards == 1);
+        assert(directory.getStats(BusEvent::BUS_READ).messages == 5);
+
+        c0.write(0x80, 7);
+        assert(c1.getStats().invalidations == 1);
+        const DirectoryRequestStats& upgrade = directory.getStats(BusEvent::BUS_UPGRADE);
+        assert(upgrade.requests == 1 && upgrade.broadcast_equivalent == 3);
+        assert(upgrade.messages == 2 + 2 * upgrade.invalidations);
+
+        // c0 en M responde al forward
+        c3.read(0x80, data);
+        assert(data == 7 && p3.memory_reads == 0 && c0.getStats().c2c_supplied == 2);
+
+        // Desalojar 0x80 de c0 y c3
+        for (Cache<>* cache : {&c0, &c3}) {
+            cache->read(0x180, data);
+            cache->read(0x280, data);
+        }
+        return Outcome(upgrade.invalidations, directory.getEntryCount());
+    };
+
+    // Vector completo: sólo c1 recibe la invalidación y la entrada de 0x80 se libera
+    DirectoryConfig config;
+    assert(run(config) == Outcome(1, 2));
+
+    // Punteros: con uno solo se desborda y se invalida por broadcast
+    config.encoding = SharerEncoding::LIMITED_POINTERS;
+    config.pointers = 1;
+    assert(run(config) == Outcome(3, 3));
+    config.pointers = 2;
+    assert(run(config) == Outcome(1, 2));
+
+    // Vector grueso: el bit de grupo no se limpia al desalojar
+    config.encoding = SharerEncoding::COARSE_VECTOR;
+    config.group_size = 2;
+    assert(run(config) == Outcome(1, 3));  // c0 y c1 en el mismo grupo
+    config.group_size = 4;
+    assert(run(config) == Outcome(3, 3));
+
+    std::cout << "Directory test passed!" << std::endl;
+}
@@ -1,5 +1,7 @@
 #include "ram_test.hpp"
 #include <cassert>
+#include <cstring>
+#include <stdexcept>
 
 bool RAMTest::testWriteRead(RAM& ram) {
     std::cout << "Testing write and read operations...\n";
@@ -84,4 +86,51 @@ bool RAMTest::testBoundaryValues(RAM& ram) {
     }
     
     return success;
-}
\ No newline at end of file
+}
+
+bool RAMTest::testBlockTransfers(RAM& ram) {
+    std::cout << "Testing block transfers...\n";
+    bool success = true;
+    
+    try {
+        // Un bloque de 4 palabras equivale a cuatro write/read sueltos
+        uint64_t block[4] = {0x11, 0x22, 0x33, 0x44};
+        ram.writeBlock(0x0040, reinterpret_cast<const uint8_t*>(block), sizeof(block));
+        for (uint32_t i = 0; i < 4; i++) {
+            success &= (ram.read(0x0040 + i) == block[i]);
+        }
+        
+        uint8_t bytes[sizeof(block)];
+        ram.write(0x0042, 0x99);
+        ram.readBlock(0x0040, bytes, sizeof(bytes));
+        uint64_t word;
+        std::memcpy(&word, bytes + 2 * sizeof(uint64_t), sizeof(uint64_t));
+        success &= (word == 0x99);
+        
+        // El último bloque completo cabe; uno que se sale no
+        ram.readBlock(RAM::MAX_ADDRESS - 3, bytes, sizeof(bytes));
+        try {
+            ram.readBlock(RAM::MAX_ADDRESS - 2, bytes, sizeof(bytes));
+            success = false;
+        } catch (const std::out_of_range& e) {
+            // Direcciones en hexadecimal, como en las trazas
+            success &= std::string(e.what()).find("0x1FD + 4 words exceeds 0x1FF") != std::string::npos;
+        }
+        try {
+            ram.writeBlock(0x0040, bytes, 12);
+            success = false;
+        } catch (const std::invalid_argument&) {
+        }
+        
+        if (success) {
+            std::cout << "Block transfers test passed!\n";
+        } else {
+            std::cout << "Block transfers test failed!\n";
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Block transfers test failed with exception: " << e.what() << "\n";
+        success = false;
+    }
+    
+    return success;
+}
@@ -16,6 +16,7 @@ public:
         success &= testWriteRead(ram);
         success &= testInvalidAddress(ram);
         success &= testBoundaryValues(ram);
+        success &= testBlockTransfers(ram);
 
         if (success) {
             std::cout << "All RAM tests passed!\n";
@@ -30,6 +31,7 @@ private:
     static bool testWriteRead(RAM& ram);
     static bool testInvalidAddress(RAM& ram);
     static bool testBoundaryValues(RAM& ram);
+    static bool testBlockTransfers(RAM& ram);
 };
 
 #endif // RAM_TEST_HPP
\ No newline at end of file